@@ -18,6 +18,7 @@
 #include "api/BosonAPI.h"
 #include "BalancedIndexTest.h"
 #include "RecordFileIOTest.h"
+#include "ChecksumTest.h"
 #include "BosonAPITest.h"
 
 
@@ -17,6 +17,8 @@
 
 #include "BosonAPI.h"
 
+#include <stdexcept>
+
 
 using namespace Boson;
 
@@ -29,6 +31,7 @@ BosonAPI::BosonAPI() {
     recordFile = nullptr;
     balancedIndex = nullptr;
     isReadOnly = false;
+    cacheWarmup = false;
 }
 
 
@@ -46,22 +49,58 @@ BosonAPI::~BosonAPI() {
 *  @brief Opens database file and allocate required resources
 *  @param filename - path to file (C-style string)
 *  @param readOnly - true to open with read only rights, false to write permission (default)
+*  @param pool - buffer pool shared with other databases (nullptr - private cache)
+*  @param backendType - storage backend, MEMORY_BACKEND opens in-memory database
+*  (filename is optional snapshot to load, may be nullptr)
 *  @return true if database file successfuly opened, false if not
 */
-bool BosonAPI::open(char* filename, bool readOnly) {
+bool BosonAPI::open(char* filename, bool readOnly, BufferPool* pool, StorageBackendType backendType) {
     isReadOnly = readOnly;
     cachedFile = new CachedFileIO();
-    if (!cachedFile->open(filename, DEFAULT_CACHE, readOnly)) {
+    cachedFile->setBufferPool(pool);
+    cachedFile->setCacheWarmup(cacheWarmup);
+    size_t cacheSize = (pool != nullptr) ? pool->getSize() : DEFAULT_CACHE;
+    if (!cachedFile->open(filename, cacheSize, readOnly, backendType)) {
+        delete cachedFile;
+        cachedFile = nullptr;
+        return false;
+    }
+    // storage header is invalid or file has different page size
+    try {
+        recordFile = new RecordFileIO(*cachedFile);
+    } catch (const std::runtime_error&) {
+        cachedFile->close();
         delete cachedFile;
         cachedFile = nullptr;
         return false;
     }
-    recordFile = new RecordFileIO(*cachedFile);
     balancedIndex = new BalancedIndex(*recordFile);    
     return true;
 }
 
 
+/*
+*  @brief Save in-memory database to snapshot file
+*  @param filename - path to snapshot file (C-style string)
+*  @return true if snapshot saved, false if database is not open or not in-memory
+*/
+bool BosonAPI::snapshot(char* filename) {
+    if (cachedFile == nullptr) return false;
+    if (recordFile != nullptr) recordFile->flush();
+    return cachedFile->snapshot(filename);
+}
+
+
+/*
+*  @brief Persist database header and changed cache pages to storage
+*  @return true if flushed, false if database is not open or write failed
+*/
+bool BosonAPI::flush() {
+    if (recordFile == nullptr) return false;
+    return recordFile->flush();
+}
+
+
 /*
 *  @brief Close database file and release resources
 *  @return true if file was closed, false if it wasn't open
@@ -202,6 +241,92 @@ double BosonAPI::getCacheHits() {
 }
 
 
+/*
+*  @brief Set cache replacement policy (2Q or ARC keep hot pages cached
+*  during full traversals and bulk exports)
+*  @param policy - cache replacement policy
+*  @return true if policy set, false if database is not open
+*/
+bool BosonAPI::setCachePolicy(ReplacementPolicyType policy) {
+    if (cachedFile == nullptr) return false;
+    return cachedFile->setReplacementPolicy(policy);
+}
+
+
+/*
+*  @brief Set cache memory budget, cache is resized within it adaptively
+*  by estimated miss ratio (equal sizes fix cache size)
+*  @param minCacheSize - minimal cache size in bytes
+*  @param maxCacheSize - maximal cache size in bytes
+*  @return true if budget set, false if database is not open or budget is invalid
+*/
+bool BosonAPI::setCacheBudget(size_t minCacheSize, size_t maxCacheSize) {
+    if (cachedFile == nullptr) return false;
+    return cachedFile->setCacheBudget(minCacheSize, maxCacheSize);
+}
+
+
+/*
+*  @brief Enable or disable background write back of dirty cache pages
+*  @param enabled - true to start background flusher, false to stop it
+*  @return true if flusher state changed, false if database is not writable
+*/
+bool BosonAPI::setBackgroundFlush(bool enabled) {
+    if (cachedFile == nullptr) return false;
+    if (enabled) return cachedFile->startFlusher();
+    return cachedFile->stopFlusher();
+}
+
+
+/*
+*  @brief Enable or disable cache warm-up: hot pages are saved on close and
+*  loaded in background on next open (set before open to warm up)
+*  @param enabled - true to save and load hot pages manifest
+*/
+void BosonAPI::setCacheWarmup(bool enabled) {
+    cacheWarmup = enabled;
+    if (cachedFile != nullptr) cachedFile->setCacheWarmup(enabled);
+}
+
+
+/*
+*  @brief Set database file growth: file space is preallocated in chunks of
+*  the larger of increment and percent of file size (0, 0 disables it)
+*  @param increment - minimal preallocation chunk in bytes
+*  @param percent - preallocation chunk share of file size (0..1)
+*  @return true if policy set, false if database is not open or not supported
+*/
+bool BosonAPI::setFileGrowth(size_t increment, double percent) {
+    if (cachedFile == nullptr) return false;
+    return cachedFile->setFileGrowth(increment, percent);
+}
+
+
+/*
+*  @brief Set data checksum verification policy of reads (VERIFY_ON_LOAD
+*  skips records verified since their pages were loaded to cache)
+*  @param policy - checksum verification policy
+*  @return true if policy set, false if database is not open
+*/
+bool BosonAPI::setChecksumVerify(ChecksumVerifyPolicy policy) {
+    if (recordFile == nullptr) return false;
+    recordFile->setChecksumVerify(policy);
+    return true;
+}
+
+
+/*
+*  @brief Verify checksums of next stored records (incremental scrub, for
+*  VERIFY_ON_SCRUB policy call it periodically from maintenance code)
+*  @param maxRecords - maximum records to check
+*  @return records checked
+*/
+uint64_t BosonAPI::scrub(uint64_t maxRecords) {
+    if (recordFile == nullptr) return 0;
+    return recordFile->scrub(maxRecords);
+}
+
+
 void BosonAPI::printTreeState() {
     if (balancedIndex == nullptr) return;
     balancedIndex->printTree();
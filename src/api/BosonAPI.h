@@ -30,7 +30,10 @@ namespace Boson {
         BosonAPI();
         ~BosonAPI();
 
-        bool open(char* filename, bool readOnly = false);
+        bool open(char* filename, bool readOnly = false, BufferPool* pool = nullptr,
+            StorageBackendType backendType = DEFAULT_BACKEND);
+        bool snapshot(char* filename);
+        bool flush();
         bool close();
 
         uint64_t size();
@@ -47,6 +50,13 @@ namespace Boson {
         std::pair<uint64_t, std::shared_ptr<std::string>> previous();
 
         double getCacheHits();
+        bool setCachePolicy(ReplacementPolicyType policy);
+        bool setCacheBudget(size_t minCacheSize, size_t maxCacheSize);
+        bool setBackgroundFlush(bool enabled);
+        void setCacheWarmup(bool enabled);
+        bool setFileGrowth(size_t increment, double percent);
+        bool setChecksumVerify(ChecksumVerifyPolicy policy);
+        uint64_t scrub(uint64_t maxRecords);
 
         void printTreeState();
 
@@ -55,6 +65,7 @@ namespace Boson {
         RecordFileIO* recordFile;
         BalancedIndex* balancedIndex;
         bool isReadOnly;
+        bool cacheWarmup;
     };
 
 
@@ -21,7 +21,7 @@ BalancedIndex::BalancedIndex(RecordFileIO& rf) : recordsFile(rf) {
     if (!rf.isOpen()) throw std::runtime_error("Can't open file.");
     // Check if file has its first record as DB header
     if (!recordsFile.first()) {
-        memset(&indexHeader, 0, sizeof IndexHeader);
+        memset(&indexHeader, 0, sizeof(IndexHeader));
         uint64_t referencePos = recordsFile.createRecord(&indexHeader, sizeof indexHeader);
         // root record
         root = std::make_shared<LeafNode>(*this);      
@@ -29,7 +29,7 @@ InnerNode::InnerNode(BalancedIndex& bi) : Node(bi, NodeType::INNER) {
 */
 InnerNode::InnerNode(BalancedIndex& bi, uint64_t offsetInFile, NodeData& loadedData) : Node(bi) {
     position = offsetInFile;
-    memcpy(&(this->data), &loadedData, sizeof NodeData);
+    memcpy(&(this->data), &loadedData, sizeof(NodeData));
     isPersisted = true;
 }
 
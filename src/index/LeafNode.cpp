@@ -27,7 +27,7 @@ LeafNode::LeafNode(BalancedIndex& bi) : Node(bi, NodeType::LEAF) {
 */
 LeafNode::LeafNode(BalancedIndex& bi, uint64_t offsetInFile, NodeData& loadedData) : Node(bi) {
     position = offsetInFile;
-    memcpy(&(this->data), &loadedData, sizeof NodeData);
+    memcpy(&(this->data), &loadedData, sizeof(NodeData));
     isPersisted = true;
 }
 
@@ -78,13 +78,9 @@ std::shared_ptr<std::string> LeafNode::getValueAt(uint32_t index) {
     uint64_t offsetInFile = data.values[index];
     recordsFile.setPosition(offsetInFile);    
 
-    // load data from storage file record
-    uint32_t valueLength = recordsFile.getDataLength() + 1;
-    // allocate memory buffer to read value
-    char* buffer = new char[valueLength];
-
-    // Read data from storage
-    uint64_t offset = recordsFile.getRecordData(buffer, valueLength);
+    // Read value straight from cache pages to C++ string
+    std::shared_ptr<std::string> cppStr = std::make_shared<std::string>();
+    uint64_t offset = recordsFile.getRecordData(*cppStr);
     
     // if record read failed
     if (offset == NOT_FOUND) {
@@ -96,16 +92,10 @@ std::shared_ptr<std::string> LeafNode::getValueAt(uint32_t index) {
         throw std::ios_base::failure(ss.str());
     }
 
-    // add null terminator to C style string
-    buffer[valueLength - 1] = 0; 
+    // cut C style string null terminator stored with value
+    size_t terminator = cppStr->find('\0');
+    if (terminator != std::string::npos) cppStr->resize(terminator);
 
-    // convert to C++ string and return as shared pointer
-    std::shared_ptr<std::string> cppStr = std::make_shared<std::string>();
-    
-    // assign C-style string value to C++ string
-    *cppStr = buffer;
-    // release memory buffer
-    delete[] buffer;
     // return C++ string
     return cppStr;
 }
@@ -38,7 +38,7 @@ Node::Node(BalancedIndex& bi, NodeType type) : index(bi) {
         
     // allocate space in file
     RecordFileIO& recordFile = index.getRecordsFile();
-    uint64_t offset = recordFile.createRecord(&data, sizeof NodeData);
+    uint64_t offset = recordFile.createRecord(&data, sizeof(NodeData));
     if (offset == NOT_FOUND) {
         throw std::ios_base::failure("Can't write node data.");
     }
@@ -62,7 +62,7 @@ std::shared_ptr<Node> Node::loadNode(BalancedIndex& bi, uint64_t offsetInFile) {
     RecordFileIO& recordsFile = bi.getRecordsFile();
     recordsFile.setPosition(offsetInFile);
     NodeData data;
-    uint64_t offset = recordsFile.getRecordData(&data, sizeof NodeData);
+    uint64_t offset = recordsFile.getRecordData(&data, sizeof(NodeData));
     if (offset == NOT_FOUND) {
         std::stringstream ss;
         ss << "Can't read node data at " << offsetInFile << " ";
@@ -130,7 +130,7 @@ uint64_t Node::persist() {
     // write node data to specified position
     RecordFileIO& recordsFile = index.getRecordsFile();
     recordsFile.setPosition(position);        
-    uint64_t offset = recordsFile.setRecordData(&data, sizeof NodeData);
+    uint64_t offset = recordsFile.setRecordData(&data, sizeof(NodeData));
     // Throw exception if file not open or can't write
     if (offset == NOT_FOUND) {
         std::stringstream ss;
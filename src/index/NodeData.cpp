@@ -15,7 +15,7 @@ using namespace Boson;
 * @brief Creates node data class and sets all fields to zero
 */
 NodeData::NodeData() {
-    memset(this, 0, sizeof NodeData);
+    memset(this, 0, sizeof(NodeData));
 }
 
 
@@ -106,7 +106,7 @@ void NodeData::resize(NodeArray mode, uint32_t newSize) {
         // clear deleted keys for debug purposes
         if (newSize < keysCount) {
             uint32_t gap = keysCount - newSize;
-            memset(&keys[newSize], 0, gap * sizeof uint64_t);
+            memset(&keys[newSize], 0, gap * sizeof(uint64_t));
         }
         keysCount = newSize;
     }
@@ -114,7 +114,7 @@ void NodeData::resize(NodeArray mode, uint32_t newSize) {
         // clear deleted children/values for debug purposes
         if (newSize < childrenCount) {
             uint32_t gap = childrenCount - newSize;
-            memset(&children[newSize], 0, gap * sizeof uint64_t);
+            memset(&children[newSize], 0, gap * sizeof(uint64_t));
         }
         childrenCount = newSize;        
     }
@@ -0,0 +1,162 @@
+/******************************************************************************
+*
+*  ArcPolicy class implementation
+*
+*  ARC (N. Megiddo, D. Modha, 2003) keeps two LRU lists: pages referenced
+*  once (recency list) and pages referenced at least twice (frequency list)
+*  and histories of pages evicted from both lists. Miss of page found in
+*  recency history grows recency list target, miss of page found in
+*  frequency history shrinks it. One-shot pages of sequential scans stay
+*  in the recency list and don't push out pages of the frequency list.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "ReplacementPolicy.h"
+#include "CachedFileIO.h"
+
+#include <algorithm>
+
+using namespace Boson;
+
+
+/**
+*  @brief Constructor
+*  @param[in] capacity - partition capacity (pages)
+*/
+ArcPolicy::ArcPolicy(size_t capacity) : recentHistory(capacity), frequentHistory(capacity) {
+	this->capacity = capacity;
+	this->recentTarget = 0;
+	this->frequentGhostHit = false;
+}
+
+
+/**
+*  @brief Rescales recency target and histories to new capacity
+*  @param[in] capacity - partition capacity (pages)
+*/
+void ArcPolicy::setCapacity(size_t capacity) {
+	this->capacity = capacity;
+	this->recentTarget = std::min(recentTarget, capacity);
+	recentHistory.shrink(capacity > recent.size() ? capacity - recent.size() : 0);
+	size_t tracked = recent.size() + frequent.size() + recentHistory.size();
+	frequentHistory.shrink(capacity * 2 > tracked ? capacity * 2 - tracked : 0);
+}
+
+
+/**
+*
+*  @brief Adapts recency list target on cache miss (before victim selection)
+*
+*  @param[in] filePageNo - missed file page number
+*
+*/
+void ArcPolicy::onMiss(size_t filePageNo) {
+	frequentGhostHit = false;
+	if (recentHistory.contains(filePageNo)) {
+		size_t delta = std::max<size_t>(1, frequentHistory.size() / recentHistory.size());
+		recentTarget = std::min(capacity, recentTarget + delta);
+	} else if (frequentHistory.contains(filePageNo)) {
+		size_t delta = std::max<size_t>(1, recentHistory.size() / frequentHistory.size());
+		recentTarget = recentTarget > delta ? recentTarget - delta : 0;
+		frequentGhostHit = true;
+	}
+}
+
+
+/**
+*
+*  @brief Places loaded page to the frequency list if it is in histories,
+*  otherwise to the recency list and keeps histories bounded
+*
+*/
+void ArcPolicy::onInsert(CachePage* page) {
+	bool remembered = recentHistory.remove(page->filePageNo);
+	remembered = frequentHistory.remove(page->filePageNo) || remembered;
+	if (remembered) {
+		frequent.push_front(page);
+		page->it = frequent.begin();
+		page->policyState = POLICY_RESIDENT | POLICY_PROTECTED;
+	} else {
+		recent.push_front(page);
+		page->it = recent.begin();
+		page->policyState = POLICY_RESIDENT;
+	}
+	// recency list with its history and all lists with histories are bounded
+	recentHistory.shrink(capacity > recent.size() ? capacity - recent.size() : 0);
+	size_t tracked = recent.size() + frequent.size() + recentHistory.size();
+	frequentHistory.shrink(capacity * 2 > tracked ? capacity * 2 - tracked : 0);
+}
+
+
+/**
+*  @brief Moves page to the front of the frequency list
+*/
+void ArcPolicy::onAccess(CachePage* page) {
+	if (page->policyState & POLICY_PROTECTED) {
+		frequent.splice(frequent.begin(), frequent, page->it);
+	} else {
+		frequent.splice(frequent.begin(), recent, page->it);
+		page->policyState |= POLICY_PROTECTED;
+	}
+}
+
+
+/**
+*
+*  @brief Returns not evicted victim to the recency list, history entry added
+*  on its eviction is dropped (page is not promoted to frequency list)
+*
+*/
+void ArcPolicy::onRestore(CachePage* page) {
+	recentHistory.remove(page->filePageNo);
+	frequentHistory.remove(page->filePageNo);
+	recent.push_front(page);
+	page->it = recent.begin();
+	page->policyState = POLICY_RESIDENT;
+}
+
+
+/**
+*
+*  @brief Evicts least recently used page of the recency list if it exceeds
+*  its target, otherwise of the frequency list
+*
+*  @return victim page or nullptr if all pages are pinned
+*
+*/
+CachePage* ArcPolicy::selectVictim() {
+	bool fromRecent = !recent.empty() && (frequent.empty() || recent.size() > recentTarget ||
+		(frequentGhostHit && recent.size() == recentTarget));
+	CachePage* victim = nullptr;
+	if (fromRecent) {
+		victim = evictFrom(recent, recentHistory);
+		if (victim == nullptr) victim = evictFrom(frequent, frequentHistory);
+	} else {
+		victim = evictFrom(frequent, frequentHistory);
+		if (victim == nullptr) victim = evictFrom(recent, recentHistory);
+	}
+	return victim;
+}
+
+
+/**
+*
+*  @brief Removes least recently used not pinned (preferably clean) page from
+*  the list and remembers it in the list history
+*
+*  @param[in] list    - recency or frequency list
+*  @param[in] history - history of the list
+*
+*  @return victim page or nullptr if all list pages are pinned
+*
+*/
+CachePage* ArcPolicy::evictFrom(std::list<CachePage*>& list, PageHistory& history) {
+	CachePage* page = lastUnpinned(list);
+	if (page == nullptr) return nullptr;
+	history.add(page->filePageNo);
+	list.erase(page->it);
+	page->policyState = 0;
+	return page;
+}
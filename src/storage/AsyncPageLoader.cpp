@@ -0,0 +1,171 @@
+/******************************************************************************
+*
+*  AsyncPageLoader and ThreadPoolPageLoader classes implementation
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "AsyncPageLoader.h"
+
+using namespace Boson;
+
+
+/**
+*
+*  @brief Adds page read request to the batch
+*
+*  @param[in] offset - offset in the file
+*  @param[in] buffer - destination buffer
+*  @param[in] length - bytes to read
+*
+*/
+void PageReadBatch::add(uint64_t offset, uint8_t* buffer, size_t length) {
+	PageReadRequest request;
+	request.offset = offset;
+	request.buffer = buffer;
+	request.length = length;
+	request.bytesRead = 0;
+	request.batch = this;
+	requests.push_back(request);
+}
+
+
+/**
+*  @brief Checks if all requests of the batch are completed
+*  @return true - if all requests completed, false - otherwise
+*/
+bool PageReadBatch::isCompleted() {
+	return completed.load(std::memory_order_acquire) == requests.size();
+}
+
+
+/**
+*  @brief Submits batch and waits for completion of all its requests
+*  @return true if batch submitted and completed, false otherwise
+*/
+bool AsyncPageLoader::load(PageReadBatch& batch) {
+	if (!submit(batch)) return false;
+	wait(batch);
+	return true;
+}
+
+
+/**
+*
+*  @brief Creates best available asynchronous loader for storage backend:
+*  io_uring on Linux if backend has file descriptor and kernel supports it,
+*  otherwise thread pool loader.
+*
+*  @param[in] backend - opened storage backend
+*
+*  @return new loader instance (caller owns)
+*
+*/
+AsyncPageLoader* AsyncPageLoader::create(StorageBackend* backend) {
+#ifdef __linux__
+	int fileDescriptor = backend->getDescriptor();
+	if (fileDescriptor >= 0) {
+		UringPageLoader* uringLoader = new UringPageLoader(fileDescriptor, backend);
+		if (uringLoader->isReady()) return uringLoader;
+		delete uringLoader;
+	}
+#endif
+	return new ThreadPoolPageLoader(backend);
+}
+
+
+//=============================================================================
+//
+//
+//                       Thread pool page loader
+//
+//
+//=============================================================================
+
+
+/**
+*
+*  @brief Starts worker threads
+*
+*  @param[in] backend      - storage backend (must support concurrent reads)
+*  @param[in] threadsCount - worker threads count
+*
+*/
+ThreadPoolPageLoader::ThreadPoolPageLoader(StorageBackend* backend, size_t threadsCount) {
+	this->backend = backend;
+	this->stopping = false;
+	if (threadsCount == 0) threadsCount = 1;
+	for (size_t i = 0; i < threadsCount; i++) {
+		workers.emplace_back(&ThreadPoolPageLoader::workerLoop, this);
+	}
+}
+
+
+/**
+*  @brief Stops and joins worker threads (pending requests are completed)
+*/
+ThreadPoolPageLoader::~ThreadPoolPageLoader() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	hasWork.notify_all();
+	for (std::thread& worker : workers) worker.join();
+}
+
+
+/**
+*
+*  @brief Enqueues all batch requests to worker threads
+*
+*  @param[in] batch - batch of page read requests
+*
+*  @return true if batch submitted, false if it was already submitted
+*
+*/
+bool ThreadPoolPageLoader::submit(PageReadBatch& batch) {
+	if (batch.submitted) return false;
+	batch.submitted = true;
+	if (batch.requests.empty()) return true;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (PageReadRequest& request : batch.requests) {
+			request.batch = &batch;
+			queue.push_back(&request);
+		}
+	}
+	hasWork.notify_all();
+	return true;
+}
+
+
+/**
+*  @brief Waits until all batch requests are completed
+*  @param[in] batch - submitted batch of page read requests
+*/
+void ThreadPoolPageLoader::wait(PageReadBatch& batch) {
+	if (!batch.submitted || batch.isCompleted()) return;
+	std::unique_lock<std::mutex> lock(mutex);
+	hasDone.wait(lock, [&batch] { return batch.isCompleted(); });
+}
+
+
+/**
+*  @brief Worker thread: takes requests from queue and reads data from backend
+*/
+void ThreadPoolPageLoader::workerLoop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		hasWork.wait(lock, [this] { return stopping || !queue.empty(); });
+		if (queue.empty()) return;
+		PageReadRequest* request = queue.front();
+		queue.pop_front();
+		// read data without holding the queue lock
+		lock.unlock();
+		request->bytesRead = backend->read(request->offset, request->buffer, request->length);
+		lock.lock();
+		request->batch->completed.fetch_add(1, std::memory_order_release);
+		hasDone.notify_all();
+	}
+}
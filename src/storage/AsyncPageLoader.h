@@ -0,0 +1,141 @@
+/******************************************************************************
+*
+*  AsyncPageLoader classes header
+*
+*  AsyncPageLoader is an asynchronous page fetch engine used by CachedFileIO
+*  to load several missing pages at once. All requests of a batch are
+*  submitted together and completed in parallel, so multi-page reads and
+*  prefetches don't stall serially on every page miss.
+*
+*  Loaders:
+*    - UringPageLoader      - Linux io_uring, whole batch in one system call
+*    - ThreadPoolPageLoader - portable fallback, worker threads issue
+*                             positional reads through storage backend
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#pragma once
+
+#include "StorageBackend.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Boson {
+
+	//-------------------------------------------------------------------------
+	constexpr size_t LOADER_THREADS      = 4;     // Thread pool loader workers
+	constexpr size_t LOADER_QUEUE_DEPTH  = 64;    // io_uring submission queue depth
+	//-------------------------------------------------------------------------
+
+	class PageReadBatch;
+
+	typedef struct {
+		uint64_t       offset;                  // Offset in the file
+		uint8_t*       buffer;                  // Destination buffer
+		size_t         length;                  // Bytes to read
+		size_t         bytesRead;               // Bytes actually read (on completion)
+		PageReadBatch* batch;                   // Owner batch
+	} PageReadRequest;
+
+	//-------------------------------------------------------------------------
+	// Batch of page read requests submitted and completed together
+	//-------------------------------------------------------------------------
+	class PageReadBatch {
+	public:
+		PageReadBatch() : completed(0), submitted(false) {}
+		void add(uint64_t offset, uint8_t* buffer, size_t length);
+		bool isCompleted();
+
+		std::vector<PageReadRequest> requests;  // Batch requests
+		std::atomic<size_t>          completed; // Completed requests counter
+		bool                         submitted; // Batch submitted to loader
+	};
+
+	//-------------------------------------------------------------------------
+	// Asynchronous page loader interface
+	//-------------------------------------------------------------------------
+	class AsyncPageLoader {
+	public:
+		virtual ~AsyncPageLoader() {}
+		virtual bool submit(PageReadBatch& batch) = 0;
+		virtual void wait(PageReadBatch& batch) = 0;
+		virtual const char* getName() = 0;
+		bool load(PageReadBatch& batch);
+
+		static AsyncPageLoader* create(StorageBackend* backend);
+	};
+
+	//-------------------------------------------------------------------------
+	// Thread pool loader (portable fallback)
+	//-------------------------------------------------------------------------
+	class ThreadPoolPageLoader : public AsyncPageLoader {
+	public:
+		ThreadPoolPageLoader(StorageBackend* backend, size_t threadsCount = LOADER_THREADS);
+		~ThreadPoolPageLoader();
+		bool submit(PageReadBatch& batch);
+		void wait(PageReadBatch& batch);
+		const char* getName() { return "thread pool"; }
+	private:
+		void workerLoop();
+
+		StorageBackend*               backend;   // Storage backend
+		std::vector<std::thread>      workers;   // Worker threads
+		std::deque<PageReadRequest*>  queue;     // Pending requests queue
+		std::mutex                    mutex;     // Queue mutex
+		std::condition_variable       hasWork;   // Signaled on new requests
+		std::condition_variable       hasDone;   // Signaled on completions
+		bool                          stopping;  // Workers stop flag
+	};
+
+#ifdef __linux__
+	//-------------------------------------------------------------------------
+	// Linux io_uring loader (raw system calls, no liburing dependency)
+	//-------------------------------------------------------------------------
+	class UringPageLoader : public AsyncPageLoader {
+	public:
+		UringPageLoader(int fileDescriptor, StorageBackend* backend, unsigned queueDepth = LOADER_QUEUE_DEPTH);
+		~UringPageLoader();
+		bool isReady();
+		bool submit(PageReadBatch& batch);
+		void wait(PageReadBatch& batch);
+		const char* getName() { return "io_uring"; }
+	private:
+		bool pushRequest(PageReadRequest* request);
+		bool enter(unsigned toSubmit, unsigned minComplete);
+		void reapCompletions();
+		void abandonUnsubmitted();
+		void completeRequest(PageReadRequest* request, int result);
+
+		StorageBackend* backend;                 // Backend for short read tails
+		int        fileDescriptor;               // File descriptor to read
+		int        ringDescriptor;               // io_uring instance descriptor
+		unsigned   ringEntries;                  // Submission queue entries
+		unsigned   inFlight;                     // Submitted, not reaped requests
+		unsigned   toSubmit;                     // Queued, not submitted requests
+		void*      sqRing;                       // Submission queue ring mapping
+		void*      cqRing;                       // Completion queue ring mapping
+		void*      sqEntries;                    // Submission queue entries mapping
+		size_t     sqRingSize;                   // Submission ring mapping size
+		size_t     cqRingSize;                   // Completion ring mapping size
+		size_t     sqEntriesSize;                // Submission entries mapping size
+		unsigned*  sqHead;                       // Submission queue head
+		unsigned*  sqTail;                       // Submission queue tail
+		unsigned*  sqMask;                       // Submission queue index mask
+		unsigned*  sqArray;                      // Submission queue index array
+		unsigned*  cqHead;                       // Completion queue head
+		unsigned*  cqTail;                       // Completion queue tail
+		unsigned*  cqMask;                       // Completion queue index mask
+		void*      cqEntries;                    // Completion queue entries
+		std::deque<PageReadRequest*> backlog;    // Requests waiting for ring space
+		std::mutex                   ringMutex;  // Guards rings for concurrent callers
+	};
+#endif
+
+}
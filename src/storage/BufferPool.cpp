@@ -0,0 +1,255 @@
+/******************************************************************************
+*
+*  BufferPool class implementation
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "BufferPool.h"
+#include "CachedFileIO.h"
+
+#include <algorithm>
+
+using namespace Boson;
+
+
+/**
+*
+*  @brief Constructor allocates page frames of the pool
+*
+*  @param[in] poolSize  - pool size in bytes (at least MINIMAL_CACHE), throws
+*                         std::bad_alloc if failed to allocate
+*  @param[in] hugePages - back page frames with huge pages (for files opened
+*                         with direct I/O backend)
+*
+*/
+BufferPool::BufferPool(size_t poolSize, bool hugePages) {
+	if (poolSize < MINIMAL_CACHE) poolSize = MINIMAL_CACHE;
+	this->pagesCount = poolSize / PAGE_SIZE;
+	this->allocations = 0;
+	this->dataPoolMapped = 0;
+	this->pageDataPool = CachedFileIO::allocateDataPool(pagesCount, hugePages, dataPoolMapped);
+	this->pageInfoPool = new CachePage[pagesCount]();
+	freeFrames.reserve(pagesCount);
+	for (size_t i = pagesCount; i > 0; i--) {
+		CachePage* frame = &pageInfoPool[i - 1];
+		frame->data = pageDataPool[i - 1].data;
+		frame->fileId = NO_FILE;
+		freeFrames.push_back(frame);
+	}
+}
+
+
+/**
+*  @brief Destructor releases page frames (files must be detached)
+*/
+BufferPool::~BufferPool() {
+	delete[] pageInfoPool;
+	CachedFileIO::releaseDataPool(pageDataPool, dataPoolMapped);
+}
+
+
+/**
+*  @brief Returns pool size in bytes
+*/
+size_t BufferPool::getSize() {
+	return pagesCount * PAGE_SIZE;
+}
+
+
+/**
+*  @brief Returns pool capacity in pages
+*/
+size_t BufferPool::getPagesCount() {
+	return pagesCount;
+}
+
+
+/**
+*
+*  @brief Returns pool stats or stats of attached file
+*
+*  @param[in] type - requested stats type
+*  @param[in] file - attached file (FILE_* stats types)
+*
+*  @return value of stats (0 if file is not attached)
+*
+*/
+double BufferPool::getStats(BufferPoolStats type, CachedFileIO* file) {
+	std::lock_guard<std::mutex> lock(mutex);
+	switch (type) {
+	case BufferPoolStats::POOL_PAGES:
+		return double(pagesCount);
+	case BufferPoolStats::POOL_FREE_PAGES:
+		return double(freeFrames.size());
+	case BufferPoolStats::POOL_FILES:
+		return double(std::count_if(files.begin(), files.end(),
+			[](const std::unique_ptr<BufferPoolFile>& entry) { return entry != nullptr; }));
+	default:
+		break;
+	}
+	if (file == nullptr || file->poolFile == nullptr || file->bufferPool != this) return 0;
+	BufferPoolFile* poolFile = file->poolFile;
+	switch (type) {
+	case BufferPoolStats::FILE_PAGES:
+		return double(poolFile->pages);
+	case BufferPoolStats::FILE_QUOTA_PAGES:
+		return double(poolFile->quota);
+	case BufferPoolStats::FILE_PAGES_LOST:
+		return double(poolFile->pagesLost.load());
+	case BufferPoolStats::FILE_PAGES_TAKEN:
+		return double(poolFile->pagesTaken.load());
+	default:
+		return 0;
+	}
+}
+
+
+/**
+*
+*  @brief Attaches file to the pool
+*
+*  @param[in] file - cached file
+*
+*  @return attached file entry
+*
+*/
+BufferPoolFile* BufferPool::attach(CachedFileIO* file) {
+	std::lock_guard<std::mutex> evictLock(evictMutex);
+	std::lock_guard<std::mutex> lock(mutex);
+	uint32_t id = 0;
+	while (id < files.size() && files[id] != nullptr) id++;
+	if (id == files.size()) files.emplace_back();
+	files[id].reset(new BufferPoolFile());
+	BufferPoolFile* poolFile = files[id].get();
+	poolFile->id = id;
+	poolFile->file = file;
+	poolFile->pages = 0;
+	poolFile->quota = pagesCount;
+	poolFile->accesses = 0;
+	poolFile->pagesLost = 0;
+	poolFile->pagesTaken = 0;
+	return poolFile;
+}
+
+
+/**
+*
+*  @brief Detaches file from the pool, all frames held by the file are
+*  returned to the pool (file must not use its pages anymore)
+*
+*  @param[in] poolFile - attached file entry
+*
+*/
+void BufferPool::detach(BufferPoolFile* poolFile) {
+	std::lock_guard<std::mutex> evictLock(evictMutex);
+	std::lock_guard<std::mutex> lock(mutex);
+	for (size_t i = 0; i < pagesCount; i++) {
+		CachePage* frame = &pageInfoPool[i];
+		if (frame->fileId != poolFile->id) continue;
+		frame->fileId = NO_FILE;
+		freeFrames.push_back(frame);
+	}
+	files[poolFile->id].reset();
+}
+
+
+/**
+*
+*  @brief Sets file quota (for stats, CachedFileIO enforces it)
+*
+*  @param[in] poolFile - attached file entry
+*  @param[in] quota    - maximal pages count held by the file
+*
+*/
+void BufferPool::setQuota(BufferPoolFile* poolFile, size_t quota) {
+	std::lock_guard<std::mutex> lock(mutex);
+	poolFile->quota = quota;
+}
+
+
+/**
+*
+*  @brief Takes free frame for the file
+*
+*  @param[in] poolFile - attached file entry
+*
+*  @return page frame or nullptr if pool has no free frames
+*
+*/
+CachePage* BufferPool::allocate(BufferPoolFile* poolFile) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (freeFrames.empty()) return nullptr;
+	CachePage* frame = freeFrames.back();
+	freeFrames.pop_back();
+	frame->fileId = poolFile->id;
+	poolFile->pages++;
+	// age access counters, so recently busy files keep their pages
+	if (++allocations >= pagesCount) {
+		allocations = 0;
+		for (auto& entry : files) {
+			if (entry != nullptr) entry->accesses = entry->accesses.load() / 2;
+		}
+	}
+	return frame;
+}
+
+
+/**
+*
+*  @brief Returns frame of the file to the pool
+*
+*  @param[in] poolFile - attached file entry
+*  @param[in] page     - page frame held by the file (cleared)
+*
+*/
+void BufferPool::release(BufferPoolFile* poolFile, CachePage* page) {
+	std::lock_guard<std::mutex> lock(mutex);
+	page->fileId = NO_FILE;
+	poolFile->pages--;
+	freeFrames.push_back(page);
+}
+
+
+/**
+*
+*  @brief Frees frame for the file: page is evicted from the file with the
+*  lowest recent accesses count per held page (may be the file itself).
+*  Caller must not hold partition locks of any file.
+*
+*  @param[in] poolFile - attached file entry of requesting file
+*
+*  @return true if pool has free frame, false if all pages are pinned
+*
+*/
+bool BufferPool::reclaim(BufferPoolFile* poolFile) {
+	std::lock_guard<std::mutex> evictLock(evictMutex);
+	// collect files holding pages by access density
+	std::vector<std::pair<double, BufferPoolFile*>> candidates;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!freeFrames.empty()) return true;
+		for (auto& entry : files) {
+			if (entry == nullptr || entry->pages == 0) continue;
+			double density = double(entry->accesses.load()) / double(entry->pages);
+			candidates.emplace_back(density, entry.get());
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(),
+		[](const std::pair<double, BufferPoolFile*>& a, const std::pair<double, BufferPoolFile*>& b)
+		{
+			return a.first < b.first;
+		});
+	// evict page of least active file which has not pinned pages
+	for (auto& candidate : candidates) {
+		BufferPoolFile* victimFile = candidate.second;
+		if (victimFile->file->evictPages(1) == 0) continue;
+		if (victimFile != poolFile) {
+			victimFile->pagesLost++;
+			poolFile->pagesTaken++;
+		}
+		return true;
+	}
+	return false;
+}
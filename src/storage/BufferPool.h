@@ -0,0 +1,98 @@
+/******************************************************************************
+*
+*  BufferPool class header
+*
+*  BufferPool is process wide pool of cache pages shared by several open
+*  CachedFileIO files, so memory goes to files which use it: idle files
+*  give their pages away to busy ones. Every page frame is tagged with the
+*  id of the file holding it, page identity is (file id, file page No.),
+*  files keep their own partitions, page tables and replacement policies.
+*
+*  When pool has no free frames, page is evicted from the file with the
+*  lowest recent accesses count per held page (global eviction), the file
+*  persists the page if it is dirty and returns its frame to the pool.
+*  Access counters are halved every pool size allocations, so eviction
+*  follows the current load. Cache size of attached file is its quota:
+*  maximal pages count the file may hold in the pool.
+*
+*  Files are attached on open and detached on close (see
+*  CachedFileIO::setBufferPool), pool must outlive attached files.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+namespace Boson {
+
+	class CachedFileIO;
+	class CachePage;
+	struct CachePageData;
+
+	constexpr uint32_t NO_FILE = UINT32_MAX;     // Frame is not held by any file
+
+	typedef enum {                              // BufferPool stats types
+		POOL_PAGES,                             // Pool capacity (pages)
+		POOL_FREE_PAGES,                        // Frames not held by files
+		POOL_FILES,                             // Attached files count
+		FILE_PAGES,                             // Pages held by the file
+		FILE_QUOTA_PAGES,                       // File quota (pages)
+		FILE_PAGES_LOST,                        // File pages evicted for other files
+		FILE_PAGES_TAKEN                        // Pages file got evicting other files
+	} BufferPoolStats;
+
+	class BufferPoolFile {                      // Attached file entry
+	public:
+		uint32_t              id;               // File id (page frames tag)
+		CachedFileIO*         file;             // Attached file
+		uint64_t              pages;            // Frames held by the file
+		uint64_t              quota;            // File quota (pages)
+		std::atomic<uint64_t> accesses;         // Recent page accesses (aged)
+		std::atomic<uint64_t> pagesLost;        // Pages evicted for other files
+		std::atomic<uint64_t> pagesTaken;       // Pages got evicting other files
+	};
+
+	//-------------------------------------------------------------------------
+	// Cache pages pool shared by several CachedFileIO files
+	//-------------------------------------------------------------------------
+	class BufferPool {
+	public:
+		BufferPool(size_t poolSize, bool hugePages = false);
+		BufferPool(const BufferPool&) = delete;
+		void operator=(const BufferPool&) = delete;
+		~BufferPool();
+
+		size_t getSize();
+		size_t getPagesCount();
+		double getStats(BufferPoolStats type, CachedFileIO* file = nullptr);
+
+	private:
+		friend class CachedFileIO;
+
+		BufferPoolFile* attach(CachedFileIO* file);
+		void       detach(BufferPoolFile* poolFile);
+		void       setQuota(BufferPoolFile* poolFile, size_t quota);
+		CachePage* allocate(BufferPoolFile* poolFile);
+		void       release(BufferPoolFile* poolFile, CachePage* page);
+		bool       reclaim(BufferPoolFile* poolFile);
+
+		uint64_t        pagesCount;              // Pool capacity (pages)
+		CachePage*      pageInfoPool;            // Page frames info
+		CachePageData*  pageDataPool;            // Page frames data
+		size_t          dataPoolMapped;          // Mapped data pool size (0 - heap)
+		std::vector<CachePage*> freeFrames;      // Frames not held by files
+		std::vector<std::unique_ptr<BufferPoolFile>> files; // Attached files by id
+		uint64_t        allocations;             // Allocations since accesses aging
+		std::mutex      mutex;                   // Guards frames and files
+		std::mutex      evictMutex;              // Serializes global eviction and detach
+	};
+
+}
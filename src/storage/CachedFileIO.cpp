@@ -16,6 +16,10 @@
 *    - O(1) time complexity of page insert
 *    - O(1) time complexity of page remove
 *
+*  Cache pages are split into lock striped partitions by file page number
+*  hash. Storage I/O is done outside of partition lock on detached or
+*  pinned pages, so readers of different pages never wait for each other.
+*
 *  CachedFileIO vs STDIO performance tests (Release Mode):
 *    - 50%-97% cache read hits leads to 50%-600% performance growth
 *    - 35%-49% cache read hits leads to 12%-36% performance growth
@@ -29,6 +33,11 @@
 
 #include <algorithm>
 #include <chrono>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 
 using namespace Boson;
 
@@ -39,11 +48,48 @@ using namespace Boson;
 */
 CachedFileIO::CachedFileIO() {
 	this->readOnly = false;
-	this->fileHandler = nullptr;
+	this->backend = nullptr;
+	this->mappedData = nullptr;
+	this->mappedSize = 0;
+	this->inMemory = false;
+	this->partitions = nullptr;
+	this->policyType = ReplacementPolicyType::LRU_POLICY;
 	this->cachePageInfoPool = nullptr;		
 	this->cachePageDataPool = nullptr;
+	this->pageTablePool = nullptr;
+	this->dataPoolMapped = 0;
+	this->hugePages = false;
+	this->bufferPool = nullptr;
+	this->poolFile = nullptr;
+	this->evictCursor = 0;
 	this->maxPagesCount = 0;
-	this->pageCounter = 0;
+	this->partitionsCount = 0;
+	this->partitionsMask = 0;
+	this->pageLoader = nullptr;
+	this->completionRunning = false;
+	this->accessPattern = AccessPattern::NORMAL_ACCESS;
+	this->streamsClock = 0;
+	memset(streams, 0, sizeof(streams));
+	this->dirtyPages = 0;
+	this->loadClock = 0;
+	this->flusherRunning = false;
+	this->dirtyVictimEvicted = false;
+	this->lowWatermark = FLUSHER_LOW_WATERMARK;
+	this->highWatermark = FLUSHER_HIGH_WATERMARK;
+	this->lowDirtyPages = NOT_FOUND;
+	this->highDirtyPages = NOT_FOUND;
+	this->flushCursor = 0;
+	this->maxWritePages = MAX_WRITE_IO_SIZE / PAGE_SIZE;
+	this->poolPagesCount = 0;
+	this->adaptiveSizing = false;
+	this->minBudgetPages = 0;
+	this->maxBudgetPages = 0;
+	this->sampledAccesses = 0;
+	this->growthIncrement = FILE_GROWTH_INCREMENT;
+	this->growthPercent = FILE_GROWTH_PERCENT;
+	this->cacheWarmup = false;
+	this->warmupRunning = false;
+	this->warmupStop = false;
 	resetStats();
 }
 
@@ -62,37 +108,42 @@ CachedFileIO::~CachedFileIO() {
 *
 *  @brief Opens file and allocates cache memory
 * 
-*  @param[in] fileName   - the name of the file to be opened (path)
-*  @param[in] cacheSize  - how much memory for cache to allocate (bytes) 
-*  @param[in] isReadOnly - if true, write operations are not allowed
+*  @param[in] fileName    - the name of the file to be opened (path)
+*  @param[in] cacheSize   - how much memory for cache to allocate (bytes) 
+*  @param[in] isReadOnly  - if true, write operations are not allowed
+*  @param[in] backendType - storage backend (platform native by default),
+*                           MAPPED_BACKEND resolves reads against read only
+*                           memory mapping and does not use cache pages,
+*                           MEMORY_BACKEND keeps database in memory (path is
+*                           optional snapshot file to load) and does not use
+*                           cache pages either
 *
 *  @return true if file opened, false if can't open file
 *
 */
-bool CachedFileIO::open(const char* path, size_t cacheSize, bool isReadOnly) {
-	// return if null pointer
-	if (path == nullptr) return false;
+bool CachedFileIO::open(const char* path, size_t cacheSize, bool isReadOnly, StorageBackendType backendType) {
+	// return if null pointer (in-memory database may have no snapshot file)
+	if (path == nullptr && backendType != MEMORY_BACKEND) return false;
 	// if current file still open, close it
-	if (this->fileHandler != nullptr) close();
-	// try to open existing file for binary read/update (file must exist)
-	errno_t errNo = fopen_s(&(this->fileHandler), path, "r+b");
-	// if file does not exist or another problem
-	if (errNo != 0 || this->fileHandler == nullptr) {
-		// if can`t open file in read only mode return false
-		if (isReadOnly) {
-			this->fileHandler = nullptr;
-			return false;
-		}
-		// try to create new file for binary write/read
-		errNo = fopen_s(&(this->fileHandler), path, "w+b");
-		// if still can't create file return false
-		if (errNo != 0 || this->fileHandler == nullptr) {
-			this->fileHandler = nullptr;
-			return false;
-		}
+	if (this->backend != nullptr) close();
+	// create storage backend of requested type
+	this->backend = StorageBackend::create(backendType);
+	if (this->backend == nullptr) return false;
+	// try to open existing file (or create new one if write permitted)
+	if (!this->backend->open(path, isReadOnly)) {
+		delete this->backend;
+		this->backend = nullptr;
+		return false;
 	}
-	// set mode to no buffering, we will manage buffers and caching by our selves
-	setvbuf(this->fileHandler, nullptr, _IONBF, 0);
+	// Preallocate file space by growth policy
+	this->backend->setGrowthPolicy(growthIncrement, growthPercent);
+	// If backend maps file into memory, then read directly from the mapping
+	this->mappedData = this->backend->getMappedData();
+	this->mappedSize = this->mappedData == nullptr ? 0 : this->backend->getSize();
+	// If backend keeps data in memory, then read and write it in place
+	this->inMemory = !this->backend->isPersistent();
+	// Only direct I/O cache is the sole copy of data worth huge pages
+	this->hugePages = backendType == DIRECT_BACKEND;
 	// Allocated cache
 	if (setCacheSize(cacheSize) == NOT_FOUND) {
 		close();
@@ -100,8 +151,14 @@ bool CachedFileIO::open(const char* path, size_t cacheSize, bool isReadOnly) {
 	}
 	// Set readOnly flag
 	this->readOnly = isReadOnly;
+	// Forget sequential streams of previous file
+	this->accessPattern = AccessPattern::NORMAL_ACCESS;
+	memset(streams, 0, sizeof(streams));
 	// Clear statistics
 	this->resetStats();
+	// Load hot pages of previous session in background
+	this->manifestPath = backend->isPersistent() ? std::string(path) + WARMUP_MANIFEST_SUFFIX : "";
+	if (cacheWarmup) this->startWarmup();
 	// file successfuly opened
 	return true;
 }
@@ -117,19 +174,54 @@ bool CachedFileIO::open(const char* path, size_t cacheSize, bool isReadOnly) {
 */
 bool CachedFileIO::close() {
 	// check if file was opened
-	if (fileHandler == nullptr) return false;
+	if (backend == nullptr) return false;
+	// stop cache warm-up and background flusher
+	this->stopWarmup();
+	this->stopFlusher();
+	// complete asynchronous loads and stop page loader
+	this->stopLoadsCompletion();
+	this->completeAllPageLoads();
+	delete pageLoader;
+	pageLoader = nullptr;
 	// flush buffers if we have write permissions
 	if (!readOnly) this->flush();
+	// remember hot pages for warm-up on next open
+	if (cacheWarmup) this->saveManifest();
+	// cache budget is set per open file
+	this->adaptiveSizing = false;
 	// close file
-	fclose(fileHandler);
+	backend->close();
+	delete backend;
 	// Release memory pool of cached pages
 	this->releasePool();
 	// mark that file is closed
-	this->fileHandler = nullptr;
+	this->backend = nullptr;
+	this->mappedData = nullptr;
+	this->mappedSize = 0;
+	this->inMemory = false;
 	return true;
 }
 
 
+/**
+*
+*  @brief Persists changed pages and saves database to snapshot file
+*  (in-memory database only). Must not run concurrently with writes.
+*
+*  @param[in] path - snapshot file path
+*
+*  @return true if snapshot saved, false if file is not open, backend
+*          does not support snapshots or snapshot can't be written
+*
+*/
+bool CachedFileIO::snapshot(const char* path) {
+	if (backend == nullptr) return false;
+	if (!readOnly) this->flush();
+	return backend->snapshot(path);
+}
+
+
+
 /**
 *
 *  @brief Checks if file is open
@@ -138,7 +230,7 @@ bool CachedFileIO::close() {
 *
 */
 bool CachedFileIO::isOpen() {
-	return fileHandler != nullptr;
+	return backend != nullptr;
 }
 
 
@@ -156,6 +248,171 @@ bool CachedFileIO::isReadOnly() {
 
 
 
+/**
+*
+*  @brief Checks if file data is read directly from memory mapping
+*
+*  @return true - if file is memory mapped, false - otherwise
+*
+*/
+bool CachedFileIO::isMapped() {
+	return mappedData != nullptr;
+}
+
+
+
+/**
+*
+*  @brief Advises storage backend about expected access pattern
+*  (madvise for memory mapped files, posix_fadvise for positional I/O).
+*  Random access disables cache readahead, sequential access starts
+*  readahead of new streams with large window.
+*
+*  @param[in] pattern - expected access pattern (random or sequential)
+*
+*  @return true if advice accepted by backend, false otherwise
+*
+*/
+bool CachedFileIO::setAccessPattern(AccessPattern pattern) {
+	if (backend == nullptr) return false;
+	this->accessPattern = pattern;
+	return backend->advise(pattern);
+}
+
+
+
+/**
+*
+*  @brief Sets cache replacement policy. If cache is already allocated, changed
+*  pages are persisted and cache is rebuilt with new policy (stats are reset),
+*  cache size and adaptive sizing budget are kept.
+*
+*  @param[in] type - replacement policy (LRU, CLOCK or CLOCK-Pro)
+*
+*  @return true if policy set, false if failed to rebuild cache
+*
+*/
+bool CachedFileIO::setReplacementPolicy(ReplacementPolicyType type) {
+	this->policyType = type;
+	if (partitions == nullptr) return true;
+	size_t cacheSize = getCacheSize();
+	if (rebuildCache(poolPagesCount * PAGE_SIZE) == NOT_FOUND) return false;
+	resizeCache(cacheSize / PAGE_SIZE);
+	return true;
+}
+
+
+
+/**
+*
+*  @brief Returns cache replacement policy
+*
+*  @return replacement policy type
+*
+*/
+ReplacementPolicyType CachedFileIO::getReplacementPolicy() {
+	return policyType;
+}
+
+
+
+/**
+*
+*  @brief Starts background flusher thread. Flusher writes dirty pages back
+*  while their share of cache exceeds low watermark, writers wait while it
+*  exceeds high watermark. If flusher is running, it is restarted with new
+*  watermarks.
+*
+*  @param[in] lowWatermark  - dirty pages share to start write back (0..1)
+*  @param[in] highWatermark - dirty pages share to throttle writers (0..1)
+*
+*  @return true if flusher started, false if file is not writable or
+*          watermarks are invalid
+*
+*/
+bool CachedFileIO::startFlusher(double lowWatermark, double highWatermark) {
+	if (backend == nullptr || readOnly || partitions == nullptr) return false;
+	if (lowWatermark < 0 || lowWatermark >= highWatermark || highWatermark > 1.0) return false;
+	stopFlusher();
+	this->lowWatermark = lowWatermark;
+	this->highWatermark = highWatermark;
+	this->lowDirtyPages = uint64_t(lowWatermark * maxPagesCount);
+	this->highDirtyPages = std::max<uint64_t>(uint64_t(highWatermark * maxPagesCount), 1);
+	this->flusherRunning = true;
+	this->flusherThread = std::thread(&CachedFileIO::flusherLoop, this);
+	return true;
+}
+
+
+
+/**
+*
+*  @brief Stops background flusher thread (dirty pages stay in cache)
+*
+*  @return true if flusher has been running, false otherwise
+*
+*/
+bool CachedFileIO::stopFlusher() {
+	{
+		std::lock_guard<std::mutex> lock(flusherMutex);
+		if (!flusherRunning) return false;
+		flusherRunning = false;
+		lowDirtyPages = NOT_FOUND;
+		highDirtyPages = NOT_FOUND;
+	}
+	flusherWakeup.notify_all();
+	writersWakeup.notify_all();
+	flusherThread.join();
+	return true;
+}
+
+
+
+/**
+*
+*  @brief Checks if background flusher is running
+*
+*  @return true if flusher is running, false otherwise
+*
+*/
+bool CachedFileIO::isFlusherRunning() {
+	std::lock_guard<std::mutex> lock(flusherMutex);
+	return flusherRunning;
+}
+
+
+
+/**
+*
+*  @brief Sets size limit of single storage write: runs of adjacent dirty
+*  pages are written back with vector writes up to this size
+*
+*  @param[in] maxWriteSize - write size limit in bytes (at least one page)
+*
+*  @return actual write size limit in bytes (multiple of page size)
+*
+*/
+size_t CachedFileIO::setMaxWriteSize(size_t maxWriteSize) {
+	std::lock_guard<std::mutex> writeBackLock(writeBackMutex);
+	this->maxWritePages = std::max<size_t>(maxWriteSize / PAGE_SIZE, 1);
+	return this->maxWritePages * PAGE_SIZE;
+}
+
+
+
+/**
+*
+*  @brief Returns size limit of single storage write
+*
+*  @return write size limit in bytes
+*
+*/
+size_t CachedFileIO::getMaxWriteSize() {
+	return this->maxWritePages * PAGE_SIZE;
+}
+
+
+
 /**
 * 
 *  @brief Read data from cached file
@@ -169,20 +426,33 @@ bool CachedFileIO::isReadOnly() {
 */
 size_t CachedFileIO::read(size_t position, void* dataBuffer, size_t length) {
 
+	// In case file is memory mapped, read directly from the mapping
+	if (mappedData != nullptr) return readMapped(position, dataBuffer, length);
+
+	// In case database is in memory, read directly from the arena
+	if (inMemory) return readInMemory(position, dataBuffer, length);
+
 	// In case we reading one aligned page
-	if ((position % PAGE_SIZE == 0) && (length == PAGE_SIZE)) {
-		return readPage(position / PAGE_SIZE, dataBuffer);
+	if (((position & PAGE_OFFSET_MASK) == 0) && (length == PAGE_SIZE)) {
+		return readPage(position >> PAGE_SHIFT, dataBuffer);
 	}
 
 	// Check if file handler, data buffer and length are not null
-	if (fileHandler == nullptr || dataBuffer == nullptr || length == 0) return 0;
+	if (backend == nullptr || dataBuffer == nullptr || length == 0) return 0;
 
-	// Time point A
-	auto startTime = std::chrono::high_resolution_clock::now();
+	// Time point A (if call is timed)
+	uint64_t startTime = startTiming();
+	CacheStatsSlot& stats = getStatsSlot();
 
 	// Calculate start and end page number in the file
-	size_t firstPageNo = position / PAGE_SIZE;
-	size_t lastPageNo = (position + length) / PAGE_SIZE;
+	size_t firstPageNo = position >> PAGE_SHIFT;
+	size_t lastPageNo = (position + length - 1) >> PAGE_SHIFT;
+
+	// Load all missing pages of multi-page read in one batch
+	if (lastPageNo > firstPageNo) {
+		std::shared_ptr<PendingPageLoad> load = submitPageLoads(firstPageNo, lastPageNo);
+		if (load != nullptr) stats.cacheMisses += completePageLoads(load);
+	}
 
 	// Initialize local variables
 	CachePage* pageInfo = nullptr;
@@ -194,9 +464,9 @@ size_t CachedFileIO::read(size_t position, void* dataBuffer, size_t length) {
 	// Iterate through requested file pages
 	for (size_t filePage = firstPageNo; filePage <= lastPageNo; filePage++) {
 		
-		// Lookup or load file page to cache
-		pageInfo = searchPageInCache(filePage);
-	    // if (pageInfo == nullptr) return 0;
+		// Lookup or load file page to cache (page is pinned until copied)
+		pageInfo = acquirePage(filePage);
+		if (pageInfo == nullptr) break;
 				
 		// Get cached page description and data
 		pageDataLength = pageInfo->availableDataLength;   // BUG: Page data length 8220 !?
@@ -204,7 +474,7 @@ size_t CachedFileIO::read(size_t position, void* dataBuffer, size_t length) {
 		// Calculate source pointers and data length to copy
 		if (filePage == firstPageNo) {
 			// Case 1: if reading first page
-			size_t firstPageOffset = position % PAGE_SIZE;
+			size_t firstPageOffset = position & PAGE_OFFSET_MASK;
 			src = &pageInfo->data[firstPageOffset];
 			if (firstPageOffset < pageDataLength)
 				if (firstPageOffset + length > pageDataLength)
@@ -213,7 +483,7 @@ size_t CachedFileIO::read(size_t position, void* dataBuffer, size_t length) {
 			else bytesToCopy = 0;
 		} else if (filePage == lastPageNo) {
 			// Case 2: if reading last page
-			size_t remainingBytes = (position + length) % PAGE_SIZE;
+			size_t remainingBytes = ((position + length - 1) & PAGE_OFFSET_MASK) + 1;
 			src = pageInfo->data;                               
 			if (remainingBytes < pageDataLength)                           
 				bytesToCopy = remainingBytes;                              
@@ -226,23 +496,121 @@ size_t CachedFileIO::read(size_t position, void* dataBuffer, size_t length) {
 
 		// Copy available data from cache page to user's data buffer 		
 		memcpy(dst, src, bytesToCopy);   // copy data to user buffer
+		releasePage(pageInfo);           // unpin page (can be evicted now)
 		bytesRead += bytesToCopy;        // increment read bytes counter
 		dst += bytesToCopy;              // increment pointer in user buffer
 
 	}
 
-	// Time point B
-	auto endTime = std::chrono::high_resolution_clock::now();
-	// Calculate and increment read duration
-	this->totalReadDuration += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+	// Time point B, count read latency
+	stopTiming(stats, false, startTime);
+	// Increment bytes read
+	stats.bytesRead += bytesRead;
+	// return bytes read
+	return bytesRead;
+}
+
+
+
+/**
+*
+*  @brief Read data directly from memory mapped file (no cache pages involved)
+*
+*  @param[in]  position   - offset from beginning of the file
+*  @param[out] dataBuffer - data buffer where data copied
+*  @param[in]  length     - data amount to read
+*
+*  @return total bytes amount actually read to the data buffer
+*
+*/
+size_t CachedFileIO::readMapped(size_t position, void* dataBuffer, size_t length) {
+
+	// Check if data buffer and length are not null and position within file
+	if (dataBuffer == nullptr || length == 0 || position >= mappedSize) return 0;
+
+	// Time point A (if call is timed)
+	uint64_t startTime = startTiming();
+
+	// Copy available data from the mapping to user's data buffer
+	size_t bytesRead = std::min<size_t>(length, mappedSize - position);
+	memcpy(dataBuffer, mappedData + position, bytesRead);
+
+	// Time point B, count read latency
+	CacheStatsSlot& stats = getStatsSlot();
+	stopTiming(stats, false, startTime);
+	// Increment bytes read
+	stats.bytesRead += bytesRead;
+	// return bytes read
+	return bytesRead;
+}
+
+
+
+/**
+*
+*  @brief Read data directly from in-memory database arena (no cache pages
+*  involved, so data is not copied twice and arena pages are never evicted)
+*
+*  @param[in]  position   - offset from beginning of the file
+*  @param[out] dataBuffer - data buffer where data copied
+*  @param[in]  length     - data amount to read
+*
+*  @return total bytes amount actually read to the data buffer
+*
+*/
+size_t CachedFileIO::readInMemory(size_t position, void* dataBuffer, size_t length) {
+
+	// Check if data buffer and length are not null
+	if (dataBuffer == nullptr || length == 0) return 0;
+
+	// Time point A (if call is timed)
+	uint64_t startTime = startTiming();
+
+	// Copy available data from the arena to user's data buffer
+	size_t bytesRead = backend->read(position, dataBuffer, length);
+
+	// Time point B, count read latency
+	CacheStatsSlot& stats = getStatsSlot();
+	stopTiming(stats, false, startTime);
 	// Increment bytes read
-	this->totalBytesRead += bytesRead;
+	stats.bytesRead += bytesRead;
 	// return bytes read
 	return bytesRead;
 }
 
 
 
+/**
+*
+*  @brief Write data directly to in-memory database arena (no cache pages
+*  involved, so there is nothing to write back on flush)
+*
+*  @param[in]  position   - offset from beginning of the file
+*  @param[in]  dataBuffer - data buffer with write data
+*  @param[in]  length     - data amount to write
+*
+*  @return total bytes amount written to the arena
+*
+*/
+size_t CachedFileIO::writeInMemory(size_t position, const void* dataBuffer, size_t length) {
+
+	// Time point A (if call is timed)
+	uint64_t startTime = startTiming();
+
+	// Copy user's data buffer to the arena (arena grows if required)
+	size_t bytesWritten = backend->write(position, dataBuffer, length);
+
+	// Time point B, count write latency
+	CacheStatsSlot& stats = getStatsSlot();
+	stopTiming(stats, true, startTime);
+	// Increment bytes written
+	stats.bytesWritten += bytesWritten;
+	// return bytes written
+	return bytesWritten;
+}
+
+
+
 /**
 *
 *  @brief Writes data to cached file
@@ -257,14 +625,17 @@ size_t CachedFileIO::read(size_t position, void* dataBuffer, size_t length) {
 size_t CachedFileIO::write(size_t position, const void* dataBuffer, size_t length) {
 
 	// Check if file handler, data buffer and length are not null
-	if (fileHandler == nullptr || this->readOnly || dataBuffer == nullptr || length == 0) return 0;
+	if (backend == nullptr || this->readOnly || dataBuffer == nullptr || length == 0) return 0;
 
-	// Time point A
-	auto startTime = std::chrono::high_resolution_clock::now();
+	// In case database is in memory, write directly to the arena
+	if (inMemory) return writeInMemory(position, dataBuffer, length);
+
+	// Time point A (if call is timed)
+	uint64_t startTime = startTiming();
 	
 	// Calculate start and end page number in the file
-	size_t firstPageNo = position / PAGE_SIZE;
-	size_t lastPageNo = (position + length) / PAGE_SIZE;
+	size_t firstPageNo = position >> PAGE_SHIFT;
+	size_t lastPageNo = (position + length - 1) >> PAGE_SHIFT;
 
 	// Initialize local variables
 	CachePage* pageInfo = nullptr;
@@ -277,17 +648,19 @@ size_t CachedFileIO::write(size_t position, const void* dataBuffer, size_t lengt
 	// Iterate through file pages
 	for (size_t filePage = firstPageNo; filePage <= lastPageNo; filePage++) {
 
-		// Fetch-before-write (FBW)
-		pageInfo = searchPageInCache(filePage);
-		//if (pageInfo == nullptr) return 0;
+		// Wait for background flusher if too many pages are dirty
+		if (dirtyPages.load(std::memory_order_relaxed) > highDirtyPages.load(std::memory_order_relaxed)) {
+			throttleWriter();
+		}
 
-		// Get cached page description and data
-		pageDataLength = pageInfo->availableDataLength;
+		// Fetch-before-write (FBW), page is pinned until changed
+		pageInfo = acquirePage(filePage);
+		if (pageInfo == nullptr) break;
 
 		// Calculate source pointers and data length to write
 		if (filePage == firstPageNo) {
 			// Case 1: if writing first page
-			offset = position % PAGE_SIZE;
+			offset = position & PAGE_OFFSET_MASK;
 			dst = &pageInfo->data[offset];
 			bytesToCopy = std::min(length, PAGE_SIZE - offset);
 		} else if (filePage == lastPageNo) {
@@ -302,20 +675,25 @@ size_t CachedFileIO::write(size_t position, const void* dataBuffer, size_t lengt
 			bytesToCopy = PAGE_SIZE;
 		}
 
-		// Copy available data from user's data buffer to cache page 
-		memcpy(dst, src, bytesToCopy);       // copy user buffer data to cache page
-		pageInfo->state = PageState::DIRTY;  // mark page as "dirty" (rewritten)
-		pageInfo->availableDataLength = std::max(pageDataLength, offset + bytesToCopy);
+		// Copy available data from user's data buffer to cache page
+		// under partition lock (page can't be persisted half written)
+		{
+			std::lock_guard<std::mutex> lock(getPartition(filePage).mutex);
+			pageDataLength = pageInfo->availableDataLength;
+			memcpy(dst, src, bytesToCopy);       // copy user buffer data to cache page
+			markPageDirty(getPartition(filePage), pageInfo); // mark page as "dirty" (rewritten)
+			pageInfo->availableDataLength = std::max(pageDataLength, offset + bytesToCopy);
+		}
+		releasePage(pageInfo);               // unpin page (can be evicted now)
 		bytesWritten += bytesToCopy;         // increment written bytes counter
 		src += bytesToCopy;                  // increment pointer in user buffer
 
 	}
-	// Time point B
-	auto endTime = std::chrono::high_resolution_clock::now();
-	// Calculate and increment write duration
-	this->totalWriteDuration += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+	// Time point B, count write latency
+	CacheStatsSlot& stats = getStatsSlot();
+	stopTiming(stats, true, startTime);
 	// Increment bytes written
-	this->totalBytesWritten += bytesWritten;
+	stats.bytesWritten += bytesWritten;
 	// return bytes written
 	return bytesWritten;
 }
@@ -335,26 +713,33 @@ size_t CachedFileIO::write(size_t position, const void* dataBuffer, size_t lengt
 size_t CachedFileIO::readPage(size_t pageNo, void* userPageBuffer) {
 
 	// Check if file handler, data buffer and length are not null
-	if (fileHandler == nullptr || userPageBuffer == nullptr) return 0;
+	if (backend == nullptr || userPageBuffer == nullptr) return 0;
 
-	// Time point A
-	auto startTime = std::chrono::high_resolution_clock::now();
+	// In case file is memory mapped, read directly from the mapping
+	if (mappedData != nullptr) return readMapped(pageNo * PAGE_SIZE, userPageBuffer, PAGE_SIZE);
 
-	// Lookup or load file page to cache
-	CachePage* pageInfo = searchPageInCache(pageNo);
+	// In case database is in memory, read directly from the arena
+	if (inMemory) return readInMemory(pageNo * PAGE_SIZE, userPageBuffer, PAGE_SIZE);
+
+	// Time point A (if call is timed)
+	uint64_t startTime = startTiming();
+
+	// Lookup or load file page to cache (page is pinned until copied)
+	CachePage* pageInfo = acquirePage(pageNo);
+	if (pageInfo == nullptr) return 0;
 
 	// Copy available data from cache page to user's data buffer
 	uint8_t* src = pageInfo->data;
 	uint8_t* dst = (uint8_t*) userPageBuffer;
 	size_t availableData = pageInfo->availableDataLength;	
 	memcpy(dst, src, availableData);
+	releasePage(pageInfo);
 		
-	// Time point B
-	auto endTime = std::chrono::high_resolution_clock::now();
-	// Calculate and increment read duration
-	this->totalReadDuration += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+	// Time point B, count read latency
+	CacheStatsSlot& stats = getStatsSlot();
+	stopTiming(stats, false, startTime);
 	// Increment bytes read
-	this->totalBytesRead += availableData;
+	stats.bytesRead += availableData;
 
 	return availableData;
 }
@@ -374,74 +759,146 @@ size_t CachedFileIO::readPage(size_t pageNo, void* userPageBuffer) {
 */
 size_t CachedFileIO::writePage(size_t pageNo, const void* userPageBuffer) {
 	// Check if file handler and data buffer are not null, and write is allowed
-	if (fileHandler == nullptr || this->readOnly || userPageBuffer == nullptr) return 0;
+	if (backend == nullptr || this->readOnly || userPageBuffer == nullptr) return 0;
 
-	// Time point A
-	auto startTime = std::chrono::high_resolution_clock::now();
+	// In case database is in memory, write directly to the arena
+	if (inMemory) return writeInMemory(pageNo * PAGE_SIZE, userPageBuffer, PAGE_SIZE);
+
+	// Time point A (if call is timed)
+	uint64_t startTime = startTiming();
 
-	// Fetch-before-write (FBW)
-	CachePage* pageInfo = searchPageInCache(pageNo);
+	// Wait for background flusher if too many pages are dirty
+	if (dirtyPages.load(std::memory_order_relaxed) > highDirtyPages.load(std::memory_order_relaxed)) {
+		throttleWriter();
+	}
+
+	// Fetch-before-write (FBW), page is pinned until changed
+	CachePage* pageInfo = acquirePage(pageNo);
+	if (pageInfo == nullptr) return 0;
 
 	// Initialize local variables
 	uint8_t* src = (uint8_t*)userPageBuffer;
 	uint8_t* dst = pageInfo->data;
 	size_t bytesToCopy = PAGE_SIZE;
 
-	memcpy(dst, src, bytesToCopy);               // copy user buffer data to cache page
-	pageInfo->state = PageState::DIRTY;          // mark page as "dirty" (rewritten)
-	pageInfo->availableDataLength = bytesToCopy; // set available data as PAGE_SIZE
+	{
+		CachePartition& partition = getPartition(pageNo);
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		memcpy(dst, src, bytesToCopy);               // copy user buffer data to cache page
+		markPageDirty(partition, pageInfo);          // mark page as "dirty" (rewritten)
+		pageInfo->availableDataLength = bytesToCopy; // set available data as PAGE_SIZE
+	}
+	releasePage(pageInfo);
 
-	// Time point B
-	auto endTime = std::chrono::high_resolution_clock::now();
-	// Calculate and increment write duration
-	this->totalWriteDuration += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+	// Time point B, count write latency
+	CacheStatsSlot& stats = getStatsSlot();
+	stopTiming(stats, true, startTime);
 	// Increment bytes written
-	this->totalBytesWritten += bytesToCopy;
+	stats.bytesWritten += bytesToCopy;
 
 	return bytesToCopy;
 }
 
 
 
+/**
+*
+*  @brief Pins cache page of the file position and returns reference to its
+*  data (no copy). Page can't be evicted until reference is released, so
+*  references must be short lived and released before close or cache
+*  resize. PageRef::loadStamp() changes every time page is placed to the
+*  cache, so callers can skip checks of data verified since page load.
+*
+*  @param[in] position - offset from beginning of the file
+*
+*  @return page reference: pointer to data at position and data length up
+*  to the end of page (empty reference if position is beyond file data or
+*  no cache page can be freed)
+*
+*/
+PageRef CachedFileIO::pin(size_t position) {
+
+	PageRef ref;
+
+	// In case file is memory mapped, refer to the mapping directly
+	if (mappedData != nullptr) {
+		if (position >= mappedSize) return ref;
+		size_t pageEnd = (position | PAGE_OFFSET_MASK) + 1;
+		ref.bytes = mappedData + position;
+		ref.bytesCount = std::min<size_t>(pageEnd, mappedSize) - position;
+		return ref;
+	}
+
+	if (backend == nullptr) return ref;
+
+	// In case database is in memory, refer to the arena directly
+	if (inMemory) {
+		size_t available = 0;
+		uint8_t* data = backend->getMemoryData(position, available);
+		if (data == nullptr) return ref;
+		size_t pageEnd = (position | PAGE_OFFSET_MASK) + 1;
+		ref.bytes = data;
+		ref.bytesCount = std::min<size_t>(available, pageEnd - position);
+		return ref;
+	}
+
+	// Lookup or load file page to cache (page stays pinned by reference)
+	CachePage* pageInfo = acquirePage(position >> PAGE_SHIFT);
+	if (pageInfo == nullptr) return ref;
+	size_t pageOffset = position & PAGE_OFFSET_MASK;
+	if (pageOffset >= pageInfo->availableDataLength) {
+		releasePage(pageInfo);
+		return ref;
+	}
+	ref.owner = this;
+	ref.page = pageInfo;
+	ref.bytes = pageInfo->data + pageOffset;
+	ref.bytesCount = pageInfo->availableDataLength - pageOffset;
+	return ref;
+}
+
+
+
 /**
 * 
-*  @brief Persists all changed cache pages to storage device
+*  @brief Persists all changed cache pages to storage device. Numbers of
+*  dirty pages are collected first, then pages are written back in batches
+*  (partitions are locked only to take page snapshots), storage device is
+*  synced out of the locks
 * 
 *  @return true if all changed cache pages been persisted, false otherwise
 * 
 */
 size_t CachedFileIO::flush() {
 
-	if (fileHandler == nullptr || this->readOnly) return 0;
+	if (backend == nullptr || this->readOnly) return 0;
 
 	// Time point A
-	auto startTime = std::chrono::high_resolution_clock::now();
-
-	// Suppose all pages will be persisted
-	bool allDirtyPagesPersisted = true;
+	uint64_t startTime = timestamp();
+
+	// Collect numbers of pages dirty at the moment of the call
+	std::vector<size_t> dirtyPageNumbers;
+	dirtyPageNumbers.reserve(dirtyPages.load());
+	for (size_t i = 0; i < partitionsCount; i++) {
+		std::lock_guard<std::mutex> lock(partitions[i].mutex);
+		for (auto& entry : partitions[i].dirtyMap) dirtyPageNumbers.push_back(entry.first);
+	}
 
-	// Sort cache list by file page number in ascending order for sequential write
-	cacheList.sort([](const CachePage* cp1, const CachePage* cp2)
-		{
-			if (cp1->filePageNo == cp2->filePageNo)
-				return cp1->filePageNo < cp2->filePageNo;
-			return cp1->filePageNo < cp2->filePageNo;
-		});
+	// Merge partitions dirty pages in file order for sequential write
+	std::sort(dirtyPageNumbers.begin(), dirtyPageNumbers.end());
 
-	// Persist pages to storage device
-	for (CachePage* node : cacheList) {
-		if (node->state = PageState::DIRTY) {
-			allDirtyPagesPersisted = allDirtyPagesPersisted && persistCachePage(node);
-		}
+	// Write pages back in batches (pages written back meanwhile are skipped)
+	bool allDirtyPagesPersisted = true;
+	for (size_t i = 0; i < dirtyPageNumbers.size(); i += FLUSHER_BATCH_PAGES) {
+		size_t batchPages = std::min<size_t>(dirtyPageNumbers.size() - i, FLUSHER_BATCH_PAGES);
+		if (!writeBackPages(&dirtyPageNumbers[i], batchPages)) allDirtyPagesPersisted = false;
 	}
-	
+
 	// flush buffers to storage device
-	bool buffersFlushed = (fflush(fileHandler) == 0);
+	bool buffersFlushed = backend->sync();
 
-	// Time point B
-	auto endTime = std::chrono::high_resolution_clock::now();
-	// Calculate and increment write duration
-	this->totalWriteDuration += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+	// Time point B, increment write duration
+	getStatsSlot().writeDuration += timestamp() - startTime;
 
 	return allDirtyPagesPersisted && buffersFlushed;
 
@@ -450,64 +907,276 @@ size_t CachedFileIO::flush() {
 
 
 /**
-* @brief Reset IO statistics
-* @param type - requested stats type
-* @return value of stats
+*
+*  @brief Persists limited amount of dirty pages continuing in file order
+*  from the page where previous incremental flush stopped (wraps around to
+*  the file beginning), so checkpoint can be split into small increments
+*
+*  @param[in] maxPages - maximum pages to persist (NOT_FOUND - all dirty pages)
+*
+*  @return amount of pages persisted
+*
 */
-void CachedFileIO::resetStats() {
-	this->cacheRequests = 0;
-	this->cacheMisses = 0;
-	this->totalBytesRead = 0;
-	this->totalBytesWritten = 0;
-	this->totalReadDuration = 0;
-	this->totalWriteDuration = 0;
+size_t CachedFileIO::flush(size_t maxPages) {
+	bool succeeded;
+	return flush(maxPages, succeeded);
 }
 
 
 
 /**
-* @brief Return IO statistics
-* @param type - requested stats type
-* @return value of stats
+*
+*  @brief Persists limited amount of dirty pages (see flush(maxPages)) and
+*  reports if any page write or storage device sync failed
+*
+*  @param[in]  maxPages  - maximum pages to persist (NOT_FOUND - all dirty pages)
+*  @param[out] succeeded - true if no write or sync failed, false otherwise
+*
+*  @return amount of pages persisted
+*
 */
-double CachedFileIO::getStats(CachedFileStats type) {
+size_t CachedFileIO::flush(size_t maxPages, bool& succeeded) {
 
-	double totalRequests = (double)cacheRequests;
-	double totalCacheMisses = (double)cacheMisses;
-	double seconds = 0;
-	double megabytes = 0;
+	succeeded = false;
+	if (backend == nullptr || this->readOnly) return 0;
+	succeeded = true;
 
-	switch (type) {
-	case CachedFileStats::TOTAL_REQUESTS:
-		return double(totalRequests);
-	case CachedFileStats::TOTAL_CACHE_MISSES:
-		return double(cacheMisses);
-	case CachedFileStats::TOTAL_CACHE_HITS:
-		return double(totalRequests - cacheMisses);
-	case CachedFileStats::TOTAL_BYTES_WRITTEN:
-		return double(totalBytesWritten);
-	case CachedFileStats::TOTAL_BYTES_READ:
-		return double(totalBytesRead);
-	case CachedFileStats::TOTAL_WRITE_TIME_NS:
-		return double(totalWriteDuration);
-	case CachedFileStats::TOTAL_READ_TIME_NS:
-		return double(totalReadDuration);
-	case CachedFileStats::CACHE_HITS_RATE:
-		if (totalRequests == 0) return 0;
-		return (totalRequests - totalCacheMisses) / totalRequests * 100.0;
-	case CachedFileStats::CACHE_MISSES_RATE:
-		if (totalRequests == 0) return 0;
-		return totalCacheMisses / totalRequests * 100.0;
-	case CachedFileStats::READ_THROUGHPUT:
-		if (this->totalReadDuration == 0) return 0;
-		seconds = double(this->totalReadDuration) / 1000000000.0;
-		megabytes = double(this->totalBytesRead) / (1024 * 1024);
+	// Time point A
+	uint64_t startTime = timestamp();
+
+	// Persist pages in small batches (pages rewritten meanwhile are not chased)
+	size_t pagesToPersist = std::min<size_t>(maxPages, dirtyPages.load());
+	size_t pagesPersisted = 0;
+	while (pagesPersisted < pagesToPersist) {
+		size_t batchPages = std::min<size_t>(pagesToPersist - pagesPersisted, FLUSHER_BATCH_PAGES);
+		bool allWritten = true;
+		size_t pagesWritten = writeBackDirtyPages(batchPages, &allWritten);
+		succeeded = succeeded && allWritten;
+		if (pagesWritten == 0) break;
+		pagesPersisted += pagesWritten;
+	}
+
+	// flush buffers to storage device
+	if (pagesPersisted > 0) succeeded = backend->sync() && succeeded;
+
+	// Time point B, increment write duration
+	getStatsSlot().writeDuration += timestamp() - startTime;
+
+	return pagesPersisted;
+}
+
+
+
+/**
+*
+*  @brief Starts incremental flush in separate thread. Future must be waited
+*  before file is closed or cache is resized.
+*
+*  @param[in] maxPages - maximum pages to persist (NOT_FOUND - all dirty pages)
+*
+*  @return future of amount of pages persisted
+*
+*/
+std::future<size_t> CachedFileIO::flushAsync(size_t maxPages) {
+	return std::async(std::launch::async, [this, maxPages]() {
+		return this->flush(maxPages);
+	});
+}
+
+
+
+/**
+*
+*  @brief Loads all missing pages of the file range to the cache in one batch
+*  of asynchronous reads (io_uring or thread pool) and waits for completion
+*
+*  @param[in] position - offset from beginning of the file
+*  @param[in] length   - range length in bytes
+*
+*  @return amount of pages loaded to the cache
+*
+*/
+size_t CachedFileIO::prefetch(size_t position, size_t length) {
+	if (backend == nullptr || mappedData != nullptr || inMemory || length == 0) return 0;
+	size_t firstPageNo = position >> PAGE_SHIFT;
+	size_t lastPageNo = (position + length - 1) >> PAGE_SHIFT;
+	std::shared_ptr<PendingPageLoad> load = submitPageLoads(firstPageNo, lastPageNo);
+	if (load == nullptr) return 0;
+	return completePageLoads(load);
+}
+
+
+
+/**
+*
+*  @brief Starts asynchronous read: all missing pages of the range are
+*  submitted to the page loader in one batch and method returns immediately.
+*  Loaded pages are placed to the cache by completion thread as soon as
+*  they are read (even if the future is dropped). Data is copied to the
+*  user buffer when result of the future requested (by any thread, while
+*  file stays open).
+*
+*  @param[in]  position   - offset from beginning of the file
+*  @param[out] dataBuffer - data buffer where data copied (must stay valid)
+*  @param[in]  length     - data amount to read
+*
+*  @return future of total bytes amount actually read to the data buffer
+*
+*/
+std::future<size_t> CachedFileIO::readAsync(size_t position, void* dataBuffer, size_t length) {
+	std::shared_ptr<PendingPageLoad> load = nullptr;
+	if (backend != nullptr && mappedData == nullptr && !inMemory && length > 0) {
+		load = submitPageLoads(position >> PAGE_SHIFT, (position + length - 1) >> PAGE_SHIFT);
+	}
+	return std::async(std::launch::deferred, [this, load, position, dataBuffer, length]() {
+		if (load != nullptr) this->completePageLoads(load);
+		return this->read(position, dataBuffer, length);
+	});
+}
+
+
+
+/**
+* @brief Reset IO statistics
+* @param type - requested stats type
+* @return value of stats
+*/
+void CachedFileIO::resetStats() {
+	for (CacheStatsSlot& slot : statsSlots) {
+		slot.cacheRequests = 0;
+		slot.cacheMisses = 0;
+		slot.bytesRead = 0;
+		slot.bytesWritten = 0;
+		slot.readDuration = 0;
+		slot.writeDuration = 0;
+		slot.readaheadPages = 0;
+		slot.readaheadHits = 0;
+		slot.readaheadWasted = 0;
+		slot.writeBackPages = 0;
+		slot.dirtyEvictions = 0;
+		slot.throttleDuration = 0;
+		slot.storageWrites = 0;
+		slot.storageWriteBytes = 0;
+		slot.warmupPages = 0;
+		slot.readLatency.reset();
+		slot.writeLatency.reset();
+	}
+	for (size_t i = 0; i < partitionsCount; i++) {
+		std::lock_guard<std::mutex> lock(partitions[i].mutex);
+		partitions[i].policy->resetStats();
+	}
+}
+
+
+
+/**
+* @brief Return IO statistics
+* @param type - requested stats type
+* @return value of stats
+*/
+double CachedFileIO::getStats(CachedFileStats type) {
+
+	// Sum up thread striped counters
+	uint64_t cacheRequests = 0, cacheMisses = 0;
+	uint64_t totalBytesRead = 0, totalBytesWritten = 0;
+	uint64_t totalReadDuration = 0, totalWriteDuration = 0;
+	uint64_t readaheadPages = 0, readaheadHits = 0, readaheadWasted = 0;
+	uint64_t writeBackPages = 0, dirtyEvictions = 0, throttleDuration = 0;
+	uint64_t storageWrites = 0, storageWriteBytes = 0, warmupPages = 0;
+	for (CacheStatsSlot& slot : statsSlots) {
+		warmupPages += slot.warmupPages.load(std::memory_order_relaxed);
+		storageWrites += slot.storageWrites.load(std::memory_order_relaxed);
+		storageWriteBytes += slot.storageWriteBytes.load(std::memory_order_relaxed);
+		writeBackPages += slot.writeBackPages.load(std::memory_order_relaxed);
+		dirtyEvictions += slot.dirtyEvictions.load(std::memory_order_relaxed);
+		throttleDuration += slot.throttleDuration.load(std::memory_order_relaxed);
+		readaheadPages += slot.readaheadPages.load(std::memory_order_relaxed);
+		readaheadHits += slot.readaheadHits.load(std::memory_order_relaxed);
+		readaheadWasted += slot.readaheadWasted.load(std::memory_order_relaxed);
+		cacheRequests += slot.cacheRequests.load(std::memory_order_relaxed);
+		cacheMisses += slot.cacheMisses.load(std::memory_order_relaxed);
+		totalBytesRead += slot.bytesRead.load(std::memory_order_relaxed);
+		totalBytesWritten += slot.bytesWritten.load(std::memory_order_relaxed);
+		totalReadDuration += slot.readDuration.load(std::memory_order_relaxed);
+		totalWriteDuration += slot.writeDuration.load(std::memory_order_relaxed);
+	}
+
+	double totalRequests = (double)cacheRequests;
+	double totalCacheMisses = (double)cacheMisses;
+	double seconds = 0;
+	double megabytes = 0;
+	uint64_t admissionsRejected = 0;
+
+	switch (type) {
+	case CachedFileStats::TOTAL_REQUESTS:
+		return double(totalRequests);
+	case CachedFileStats::TOTAL_CACHE_MISSES:
+		return double(cacheMisses);
+	case CachedFileStats::TOTAL_CACHE_HITS:
+		return double(totalRequests - cacheMisses);
+	case CachedFileStats::TOTAL_BYTES_WRITTEN:
+		return double(totalBytesWritten);
+	case CachedFileStats::TOTAL_BYTES_READ:
+		return double(totalBytesRead);
+	case CachedFileStats::TOTAL_WRITE_TIME_NS:
+		return double(totalWriteDuration);
+	case CachedFileStats::TOTAL_READ_TIME_NS:
+		return double(totalReadDuration);
+	case CachedFileStats::CACHE_HITS_RATE:
+		if (totalRequests == 0) return 0;
+		return (totalRequests - totalCacheMisses) / totalRequests * 100.0;
+	case CachedFileStats::CACHE_MISSES_RATE:
+		if (totalRequests == 0) return 0;
+		return totalCacheMisses / totalRequests * 100.0;
+	case CachedFileStats::READ_THROUGHPUT:
+		if (totalReadDuration == 0) return 0;
+		seconds = double(totalReadDuration) / 1000000000.0;
+		megabytes = double(totalBytesRead) / (1024 * 1024);
 		return megabytes / seconds;
 	case CachedFileStats::WRITE_THROUGHPUT:
-		if (this->totalWriteDuration == 0) return 0;
-		seconds = double(this->totalWriteDuration) / 1000000000.0;
-		megabytes = double(this->totalBytesWritten) / (1024 * 1024);
+		if (totalWriteDuration == 0) return 0;
+		seconds = double(totalWriteDuration) / 1000000000.0;
+		megabytes = double(totalBytesWritten) / (1024 * 1024);
 		return megabytes / seconds;	
+	case CachedFileStats::TOTAL_ADMISSIONS_REJECTED:
+		for (size_t i = 0; i < partitionsCount; i++) {
+			std::lock_guard<std::mutex> lock(partitions[i].mutex);
+			admissionsRejected += partitions[i].policy->getAdmissionsRejected();
+		}
+		return double(admissionsRejected);
+	case CachedFileStats::READAHEAD_PAGES:
+		return double(readaheadPages);
+	case CachedFileStats::READAHEAD_HITS:
+		return double(readaheadHits);
+	case CachedFileStats::READAHEAD_WASTED:
+		return double(readaheadWasted);
+	case CachedFileStats::DIRTY_PAGES:
+		return double(dirtyPages.load());
+	case CachedFileStats::BACKGROUND_WRITEBACKS:
+		return double(writeBackPages);
+	case CachedFileStats::DIRTY_EVICTIONS:
+		return double(dirtyEvictions);
+	case CachedFileStats::TOTAL_THROTTLE_TIME_NS:
+		return double(throttleDuration);
+	case CachedFileStats::TOTAL_STORAGE_WRITES:
+		return double(storageWrites);
+	case CachedFileStats::AVERAGE_WRITE_IO_SIZE:
+		if (storageWrites == 0) return 0;
+		return double(storageWriteBytes) / double(storageWrites);
+	case CachedFileStats::READ_LATENCY_P50_NS:
+		return getLatencyPercentile(false, 50.0);
+	case CachedFileStats::READ_LATENCY_P99_NS:
+		return getLatencyPercentile(false, 99.0);
+	case CachedFileStats::READ_LATENCY_P999_NS:
+		return getLatencyPercentile(false, 99.9);
+	case CachedFileStats::WRITE_LATENCY_P50_NS:
+		return getLatencyPercentile(true, 50.0);
+	case CachedFileStats::WRITE_LATENCY_P99_NS:
+		return getLatencyPercentile(true, 99.0);
+	case CachedFileStats::WRITE_LATENCY_P999_NS:
+		return getLatencyPercentile(true, 99.9);
+	case CachedFileStats::WARMUP_PAGES:
+		return double(warmupPages);
 	}
 	return 0.0;
 }
@@ -522,12 +1191,8 @@ double CachedFileIO::getStats(CachedFileStats type) {
 *
 */
 size_t CachedFileIO::getFileSize() {
-	if (fileHandler == nullptr) return 0;
-	size_t currentPosition = _ftelli64(fileHandler);
-	_fseeki64(fileHandler, 0, SEEK_END);
-	size_t fileSize = _ftelli64(fileHandler);
-	_fseeki64(fileHandler, currentPosition, SEEK_SET);
-	return fileSize;
+	if (backend == nullptr) return 0;
+	return backend->getSize();
 }
 
 
@@ -550,10 +1215,12 @@ size_t CachedFileIO::getCacheSize() {
 }
 
 
-
 /**
 *
-*  @brief Resize cache at runtime: releases memory and allocate new one
+*  @brief Resize cache at runtime: cache within allocated pool is resized in
+*  place (cached pages above new size are evicted), larger cache is rebuilt.
+*  Explicit cache size turns adaptive sizing off.
+*
 *  @param cacheSize - new cache size
 *  @return actual cache size in bytes or NOT_FOUND and closes file if failed to allocate
 *
@@ -563,25 +1230,61 @@ size_t CachedFileIO::setCacheSize(size_t cacheSize) {
 	// Check minimal cache size
 	if (cacheSize < MINIMAL_CACHE) cacheSize = MINIMAL_CACHE;
 
+	// Cache size is fixed from now on
+	this->adaptiveSizing = false;
+
+	// Resize in place if allocated pool is large enough
+	if (partitions != nullptr && (cacheSize / PAGE_SIZE <= poolPagesCount || bufferPool != nullptr)) {
+		resizeCache(cacheSize / PAGE_SIZE);
+		this->resetStats();
+		return this->maxPagesCount * PAGE_SIZE;
+	}
+
+	return rebuildCache(cacheSize);
+}
+
+
+
+/**
+*
+*  @brief Rebuilds cache: persists changed pages, releases memory and
+*  allocates new pool of requested size
+*
+*  @param cacheSize - new cache size
+*  @return actual cache size in bytes or NOT_FOUND and closes file if failed to allocate
+*
+*/
+size_t CachedFileIO::rebuildCache(size_t cacheSize) {
+
+	// Stop cache warm-up and background flusher while cache is rebuilt
+	this->stopWarmup();
+	bool restartFlusher = this->stopFlusher();
+
 	// check if cache is already allocated
-	if (cachePageInfoPool != nullptr) {
+	if (partitions != nullptr) {
+		// Complete asynchronous loads to get reserved pages back
+		this->completeAllPageLoads();
 		// Persist all changed pages to storage device
 		this->flush();
-		// Release allocated memory, list and map
+		// Release allocated memory, partitions lists and maps
 		this->releasePool();
-		// Clear cache pages list and hashmap
-		this->cacheList.clear();
-		this->cacheMap.clear();
 	} 
 	
-	// Calculate pages count
-	this->pageCounter = 0;
+	// Memory mapped file and in-memory database are accessed in place, so
+	// cache pages are not required
+	if (mappedData != nullptr || inMemory) {
+		this->resetStats();
+		return 0;
+	}
+
+	// Calculate pages count (file in shared pool may hold up to pool size)
 	this->maxPagesCount = cacheSize / PAGE_SIZE;
+	this->poolPagesCount = this->maxPagesCount;
+	if (bufferPool != nullptr) this->poolPagesCount = bufferPool->getPagesCount();
 
 	// Try to allocate new cache
 	try {
-		this->allocatePool(this->maxPagesCount);
-		this->cacheMap.reserve(maxPagesCount);
+		this->allocatePool(this->poolPagesCount);
 	} catch (std::bad_alloc& ba) {	
 		// close file and return NOT_FOUND
 		std::cout << "Can't allocate cache of size " << cacheSize << ": " << ba.what() << std::endl;
@@ -589,8 +1292,12 @@ size_t CachedFileIO::setCacheSize(size_t cacheSize) {
 		return NOT_FOUND;
 	}
 	
+	// Cache size of file in shared pool is its quota
+	if (bufferPool != nullptr) this->resizeCache(this->maxPagesCount);
 	// Reset stats
 	this->resetStats();
+	// Restart background flusher with new cache capacity
+	if (restartFlusher) this->startFlusher(lowWatermark, highWatermark);
 	// Return cache size in bytes
 	return this->maxPagesCount * PAGE_SIZE;
 }
@@ -598,204 +1305,1797 @@ size_t CachedFileIO::setCacheSize(size_t cacheSize) {
 
 
 /**
-* @brief Allocates memory pool for cache pages
+*
+*  @brief Turns adaptive cache sizing on: pool is allocated for maximal
+*  budget (cache is rebuilt if current pool is smaller), then cache is
+*  resized in place by sampled miss ratio curve within the budget.
+*
+*  @param minCacheSize - minimal cache size (bytes)
+*  @param maxCacheSize - maximal cache size (bytes), equal to minimal one
+*                        fixes cache size
+*
+*  @return true if budget is set, false if file is not open, file is memory
+*          mapped or in memory, uses shared buffer pool, budget is invalid
+*          or failed to allocate cache
+*
 */
-void CachedFileIO::allocatePool(size_t pagesToAllocate) {
-	this->cachePageInfoPool = new CachePage[pagesToAllocate];
-	this->cachePageDataPool = new CachePageData[pagesToAllocate];
+bool CachedFileIO::setCacheBudget(size_t minCacheSize, size_t maxCacheSize) {
+	if (backend == nullptr || mappedData != nullptr || inMemory || bufferPool != nullptr) return false;
+	if (minCacheSize < MINIMAL_CACHE) minCacheSize = MINIMAL_CACHE;
+	if (maxCacheSize < minCacheSize) return false;
+	size_t cacheSize = std::min(std::max<size_t>(getCacheSize(), minCacheSize), maxCacheSize);
+	// Pool is allocated for maximal budget once, later resizes are in place
+	if (maxCacheSize / PAGE_SIZE > poolPagesCount) {
+		if (rebuildCache(maxCacheSize) == NOT_FOUND) return false;
+	}
+	setCacheSize(cacheSize);
+	// Start new miss ratio curve
+	std::lock_guard<std::mutex> lock(sizingMutex);
+	this->minBudgetPages = std::max<size_t>(minCacheSize / PAGE_SIZE, partitionsCount);
+	this->maxBudgetPages = maxCacheSize / PAGE_SIZE;
+	this->sampledAccesses = 0;
+	missRatioCurve.init(maxBudgetPages);
+	this->adaptiveSizing = minBudgetPages < maxBudgetPages;
+	return true;
 }
 
 
+
 /**
-* @brief Releases memory pool
+*
+*  @brief Checks if cache is resized adaptively
+*
+*  @return true if adaptive sizing is on, false otherwise
+*
 */
-void CachedFileIO::releasePool() {
-	this->maxPagesCount = 0;
-	this->pageCounter = 0;
-	cacheList.clear();
-	cacheMap.clear();
-	delete[] cachePageInfoPool;
-	delete[] cachePageDataPool;
-	cachePageInfoPool = nullptr;
-	cachePageDataPool = nullptr;
+bool CachedFileIO::isAdaptiveCache() {
+	return adaptiveSizing;
 }
 
 
+
 /**
-* @brief Allocates cache page from memory pool
+*
+*  @brief Resizes cache in place within allocated pool: resident pages limit
+*  of every partition is changed, pages above lower limit are evicted
+*  (dirty ones are persisted), pinned pages are evicted later on allocation.
+*
+*  @param pagesCount - new cache size (pages)
+*  @return actual cache size (pages)
+*
 */
-CachePage* CachedFileIO::allocatePage() {
+size_t CachedFileIO::resizeCache(size_t pagesCount) {
+	pagesCount = std::min<size_t>(std::max<size_t>(pagesCount, partitionsCount), poolPagesCount);
+	for (size_t i = 0; i < partitionsCount; i++) {
+		CachePartition& partition = partitions[i];
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		partition.limit = pagesCount / partitionsCount + (i < pagesCount % partitionsCount ? 1 : 0);
+		partition.policy->setCapacity(partition.limit);
+		trimPartition(partition);
+	}
+	this->maxPagesCount = pagesCount;
+	if (poolFile != nullptr) bufferPool->setQuota(poolFile, pagesCount);
+	// Rescale flusher watermarks to new cache capacity
+	std::lock_guard<std::mutex> lock(flusherMutex);
+	if (flusherRunning) {
+		this->lowDirtyPages = uint64_t(lowWatermark * pagesCount);
+		this->highDirtyPages = std::max<uint64_t>(uint64_t(highWatermark * pagesCount), 1);
+	}
+	return pagesCount;
+}
 
-	if (pageCounter >= maxPagesCount) return nullptr;
 
-	// Allocate memory for cache page
-	CachePage* newPage = &cachePageInfoPool[pageCounter];
-	// Clear cache page info fields
-	newPage->filePageNo = NOT_FOUND;
-	newPage->state = PageState::CLEAN;
-	newPage->availableDataLength = 0;
-	newPage->data = cachePageDataPool[pageCounter].data;
-	// Increment page counter
-	pageCounter++;
 
-	return newPage;
+/**
+*
+*  @brief Evicts pages selected by replacement policy while partition holds
+*  more pages than its limit
+*
+*  @param partition - locked cache partition
+*
+*/
+void CachedFileIO::trimPartition(CachePartition& partition) {
+	while (partition.allocated - partition.freePages.size() > partition.limit) {
+		CachePage* victim = partition.policy->selectVictim();
+		if (victim == nullptr || !clearCachePage(partition, victim)) break;
+		releaseCachePage(partition, victim);
+	}
 }
 
 
+
 /**
 *
-* @brief Returns free page: allocates new or return most aged cache page if page limit reached
-* @return new allocated or most aged CachePage pointer
+*  @brief Returns evicted page to the partition free pages, physical memory
+*  of page data is given back to OS (page is zeroed on reuse). Frame of
+*  shared buffer pool is returned to the pool.
+*
+*  @param partition - locked cache partition
+*  @param pageInfo - cleared cache page
 *
 */
-CachePage* CachedFileIO::getFreeCachePage() {
-	if (cacheList.size() < maxPagesCount) {
-		return allocatePage();
-	} else {
-		// get most aged page (back of the list)
-		CachePage* freePage = this->cacheList.back();
-		// clear page state
-		clearCachePage(freePage);
-		// remove page from list's back
-		this->cacheList.pop_back();
-		// return page reference
-		return freePage;
+void CachedFileIO::releaseCachePage(CachePartition& partition, CachePage* pageInfo) {
+	if (bufferPool != nullptr) {
+		partition.allocated--;
+		bufferPool->release(poolFile, pageInfo);
+		return;
 	}
+#if !defined(_WIN32) && defined(MADV_DONTNEED)
+	if (dataPoolMapped > 0) madvise(pageInfo->data, PAGE_SIZE, MADV_DONTNEED);
+#endif
+	partition.freePages.push_back(pageInfo);
 }
 
 
 
 /**
-* 
-* @brief Lookup cache page of requested file page if it exists or loads from storage
-* 
-* @param requestedFilePageNo - requested file page number
-* @return cache page reference of requested file page or returns nullptr
-* 
+*
+*  @brief Counts sampled page access in miss ratio curve, every
+*  ADAPTIVE_RESIZE_INTERVAL sampled accesses cache is resized if the curve
+*  suggests noticeably different size
+*
+*  @param filePageNo - accessed file page number
+*
 */
-CachePage* CachedFileIO::searchPageInCache(size_t filePageNo) {
-	// increment total cache lookup requests
-	cacheRequests++;
-	// Search file page in index map
-	auto result = cacheMap.find(filePageNo);
-	// if page found in cache
-	if (result != cacheMap.end()) {               // Move page to the front of list (LRU):
-		CachePage* cachePage = result->second;    // 1) Get page pointer
-		cacheList.erase(cachePage->it);           // 2) Erase page from list by iterator
-		cacheList.push_front(cachePage);          // 3) Push page in the front of the list
-		cachePage->it = cacheList.begin();        // 4) update page's list iterator 
-		return cachePage;                         // 5) return page (hashmap pointer is valid)
+void CachedFileIO::sampleAccess(size_t filePageNo) {
+	std::lock_guard<std::mutex> lock(sizingMutex);
+	if (!adaptiveSizing) return;
+	missRatioCurve.record(filePageNo);
+	if (++sampledAccesses < ADAPTIVE_RESIZE_INTERVAL) return;
+	sampledAccesses = 0;
+	size_t pagesCount = selectCacheSize();
+	missRatioCurve.age();
+	// Small size changes are ignored to avoid evictions back and forth
+	size_t currentPages = maxPagesCount;
+	size_t minChange = std::max<size_t>(currentPages / 16, 1);
+	if (pagesCount + minChange <= currentPages || pagesCount >= currentPages + minChange) {
+		resizeCache(pagesCount);
 	}
-	
-	// increment cache misses counter
-	cacheMisses++;
-
-	// try to load page to cache from storage
-	return loadPageToCache(filePageNo);
 }
 
 
 
 /**
-* 
-*  @brief Loads requested page from storage device to cache and returns cache page
-* 
-*  @param requestedFilePageNo - file page number to load
-*  @return loaded page cache index or nullptr if file is not open.
-* 
+*
+*  @brief Selects smallest cache size within budget whose estimated miss
+*  ratio exceeds miss ratio of maximal size by no more than tolerance
+*
+*  @return cache size (pages)
+*
 */
-CachePage* CachedFileIO::loadPageToCache(size_t filePageNo) {
-
-	//if (fileHandler == nullptr) return nullptr;
+size_t CachedFileIO::selectCacheSize() {
+	double minMissRatio = missRatioCurve.missRatio(maxBudgetPages);
+	size_t step = std::max<size_t>((maxBudgetPages - minBudgetPages) / MRC_BUCKETS, 1);
+	for (size_t pages = minBudgetPages; pages < maxBudgetPages; pages += step) {
+		if (missRatioCurve.missRatio(pages) <= minMissRatio + ADAPTIVE_MISS_TOLERANCE) return pages;
+	}
+	return maxBudgetPages;
+}
 
-	// get new allocated page or most aged one (remove it from the list)
-	CachePage* cachePage = getFreeCachePage();
 
-	// calculate offset and initialize variables
-	size_t offset = filePageNo * PAGE_SIZE;
-	size_t bytesToRead = PAGE_SIZE;	
-	size_t bytesRead = 0;
 
-	// Clear page
-	memset(cachePage->data, 0, PAGE_SIZE);
+/**
+*
+*  @brief Attaches file to shared buffer pool (or back to private cache pool
+*  if pool is nullptr). Pool must be set while file is closed, cache size
+*  passed to open() becomes file quota in the pool.
+*
+*  @param pool - shared buffer pool or nullptr
+*
+*  @return true if pool is set, false if file is open
+*
+*/
+bool CachedFileIO::setBufferPool(BufferPool* pool) {
+	if (backend != nullptr) return false;
+	this->bufferPool = pool;
+	return true;
+}
 
-	// Fetch page from storage device
-	_fseeki64(fileHandler, offset, SEEK_SET);
-	bytesRead = fread(cachePage->data, 1, bytesToRead, fileHandler);
-	
-	// fill loaded page description info
-	cachePage->filePageNo = filePageNo;
-	cachePage->state = PageState::CLEAN;
-	cachePage->availableDataLength = bytesRead;
 
-	// Insert cache page into the list and to the hashmap
-	cacheList.push_front(cachePage);
-	cachePage->it = cacheList.begin();
-	cacheMap[filePageNo] = cachePage;
 
-	return cachePage;
+/**
+*
+*  @brief Returns shared buffer pool of the file
+*
+*  @return shared buffer pool or nullptr if file uses private cache pool
+*
+*/
+BufferPool* CachedFileIO::getBufferPool() {
+	return bufferPool;
 }
 
 
 
 /**
-* 
-*  @brief Writes specified cache page to the storage device
-* 
-*  @param cachePageIndex - page index in the cache
-*  @return true - page successfuly persisted, false - write failed or file is not open
-* 
-*/ 
-bool CachedFileIO::persistCachePage(CachePage* cachedPage) {
+*
+*  @brief Evicts pages of the file for other file of shared buffer pool,
+*  partitions are visited round robin, free pages are returned first.
+*  Called by BufferPool under its eviction lock.
+*
+*  @param pagesCount - pages to return to the pool
+*
+*  @return pages returned to the pool
+*
+*/
+size_t CachedFileIO::evictPages(size_t pagesCount) {
+	size_t evicted = 0;
+	for (size_t scanned = 0; scanned < partitionsCount && evicted < pagesCount; scanned++) {
+		CachePartition& partition = partitions[evictCursor++ & partitionsMask];
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		while (!partition.freePages.empty() && evicted < pagesCount) {
+			CachePage* freePage = partition.freePages.back();
+			partition.freePages.pop_back();
+			releaseCachePage(partition, freePage);
+			evicted++;
+		}
+		if (evicted == pagesCount) break;
+		CachePage* victim = partition.policy->selectVictim();
+		if (victim == nullptr || !clearCachePage(partition, victim)) continue;
+		releaseCachePage(partition, victim);
+		evicted++;
+	}
+	return evicted;
+}
 
-	//if (fileHandler == nullptr) return false;
 
-	// Get file page number of cached page and calculate offset in the file
-	size_t offset = cachedPage->filePageNo * PAGE_SIZE;
-	size_t bytesToWrite = PAGE_SIZE;
-	size_t bytesWritten = 0;
-	
-	// Go to calculated offset in the file
-	_fseeki64(fileHandler, offset, SEEK_SET);
 
-	// Write cached page to file
-	bytesWritten = fwrite(cachedPage->data, 1, bytesToWrite, fileHandler);
-	// Check success
-	if (bytesWritten == bytesToWrite) {
-		cachedPage->state = PageState::CLEAN;
-		return true;
-	}
-	// if failed to write
-	return false;
+/**
+*
+*  @brief Doubles page table of the partition (file in shared buffer pool
+*  starts with small tables, pages count is limited by the pool size)
+*
+*  @param partition - locked cache partition
+*
+*/
+void CachedFileIO::growPageTable(CachePartition& partition) {
+	std::vector<PageTableSlot> slots(PageTable::slotsFor(partition.pageTable.capacity() * 2));
+	partition.pageTable.moveTo(slots.data(), slots.size());
+	partition.tableSlots.swap(slots);
 }
 
 
 
 /**
-* 
-*  @brief Clears cache page state, persists if changed and removes from hashmap
-* 
-*  @param cachePageIndex - index of the page in cache to clear
-*  @return true - if page cleared, false - if can't persist page to storage
-* 
+* @brief Allocates memory pool for cache pages and splits it between partitions
 */
-bool CachedFileIO::clearCachePage(CachePage* pageInfo) {
-	
-	// if cache page has been rewritten persist page to storage device
-	if (pageInfo->state == PageState::DIRTY) {
-		if (!persistCachePage(pageInfo)) return false;
+void CachedFileIO::allocatePool(size_t pagesToAllocate) {
+	// Partitions count is power of 2, every partition has enough pages
+	this->partitionsCount = 1;
+	while (partitionsCount < CACHE_PARTITIONS &&
+		pagesToAllocate / (partitionsCount * 2) >= MIN_PARTITION_PAGES) partitionsCount *= 2;
+	this->partitionsMask = partitionsCount - 1;
+	this->dirtyPages = 0;
+	this->flushCursor = 0;
+	this->partitions = new CachePartition[partitionsCount];
+	// File in shared buffer pool takes frames from the pool, page tables grow
+	// with pages count, clock ring policies need own pool slice (LRU used)
+	if (bufferPool != nullptr) {
+		ReplacementPolicyType type = policyType;
+		if (type == CLOCK_POLICY || type == CLOCK_PRO_POLICY) type = LRU_POLICY;
+		for (size_t i = 0; i < partitionsCount; i++) {
+			CachePartition& partition = partitions[i];
+			partition.capacity = pagesToAllocate / partitionsCount + (i < pagesToAllocate % partitionsCount ? 1 : 0);
+			partition.limit = partition.capacity;
+			partition.firstPage = nullptr;
+			partition.policy = ReplacementPolicy::create(type, nullptr, partition.capacity);
+			partition.allocated = 0;
+			partition.reserved = 0;
+			partition.accessClock = 0;
+			memset(partition.writeBacks, 0, sizeof(partition.writeBacks));
+			partition.tableSlots.resize(PageTable::slotsFor(MIN_PARTITION_PAGES));
+			partition.pageTable.init(partition.tableSlots.data(), partition.tableSlots.size());
+		}
+		this->poolFile = bufferPool->attach(this);
+		return;
+	}
+	// Allocate pages pool
+	this->cachePageInfoPool = new CachePage[pagesToAllocate]();
+	this->cachePageDataPool = allocateDataPool(pagesToAllocate, hugePages, dataPoolMapped);
+	// Allocate page tables slots for all partitions in one pool
+	size_t totalSlots = 0;
+	for (size_t i = 0; i < partitionsCount; i++) {
+		totalSlots += PageTable::slotsFor(pagesToAllocate / partitionsCount + 1);
 	}
+	this->pageTablePool = new PageTableSlot[totalSlots];
+	// Give every partition its own slice of the pool
+	size_t firstPage = 0, firstSlot = 0;
+	for (size_t i = 0; i < partitionsCount; i++) {
+		CachePartition& partition = partitions[i];
+		partition.capacity = pagesToAllocate / partitionsCount + (i < pagesToAllocate % partitionsCount ? 1 : 0);
+		partition.limit = partition.capacity;
+		partition.firstPage = &cachePageInfoPool[firstPage];
+		partition.policy = ReplacementPolicy::create(policyType, partition.firstPage, partition.capacity);
+		partition.allocated = 0;
+		partition.reserved = 0;
+		partition.accessClock = 0;
+		memset(partition.writeBacks, 0, sizeof(partition.writeBacks));
+		size_t slotsCount = PageTable::slotsFor(pagesToAllocate / partitionsCount + 1);
+		partition.pageTable.init(&pageTablePool[firstSlot], slotsCount);
+		firstSlot += slotsCount;
+		partition.freePages.reserve(partition.capacity);
+		firstPage += partition.capacity;
+	}
+}
 
-	// Remove from index hashmap
-	cacheMap.erase(pageInfo->filePageNo);
 
-	// Clear cache page info fields
-	pageInfo->filePageNo = NOT_FOUND;
-	pageInfo->availableDataLength = 0;
-				
-	// Cache page freed
-	return true;
+/**
+* @brief Releases memory pool
+*/
+void CachedFileIO::releasePool() {
+	// return frames to shared buffer pool before partitions are released
+	if (poolFile != nullptr) {
+		bufferPool->detach(poolFile);
+		poolFile = nullptr;
+	}
+	this->maxPagesCount = 0;
+	this->poolPagesCount = 0;
+	for (size_t i = 0; i < partitionsCount; i++) delete partitions[i].policy;
+	this->partitionsCount = 0;
+	this->partitionsMask = 0;
+	delete[] partitions;
+	delete[] cachePageInfoPool;
+	delete[] pageTablePool;
+	releaseDataPool(cachePageDataPool, dataPoolMapped);
+	dataPoolMapped = 0;
+	partitions = nullptr;
+	cachePageInfoPool = nullptr;
+	pageTablePool = nullptr;
+	cachePageDataPool = nullptr;
 }
 
 
 
+/**
+*
+* @brief Allocates block aligned pages data pool. If huge pages requested,
+* large pool is mapped with huge pages if they are reserved (MAP_HUGETLB),
+* otherwise transparent huge pages are advised for the mapping.
+*
+* @param pagesCount - pages count
+* @param hugePages - back large pool with huge pages
+* @param mappedSize - mapped pool size (0 if allocated on heap)
+* @return pages data pool (throws std::bad_alloc if failed to allocate)
+*
+*/
+CachePageData* CachedFileIO::allocateDataPool(size_t pagesCount, bool hugePages, size_t& mappedSize) {
+#ifndef _WIN32
+	size_t poolSize = pagesCount * sizeof(CachePageData);
+	void* pool = MAP_FAILED;
+	if (poolSize < HUGE_PAGE_SIZE) hugePages = false;
+#ifdef MAP_HUGETLB
+	if (hugePages) {
+		size_t hugePoolSize = (poolSize + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		pool = mmap(nullptr, hugePoolSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (pool != MAP_FAILED) poolSize = hugePoolSize;
+	}
+#endif
+	if (pool == MAP_FAILED) {
+		pool = mmap(nullptr, poolSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pool == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+		if (hugePages) madvise(pool, poolSize, MADV_HUGEPAGE);
+#endif
+	}
+	mappedSize = poolSize;
+	return (CachePageData*)pool;
+#else
+	mappedSize = 0;
+	return new CachePageData[pagesCount];
+#endif
+}
+
+
+/**
+* @brief Releases pages data pool
+* @param dataPool - pages data pool
+* @param mappedSize - mapped pool size (0 if allocated on heap)
+*/
+void CachedFileIO::releaseDataPool(CachePageData* dataPool, size_t mappedSize) {
+	if (dataPool == nullptr) return;
+#ifndef _WIN32
+	if (mappedSize > 0) munmap(dataPool, mappedSize);
+	else delete[] dataPool;
+#else
+	delete[] dataPool;
+#endif
+}
+
+
+/**
+*
+* @brief Returns partition of the file page (Fibonacci hash of page number,
+* so neighbour pages of sequential reads are spread over all partitions)
+*
+* @param filePageNo - file page number
+* @return cache partition reference
+*
+*/
+CachePartition& CachedFileIO::getPartition(size_t filePageNo) {
+	uint64_t hash = uint64_t(filePageNo) * 0x9E3779B97F4A7C15ull;
+	return partitions[(hash >> 32) & partitionsMask];
+}
+
+
+/**
+*
+* @brief Returns stats counters slot of calling thread. Threads get slots
+* round robin, so concurrent threads don't bounce same cache line.
+*
+* @return thread stats counters slot
+*
+*/
+CacheStatsSlot& CachedFileIO::getStatsSlot() {
+	static std::atomic<size_t> threadsCounter(0);
+	static thread_local size_t slotIndex = threadsCounter++ % STATS_SLOTS;
+	return statsSlots[slotIndex];
+}
+
+
+
+/**
+*
+* @brief Returns monotonic clock timestamp
+*
+* @return timestamp (ns)
+*
+*/
+uint64_t CachedFileIO::timestamp() {
+	return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+
+/**
+*
+* @brief Starts timing of read/write call according to instrumentation
+* policy: never (off), every LATENCY_SAMPLE_PERIOD call of the thread
+* (sampled) or every call (full)
+*
+* @return start timestamp (ns) or 0 if call is not timed
+*
+*/
+uint64_t CachedFileIO::startTiming() {
+#if BOSON_INSTRUMENTATION == BOSON_INSTRUMENTATION_FULL
+	return timestamp();
+#elif BOSON_INSTRUMENTATION == BOSON_INSTRUMENTATION_SAMPLED
+	static thread_local uint64_t callsCounter = 0;
+	if ((callsCounter++ & (LATENCY_SAMPLE_PERIOD - 1)) != 0) return 0;
+	return timestamp();
+#else
+	return 0;
+#endif
+}
+
+
+
+/**
+*
+* @brief Completes timing of read/write call: counts latency in histogram
+* and increments total duration (sampled duration is scaled by period)
+*
+* @param[in] stats     - stats counters slot of calling thread
+* @param[in] isWrite   - true if write call, false if read call
+* @param[in] startTime - start timestamp returned by startTiming()
+*
+*/
+void CachedFileIO::stopTiming(CacheStatsSlot& stats, bool isWrite, uint64_t startTime) {
+	if (startTime == 0) return;
+	uint64_t duration = timestamp() - startTime;
+#if BOSON_INSTRUMENTATION == BOSON_INSTRUMENTATION_SAMPLED
+	uint64_t totalDuration = duration * LATENCY_SAMPLE_PERIOD;
+#else
+	uint64_t totalDuration = duration;
+#endif
+	if (isWrite) {
+		stats.writeLatency.record(duration);
+		stats.writeDuration.fetch_add(totalDuration, std::memory_order_relaxed);
+	} else {
+		stats.readLatency.record(duration);
+		stats.readDuration.fetch_add(totalDuration, std::memory_order_relaxed);
+	}
+}
+
+
+
+/**
+*
+* @brief Merges latency histograms of all stats slots and calculates percentile
+*
+* @param[in] isWrite    - true for write latency, false for read latency
+* @param[in] percentile - requested percentile (0-100)
+*
+* @return latency percentile (ns) or 0 if no calls were timed
+*
+*/
+double CachedFileIO::getLatencyPercentile(bool isWrite, double percentile) {
+	std::vector<uint64_t> totals(HISTOGRAM_BUCKETS, 0);
+	for (CacheStatsSlot& slot : statsSlots) {
+		if (isWrite) slot.writeLatency.addTo(totals.data());
+		else slot.readLatency.addTo(totals.data());
+	}
+	return double(LatencyHistogram::percentile(totals.data(), percentile));
+}
+
+
+/**
+* @brief Allocates cache page from partition slice of memory pool or takes
+* free frame of shared buffer pool
+* @return new page or nullptr if slice is exhausted or shared pool has no free frames
+*/
+CachePage* CachedFileIO::allocatePage(CachePartition& partition) {
+
+	if (partition.allocated >= partition.capacity) return nullptr;
+
+	// Allocate memory for cache page
+	CachePage* newPage = nullptr;
+	if (bufferPool != nullptr) {
+		newPage = bufferPool->allocate(poolFile);
+		if (newPage == nullptr) return nullptr;
+	} else {
+		newPage = &partition.firstPage[partition.allocated];
+		size_t poolIndex = newPage - cachePageInfoPool;
+		newPage->data = cachePageDataPool[poolIndex].data;
+	}
+	// Clear cache page info fields
+	newPage->filePageNo = NOT_FOUND;
+	newPage->state = PageState::CLEAN;
+	newPage->availableDataLength = 0;
+	newPage->pinCount = 0;
+	newPage->policyState = 0;
+	newPage->prefetched = false;
+	// Increment page counter
+	partition.allocated++;
+
+	return newPage;
+}
+
+
+/**
+*
+* @brief Returns free page: allocates new or evicts not pinned page selected by
+* replacement policy if partition page limit reached. Page is detached from
+* policy and page table.
+*
+* @param partition - locked cache partition
+* @param lock - partition lock (released while waiting for pinned pages)
+* @return new allocated or most aged CachePage pointer, nullptr if no dirty
+* victim can be persisted or all pages stay pinned for PINNED_WAIT_YIELDS
+* waits (caller may hold these pins itself)
+*
+*/
+CachePage* CachedFileIO::getFreeCachePage(CachePartition& partition, std::unique_lock<std::mutex>& lock) {
+	size_t writeFailures = 0, pinnedWaits = 0;
+	for (;;) {
+		size_t usedPages = partition.allocated - partition.freePages.size();
+		if (usedPages < partition.limit) {
+			// reuse returned page or allocate new one while slice is not exhausted
+			CachePage* newPage = takeFreeCachePage(partition);
+			if (newPage != nullptr) return newPage;
+			if (bufferPool != nullptr && partition.allocated < partition.capacity) {
+				// shared pool is exhausted: evict page of least active file
+				lock.unlock();
+				bool reclaimed = bufferPool->reclaim(poolFile);
+				lock.lock();
+				if (reclaimed) continue;
+			}
+		}
+		// get victim page which is not used by other threads
+		CachePage* freePage = partition.policy->selectVictim();
+		if (freePage != nullptr) {
+			// victim is kept if it can't be persisted: try others until each
+			// resident page has failed once
+			if (!clearCachePage(partition, freePage)) {
+				if (++writeFailures >= partition.allocated) return nullptr;
+				continue;
+			}
+			// partition is above limit after shrink: give page back
+			if (usedPages > partition.limit) {
+				releaseCachePage(partition, freePage);
+				continue;
+			}
+			return freePage;
+		}
+		// all pages are pinned or being loaded: let other threads release them
+		if (++pinnedWaits > PINNED_WAIT_YIELDS) return nullptr;
+		lock.unlock();
+		std::this_thread::yield();
+		lock.lock();
+	}
+}
+
+
+
+/**
+*
+* @brief Lookup cache page of requested file page and pins it, if page is not
+* cached loads it from storage
+*
+* @param filePageNo - requested file page number
+* @return pinned cache page of requested file page (must be released) or
+* nullptr if no cache page can be freed (all partition pages are pinned)
+*
+*/
+CachePage* CachedFileIO::acquirePage(size_t filePageNo) {
+	// sample access for miss ratio curve (before partition lock)
+	if (adaptiveSizing && missRatioCurve.isSampled(filePageNo)) sampleAccess(filePageNo);
+	// count file activity for global eviction of shared buffer pool
+	if (poolFile != nullptr) poolFile->accesses.fetch_add(1, std::memory_order_relaxed);
+	CachePartition& partition = getPartition(filePageNo);
+	CacheStatsSlot& stats = getStatsSlot();
+	std::unique_lock<std::mutex> lock(partition.mutex);
+	// increment total cache lookup requests
+	stats.cacheRequests++;
+	// Search file page in partition
+	CachePage* cachePage = searchPageInCache(partition, filePageNo);
+	if (cachePage != nullptr) {
+		if (cachePage->prefetched) {
+			cachePage->prefetched = false;
+			stats.readaheadHits++;
+		}
+		cachePage->pinCount.fetch_add(1, std::memory_order_relaxed);
+		return cachePage;
+	}
+	// increment cache misses counter
+	stats.cacheMisses++;
+	// if miss continues sequential stream, load page with following pages
+	size_t windowPages = detectSequential(filePageNo);
+	if (windowPages > 0) {
+		lock.unlock();
+		cachePage = readAhead(filePageNo, windowPages);
+		if (cachePage != nullptr) return cachePage;
+		lock.lock();
+	}
+	// try to load page to cache from storage
+	return loadPageToCache(partition, filePageNo, lock);
+}
+
+
+
+/**
+*
+* @brief Unpins cache page acquired by acquirePage (page can be evicted)
+*
+* @param pageInfo - pinned cache page
+*
+*/
+void CachedFileIO::releasePage(CachePage* pageInfo) {
+	pageInfo->pinCount.fetch_sub(1, std::memory_order_release);
+}
+
+
+
+/**
+* 
+* @brief Lookup cache page of requested file page in the partition
+* 
+* @param partition - locked cache partition
+* @param requestedFilePageNo - requested file page number
+* @return cache page reference of requested file page or returns nullptr
+* 
+*/
+CachePage* CachedFileIO::searchPageInCache(CachePartition& partition, size_t filePageNo) {
+	// Search file page in page table
+	CachePage* cachePage = partition.pageTable.find(filePageNo);
+	// if page not found in cache
+	if (cachePage == nullptr) return nullptr;
+	// Notify replacement policy about page access (first access of page read
+	// ahead is the reference page was loaded for, so it's not counted twice)
+	if (!cachePage->prefetched) partition.policy->onAccess(cachePage);
+	cachePage->accessStamp = ++partition.accessClock;
+	return cachePage;
+}
+
+
+
+/**
+* 
+*  @brief Loads requested page from storage device to cache and returns cache page.
+*  Partition lock is released during storage read, page stays detached until
+*  loaded. If the page has been loaded by other thread meanwhile, that page is
+*  used. If the page may have been written back meanwhile, it is read again.
+* 
+*  @param partition - locked cache partition
+*  @param requestedFilePageNo - file page number to load
+*  @param lock - partition lock
+*  @return loaded and pinned cache page or nullptr if no page can be freed
+* 
+*/
+CachePage* CachedFileIO::loadPageToCache(CachePartition& partition, size_t filePageNo, std::unique_lock<std::mutex>& lock) {
+
+	//if (backend == nullptr) return nullptr;
+
+	// let adaptive policy learn about the miss before victim selection
+	partition.policy->onMiss(filePageNo);
+
+	for (;;) {
+
+		// get new allocated page or most aged one (remove it from the list)
+		CachePage* cachePage = getFreeCachePage(partition, lock);
+		if (cachePage == nullptr) return nullptr;
+		uint64_t stamp = writeBackStamp(partition, filePageNo);
+
+		// calculate offset and initialize variables
+		size_t offset = filePageNo * PAGE_SIZE;
+		size_t bytesToRead = PAGE_SIZE;	
+		size_t bytesRead = 0;
+
+		// Fetch page from storage device (single positional read) out of lock
+		lock.unlock();
+		memset(cachePage->data, 0, PAGE_SIZE);
+		bytesRead = backend->read(offset, cachePage->data, bytesToRead);
+		lock.lock();
+
+		// If other thread loaded the same page meanwhile, use its copy
+		CachePage* cachedPage = searchPageInCache(partition, filePageNo);
+		if (cachedPage != nullptr || writeBackStamp(partition, filePageNo) != stamp) {
+			partition.freePages.push_back(cachePage);
+			if (cachedPage == nullptr) continue;
+			cachedPage->pinCount.fetch_add(1, std::memory_order_relaxed);
+			return cachedPage;
+		}
+
+		// fill loaded page description info
+		cachePage->filePageNo = filePageNo;
+		cachePage->state = PageState::CLEAN;
+		cachePage->availableDataLength = bytesRead;
+		cachePage->prefetched = false;
+		cachePage->pinCount.fetch_add(1, std::memory_order_relaxed);
+
+		// Insert cache page into the list and to the page table
+		installCachePage(partition, cachePage);
+		return cachePage;
+	}
+}
+
+
+
+/**
+*
+*  @brief Inserts loaded page into partition replacement policy and page table
+*
+*  @param partition - locked cache partition
+*  @param pageInfo - loaded cache page
+*
+*/
+void CachedFileIO::installCachePage(CachePartition& partition, CachePage* pageInfo) {
+	if (bufferPool != nullptr && partition.pageTable.size() >= partition.pageTable.capacity()) growPageTable(partition);
+	partition.policy->onInsert(pageInfo);
+	pageInfo->accessStamp = ++partition.accessClock;
+	pageInfo->loadStamp = loadClock.fetch_add(1, std::memory_order_relaxed) + 1;
+	partition.pageTable.insert(pageInfo->filePageNo, pageInfo);
+}
+
+
+
+/**
+*
+*  @brief Returns write back stamp of file page. Stamp changes when dirty page
+*  (or other page with the same stamp slot) is written back on eviction, so
+*  page read from storage without lock is not installed over newer data.
+*
+*  @param partition - locked cache partition
+*  @param filePageNo - file page number
+*  @return write back stamp reference
+*
+*/
+uint64_t& CachedFileIO::writeBackStamp(CachePartition& partition, size_t filePageNo) {
+	return partition.writeBacks[filePageNo % WRITEBACK_STAMPS];
+}
+
+
+
+/**
+*
+*  @brief Detects if page miss continues sequential access stream. Miss of
+*  the page right after pages read ahead for the stream doubles its readahead
+*  window, other misses replace least recently used stream, so random access
+*  quickly backs off to single page loads.
+*
+*  @param[in] filePageNo - missed file page number
+*
+*  @return readahead window (pages after missed page) or 0 if not sequential
+*
+*/
+size_t CachedFileIO::detectSequential(size_t filePageNo) {
+
+	if (accessPattern == AccessPattern::RANDOM_ACCESS) return 0;
+
+	// window is limited by quarter of cache to keep working set
+	size_t maxWindow = std::min<size_t>(READAHEAD_MAX_PAGES, maxPagesCount / 4);
+	if (maxWindow < 2) return 0;
+
+	std::lock_guard<std::mutex> lock(streamsMutex);
+	ReadaheadStream* victim = &streams[0];
+	streamsClock++;
+
+	for (ReadaheadStream& stream : streams) {
+		if (stream.lastUsed != 0 && filePageNo == stream.nextPageNo) {
+			stream.lastUsed = streamsClock;
+			stream.lastPageNo = filePageNo;
+			stream.missesCount++;
+			// pages read ahead only after few sequential misses (unless hinted)
+			if (stream.missesCount < READAHEAD_TRIGGER &&
+				accessPattern != AccessPattern::SEQUENTIAL_ACCESS) {
+				stream.nextPageNo = filePageNo + 1;
+				return 0;
+			}
+			// stream continues: grow readahead window
+			if (stream.window == 0) {
+				stream.window = (accessPattern == AccessPattern::SEQUENTIAL_ACCESS) ?
+					READAHEAD_MAX_PAGES / 2 : READAHEAD_MIN_PAGES;
+			} else stream.window *= 2;
+			if (stream.window > maxWindow) stream.window = maxWindow;
+			stream.nextPageNo = filePageNo + stream.window + 1;
+			return stream.window;
+		}
+		if (stream.lastUsed < victim->lastUsed) victim = &stream;
+	}
+
+	// start new stream in place of least recently used one
+	victim->lastPageNo = filePageNo;
+	victim->nextPageNo = filePageNo + 1;
+	victim->window = 0;
+	victim->missesCount = 1;
+	victim->lastUsed = streamsClock;
+	return 0;
+}
+
+
+
+/**
+*
+*  @brief Loads missed page together with following uncached pages using
+*  single vector read. Following pages are marked as prefetched until
+*  first access. Must be called without partition locks held.
+*
+*  @param[in] filePageNo  - missed file page number
+*  @param[in] windowPages - amount of pages to read ahead after missed page
+*
+*  @return pinned cache page or nullptr if readahead is not possible
+*
+*/
+CachePage* CachedFileIO::readAhead(size_t filePageNo, size_t windowPages) {
+
+	// don't read ahead past the end of file
+	uint64_t fileSize = backend->getSize();
+	if (fileSize <= (filePageNo + 1) * PAGE_SIZE) return nullptr;
+	size_t lastPageNo = std::min<size_t>(filePageNo + windowPages, (fileSize - 1) >> PAGE_SHIFT);
+	{
+		CachePartition& partition = getPartition(filePageNo + 1);
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		if (partition.pageTable.find(filePageNo + 1) != nullptr) return nullptr;
+	}
+
+	// Reserve cache pages for contiguous range of uncached pages
+	std::vector<CachePage*> pages;
+	std::vector<uint64_t> stamps;
+	std::vector<IOBuffer> buffers;
+	for (size_t filePage = filePageNo; filePage <= lastPageNo; filePage++) {
+		CachePartition& partition = getPartition(filePage);
+		std::unique_lock<std::mutex> lock(partition.mutex);
+		if (partition.reserved >= partition.limit / 2) break;
+		if (filePage != filePageNo) {
+			if (partition.pageTable.find(filePage) != nullptr) break;
+		} else partition.policy->onMiss(filePage);
+		CachePage* cachePage = getFreeCachePage(partition, lock);
+		if (cachePage == nullptr) break;
+		partition.reserved++;
+		cachePage->filePageNo = filePage;
+		cachePage->state = PageState::CLEAN;
+		cachePage->availableDataLength = 0;
+		cachePage->prefetched = (filePage != filePageNo);
+		pages.push_back(cachePage);
+		stamps.push_back(writeBackStamp(partition, filePage));
+		buffers.push_back({ cachePage->data, PAGE_SIZE });
+	}
+
+	// Fetch all pages from storage device (single vector read) out of locks
+	if (pages.empty()) return nullptr;
+	size_t bytesRead = backend->readVector(filePageNo * PAGE_SIZE, buffers.data(), buffers.size());
+
+	// Insert loaded pages into the list and to the page table
+	CachePage* requestedPage = nullptr;
+	size_t prefetchedPages = 0;
+	for (size_t i = 0; i < pages.size(); i++) {
+		CachePage* cachePage = pages[i];
+		size_t pageBytes = std::min<size_t>(bytesRead, PAGE_SIZE);
+		bytesRead -= pageBytes;
+		CachePartition& partition = getPartition(cachePage->filePageNo);
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		partition.reserved--;
+		CachePage* cachedPage = searchPageInCache(partition, cachePage->filePageNo);
+		if (cachedPage != nullptr || writeBackStamp(partition, cachePage->filePageNo) != stamps[i]) {
+			// requested page loaded meanwhile by other thread: use its copy
+			if (i == 0 && cachedPage != nullptr) {
+				cachedPage->pinCount.fetch_add(1, std::memory_order_relaxed);
+				requestedPage = cachedPage;
+			}
+			cachePage->filePageNo = NOT_FOUND;
+			cachePage->prefetched = false;
+			partition.freePages.push_back(cachePage);
+			continue;
+		}
+		if (pageBytes < PAGE_SIZE) memset(cachePage->data + pageBytes, 0, PAGE_SIZE - pageBytes);
+		cachePage->availableDataLength = pageBytes;
+		if (i == 0) {
+			cachePage->pinCount.fetch_add(1, std::memory_order_relaxed);
+			requestedPage = cachePage;
+		} else prefetchedPages++;
+		installCachePage(partition, cachePage);
+	}
+
+	getStatsSlot().readaheadPages += prefetchedPages;
+	return requestedPage;
+}
+
+
+
+/**
+*
+*  @brief Takes page returned to the partition or allocates new page without
+*  evicting any resident page
+*
+*  @param partition - locked cache partition
+*
+*  @return free cache page or nullptr if partition is at its limit
+*
+*/
+CachePage* CachedFileIO::takeFreeCachePage(CachePartition& partition) {
+	size_t usedPages = partition.allocated - partition.freePages.size();
+	if (usedPages >= partition.limit) return nullptr;
+	if (!partition.freePages.empty()) {
+		CachePage* freePage = partition.freePages.back();
+		partition.freePages.pop_back();
+		return freePage;
+	}
+	if (partition.allocated < partition.capacity) return allocatePage(partition);
+	return nullptr;
+}
+
+
+
+/**
+*
+*  @brief Enables or disables cache warm-up: hot pages manifest is saved on
+*  close and loaded in background on open (set before open to warm up)
+*
+*  @param enabled - true to save and load hot pages manifest
+*
+*/
+void CachedFileIO::setCacheWarmup(bool enabled) {
+	this->cacheWarmup = enabled;
+}
+
+
+
+/**
+*
+*  @brief Sets file growth policy: storage backend preallocates file space in
+*  chunks of the larger of increment and percent of file size, file size
+*  stays exact and unused space is released on close (0, 0 disables it)
+*
+*  @param increment - minimal preallocation chunk (bytes)
+*  @param percent   - preallocation chunk share of file size (0..1)
+*
+*  @return true if file is closed or its backend preallocates file space
+*
+*/
+bool CachedFileIO::setFileGrowth(size_t increment, double percent) {
+	this->growthIncrement = increment;
+	this->growthPercent = percent;
+	if (backend == nullptr) return true;
+	return backend->setGrowthPolicy(increment, percent);
+}
+
+
+
+/**
+*
+*  @brief Checks if background warm-up still loads pages
+*
+*  @return true if warm-up thread is loading hot pages
+*
+*/
+bool CachedFileIO::isWarmingUp() {
+	return warmupRunning.load();
+}
+
+
+
+/**
+*
+*  @brief Saves numbers of resident pages to hot pages manifest, most
+*  recently accessed first. Recency is page age in accesses of its partition
+*  (partitions get even share of accesses by page hash). Manifest is written
+*  to temporary file and renamed, so crash never leaves torn manifest.
+*
+*  @return true if manifest saved, false otherwise
+*
+*/
+bool CachedFileIO::saveManifest() {
+	if (partitions == nullptr || manifestPath.empty()) return false;
+	// collect resident pages with their age
+	std::vector<std::pair<uint64_t, uint64_t>> hotPages;
+	std::vector<CachePage*> residentPages;
+	for (size_t i = 0; i < partitionsCount; i++) {
+		CachePartition& partition = partitions[i];
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		residentPages.clear();
+		partition.pageTable.getPages(residentPages);
+		for (CachePage* page : residentPages) {
+			hotPages.emplace_back(partition.accessClock - page->accessStamp, page->filePageNo);
+		}
+	}
+	std::sort(hotPages.begin(), hotPages.end());
+	std::vector<uint64_t> pageNumbers;
+	pageNumbers.reserve(hotPages.size());
+	for (auto& hotPage : hotPages) pageNumbers.push_back(hotPage.second);
+
+	// write manifest to temporary file and replace previous one
+	std::string tempPath = manifestPath + ".tmp";
+	FILE* manifest = fopen(tempPath.c_str(), "wb");
+	if (manifest == nullptr) return false;
+	WarmupManifestHeader header = { WARMUP_MAGIC, PAGE_SIZE, pageNumbers.size() };
+	bool saved = fwrite(&header, sizeof(header), 1, manifest) == 1 &&
+		fwrite(pageNumbers.data(), sizeof(uint64_t), pageNumbers.size(), manifest) == pageNumbers.size();
+	saved = (fclose(manifest) == 0) && saved;
+	if (saved) saved = std::rename(tempPath.c_str(), manifestPath.c_str()) == 0;
+	if (!saved) std::remove(tempPath.c_str());
+	return saved;
+}
+
+
+
+/**
+*
+*  @brief Reads hot pages manifest and starts warm-up thread loading the most
+*  recently used pages which fit the cache
+*
+*/
+void CachedFileIO::startWarmup() {
+	if (mappedData != nullptr || partitions == nullptr || manifestPath.empty()) return;
+	FILE* manifest = fopen(manifestPath.c_str(), "rb");
+	if (manifest == nullptr) return;
+	std::vector<uint64_t> pageNumbers;
+	WarmupManifestHeader header;
+	if (fread(&header, sizeof(header), 1, manifest) == 1 &&
+		header.magic == WARMUP_MAGIC && header.pageSize == PAGE_SIZE) {
+		pageNumbers.resize(std::min<uint64_t>(header.pagesCount, maxPagesCount));
+		pageNumbers.resize(fread(pageNumbers.data(), sizeof(uint64_t), pageNumbers.size(), manifest));
+	}
+	fclose(manifest);
+	if (pageNumbers.empty()) return;
+	// load pages in file order
+	std::sort(pageNumbers.begin(), pageNumbers.end());
+	pageNumbers.erase(std::unique(pageNumbers.begin(), pageNumbers.end()), pageNumbers.end());
+	warmupStop = false;
+	warmupRunning = true;
+	warmupThread = std::thread(&CachedFileIO::warmupLoop, this, std::move(pageNumbers));
+}
+
+
+
+/**
+*  @brief Stops warm-up thread and waits for its completion
+*/
+void CachedFileIO::stopWarmup() {
+	if (!warmupThread.joinable()) return;
+	warmupStop = true;
+	warmupThread.join();
+	warmupRunning = false;
+}
+
+
+
+/**
+*
+*  @brief Warm-up thread main loop: hot pages are split into runs with small
+*  gaps and every run is loaded with single vector read. Stops when cache has
+*  no free pages or on stop request.
+*
+*  @param pageNumbers - hot pages numbers in file order
+*
+*/
+void CachedFileIO::warmupLoop(std::vector<uint64_t> pageNumbers) {
+	uint64_t filePages = (backend->getSize() + PAGE_SIZE - 1) >> PAGE_SHIFT;
+	size_t first = 0;
+	while (first < pageNumbers.size() && pageNumbers[first] < filePages && !warmupStop) {
+		size_t last = first;
+		while (last + 1 < pageNumbers.size() &&
+			pageNumbers[last + 1] < filePages &&
+			pageNumbers[last + 1] - pageNumbers[last] <= WARMUP_GAP_PAGES + 1 &&
+			pageNumbers[last + 1] - pageNumbers[first] < WARMUP_MAX_READ_PAGES) last++;
+		if (warmUpPages(&pageNumbers[first], last - first + 1) == NOT_FOUND) break;
+		first = last + 1;
+	}
+	warmupRunning = false;
+}
+
+
+
+/**
+*
+*  @brief Loads run of hot pages with single vector read, pages between them
+*  are read to scratch page. Only free pages are used, pages already cached
+*  are skipped. Must be called without partition locks held.
+*
+*  @param pageNumbers - hot pages numbers (ascending, small gaps)
+*  @param count       - hot pages count
+*
+*  @return pages loaded to the cache or NOT_FOUND if cache has no free pages
+*
+*/
+size_t CachedFileIO::warmUpPages(const uint64_t* pageNumbers, size_t count) {
+
+	// Reserve free cache pages, gaps and cached pages go to scratch page
+	std::vector<CachePageData> scratchPage(1);
+	std::vector<CachePage*> pages;
+	std::vector<uint64_t> stamps;
+	std::vector<IOBuffer> buffers;
+	size_t firstPageNo = pageNumbers[0];
+	size_t reservedPages = 0;
+	bool cacheFull = false;
+	for (size_t i = 0; i < count; i++) {
+		while (firstPageNo + pages.size() < pageNumbers[i]) {
+			pages.push_back(nullptr);
+			stamps.push_back(0);
+			buffers.push_back({ scratchPage[0].data, PAGE_SIZE });
+		}
+		CachePartition& partition = getPartition(pageNumbers[i]);
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		CachePage* cachePage = nullptr;
+		if (partition.pageTable.find(pageNumbers[i]) == nullptr && partition.reserved < partition.limit / 2) {
+			cachePage = takeFreeCachePage(partition);
+			if (cachePage == nullptr) cacheFull = true;
+		}
+		if (cachePage != nullptr) {
+			partition.reserved++;
+			cachePage->filePageNo = pageNumbers[i];
+			cachePage->state = PageState::CLEAN;
+			cachePage->availableDataLength = 0;
+			cachePage->prefetched = false;
+			reservedPages++;
+		}
+		pages.push_back(cachePage);
+		stamps.push_back(cachePage == nullptr ? 0 : writeBackStamp(partition, pageNumbers[i]));
+		buffers.push_back({ cachePage == nullptr ? scratchPage[0].data : cachePage->data, PAGE_SIZE });
+	}
+	if (reservedPages == 0) return cacheFull ? NOT_FOUND : 0;
+
+	// Read from first to last reserved page (single vector read)
+	size_t firstIndex = 0, lastIndex = pages.size() - 1;
+	while (pages[firstIndex] == nullptr) firstIndex++;
+	while (pages[lastIndex] == nullptr) lastIndex--;
+	size_t bytesRead = backend->readVector((firstPageNo + firstIndex) * PAGE_SIZE,
+		&buffers[firstIndex], lastIndex - firstIndex + 1);
+
+	// Insert loaded pages unless loaded or written back meanwhile
+	size_t loadedPages = 0;
+	for (size_t i = firstIndex; i <= lastIndex; i++) {
+		size_t pageBytes = std::min<size_t>(bytesRead, PAGE_SIZE);
+		bytesRead -= pageBytes;
+		CachePage* cachePage = pages[i];
+		if (cachePage == nullptr) continue;
+		CachePartition& partition = getPartition(cachePage->filePageNo);
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		partition.reserved--;
+		if (pageBytes == 0 || partition.pageTable.find(cachePage->filePageNo) != nullptr ||
+			writeBackStamp(partition, cachePage->filePageNo) != stamps[i]) {
+			cachePage->filePageNo = NOT_FOUND;
+			partition.freePages.push_back(cachePage);
+			continue;
+		}
+		if (pageBytes < PAGE_SIZE) memset(cachePage->data + pageBytes, 0, PAGE_SIZE - pageBytes);
+		cachePage->availableDataLength = pageBytes;
+		installCachePage(partition, cachePage);
+		loadedPages++;
+	}
+
+	getStatsSlot().warmupPages += loadedPages;
+	return loadedPages;
+}
+
+
+
+/**
+*
+*  @brief Marks cache page as dirty and adds it to partition dirty pages index
+*
+*  @param partition - locked cache partition
+*  @param pageInfo - cached page
+*
+*/
+void CachedFileIO::markPageDirty(CachePartition& partition, CachePage* pageInfo) {
+	if (pageInfo->state == PageState::DIRTY) return;
+	pageInfo->state = PageState::DIRTY;
+	partition.dirtyMap.emplace(pageInfo->filePageNo, pageInfo);
+	// wake flusher up when dirty pages cross low watermark
+	if (++dirtyPages == lowDirtyPages + 1) flusherWakeup.notify_one();
+}
+
+
+
+/**
+*
+*  @brief Marks cache page as clean and removes it from dirty pages index
+*
+*  @param partition - locked cache partition
+*  @param pageInfo - cached page
+*
+*/
+void CachedFileIO::markPageClean(CachePartition& partition, CachePage* pageInfo) {
+	if (pageInfo->state != PageState::DIRTY) return;
+	pageInfo->state = PageState::CLEAN;
+	partition.dirtyMap.erase(pageInfo->filePageNo);
+	dirtyPages--;
+}
+
+
+
+/**
+* 
+*  @brief Writes specified cache page to the storage device
+* 
+*  @param cachePageIndex - page index in the cache
+*  @return true - page successfuly persisted, false - write failed or file is not open
+* 
+*/ 
+bool CachedFileIO::persistCachePage(CachePage* cachedPage) {
+
+	//if (backend == nullptr) return false;
+
+	// Get file page number of cached page and calculate offset in the file
+	size_t offset = cachedPage->filePageNo * PAGE_SIZE;
+	size_t bytesToWrite = PAGE_SIZE;
+	size_t bytesWritten = 0;
+
+	// Write cached page to file (single positional write)
+	bytesWritten = backend->write(offset, cachedPage->data, bytesToWrite);
+	CacheStatsSlot& stats = getStatsSlot();
+	stats.storageWrites++;
+	stats.storageWriteBytes += bytesWritten;
+	// Check success (caller marks page clean)
+	return bytesWritten == bytesToWrite;
+}
+
+
+
+/**
+*
+*  @brief Writes run of adjacent file pages to the storage device with
+*  vector writes limited by maximum write size
+*
+*  @param firstPageNo - file page number of the first page in the run
+*  @param buffers - pages data buffers in file order
+*  @param count - pages count
+*  @return amount of pages persisted from the run beginning
+*
+*/
+size_t CachedFileIO::persistPages(size_t firstPageNo, const IOBuffer* buffers, size_t count) {
+	CacheStatsSlot& stats = getStatsSlot();
+	size_t pagesPersisted = 0;
+	while (pagesPersisted < count) {
+		size_t pagesToWrite = std::min<size_t>(count - pagesPersisted, maxWritePages);
+		size_t offset = (firstPageNo + pagesPersisted) * PAGE_SIZE;
+		size_t bytesWritten = (pagesToWrite == 1) ?
+			backend->write(offset, buffers[pagesPersisted].data, PAGE_SIZE) :
+			backend->writeVector(offset, &buffers[pagesPersisted], pagesToWrite);
+		stats.storageWrites++;
+		stats.storageWriteBytes += bytesWritten;
+		pagesPersisted += bytesWritten / PAGE_SIZE;
+		if (bytesWritten < pagesToWrite * PAGE_SIZE) break;
+	}
+	return pagesPersisted;
+}
+
+
+
+/**
+* 
+*  @brief Clears cache page state, persists if changed and removes from page table
+* 
+*  @param partition - locked cache partition
+*  @param pageInfo - victim page detached from replacement policy
+*  @return true - if page cleared, false - if can't persist page to storage
+*  (page stays dirty in page table and is returned to replacement policy)
+* 
+*/
+bool CachedFileIO::clearCachePage(CachePartition& partition, CachePage* pageInfo) {
+	
+	// if cache page has been rewritten persist page to storage device
+	if (pageInfo->state == PageState::DIRTY) {
+		if (!persistCachePage(pageInfo)) {
+			partition.policy->onRestore(pageInfo);
+			return false;
+		}
+		getStatsSlot().dirtyEvictions++;
+		writeBackStamp(partition, pageInfo->filePageNo)++;
+		markPageClean(partition, pageInfo);
+		// victims are not clean: wake flusher up to write dirty pages back
+		if (lowDirtyPages.load() != NOT_FOUND && !dirtyVictimEvicted.exchange(true)) {
+			flusherWakeup.notify_one();
+		}
+	}
+
+	// Read ahead page evicted without access
+	if (pageInfo->prefetched) {
+		pageInfo->prefetched = false;
+		getStatsSlot().readaheadWasted++;
+	}
+
+	// Remove from page table
+	partition.pageTable.erase(pageInfo->filePageNo);
+
+	// Clear cache page info fields
+	pageInfo->filePageNo = NOT_FOUND;
+	pageInfo->availableDataLength = 0;
+				
+	// Cache page freed
+	return true;
+}
+
+
+
+/**
+*
+*  @brief Returns asynchronous page loader, creates it and loads completion
+*  thread on first use
+*
+*  @return page loader for opened storage backend
+*
+*/
+AsyncPageLoader* CachedFileIO::getPageLoader() {
+	std::lock_guard<std::mutex> lock(loadsMutex);
+	if (pageLoader == nullptr) pageLoader = AsyncPageLoader::create(backend);
+	if (!completionRunning) {
+		completionRunning = true;
+		completionThread = std::thread(&CachedFileIO::loadsCompletionLoop, this);
+	}
+	return pageLoader;
+}
+
+
+
+/**
+*
+*  @brief Reserves cache pages for all missing file pages of the range and
+*  submits their reads to page loader as single batch. Reserved pages are
+*  detached from the cache (not in list/page table) until load is completed.
+*
+*  @param[in] firstPageNo - first file page number of the range
+*  @param[in] lastPageNo  - last file page number of the range (inclusive)
+*
+*  @return submitted pages load or nullptr if all pages are cached
+*
+*/
+std::shared_ptr<PendingPageLoad> CachedFileIO::submitPageLoads(size_t firstPageNo, size_t lastPageNo) {
+
+	// Collect missing pages (don't reserve more than half of cache pages)
+	std::vector<size_t> missingPages;
+	size_t maxReserved = std::max<size_t>(maxPagesCount / 2, 1);
+	for (size_t filePage = firstPageNo; filePage <= lastPageNo; filePage++) {
+		CachePartition& partition = getPartition(filePage);
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		if (partition.pageTable.find(filePage) != nullptr) continue;
+		missingPages.push_back(filePage);
+		if (missingPages.size() >= maxReserved) break;
+	}
+
+	// Single missing page is loaded synchronously on lookup
+	if (missingPages.size() < 2) return nullptr;
+
+	// Reserve cache pages (up to half of partition) and build batch of read requests
+	std::shared_ptr<PendingPageLoad> load = std::make_shared<PendingPageLoad>();
+	load->installed = false;
+	load->completed = false;
+	for (size_t filePage : missingPages) {
+		CachePartition& partition = getPartition(filePage);
+		std::unique_lock<std::mutex> lock(partition.mutex);
+		if (partition.reserved >= partition.limit / 2) continue;
+		partition.policy->onMiss(filePage);
+		CachePage* cachePage = getFreeCachePage(partition, lock);
+		if (cachePage == nullptr) break;
+		partition.reserved++;
+		memset(cachePage->data, 0, PAGE_SIZE);
+		cachePage->filePageNo = filePage;
+		cachePage->state = PageState::CLEAN;
+		cachePage->availableDataLength = 0;
+		cachePage->prefetched = false;
+		load->pages.push_back(cachePage);
+		load->stamps.push_back(writeBackStamp(partition, filePage));
+		load->batch.add(filePage * PAGE_SIZE, cachePage->data, PAGE_SIZE);
+	}
+	if (load->pages.empty()) return nullptr;
+
+	// Submit all reads at once
+	getPageLoader()->submit(load->batch);
+	{
+		std::lock_guard<std::mutex> lock(loadsMutex);
+		pendingLoads.push_back(load);
+	}
+	loadsChanged.notify_all();
+	return load;
+}
+
+
+
+/**
+*
+*  @brief Waits for pages load completion and places loaded pages to cache.
+*  If page has been loaded (or written back) meanwhile, cached page is kept
+*  and reserved page is returned to the partition. If other thread places
+*  pages of the load, waits until it is done.
+*
+*  @param[in] load - submitted pages load
+*
+*  @return amount of pages placed to the cache
+*
+*/
+size_t CachedFileIO::completePageLoads(std::shared_ptr<PendingPageLoad> load) {
+
+	if (load == nullptr) return 0;
+
+	// Take completion of the load (only once)
+	{
+		std::unique_lock<std::mutex> lock(loadsMutex);
+		if (load->installed) {
+			loadsChanged.wait(lock, [&load]() { return load->completed; });
+			return 0;
+		}
+		load->installed = true;
+	}
+
+	// Wait for all batch reads completion
+	pageLoader->wait(load->batch);
+
+	// Insert loaded pages into the list and to the page table
+	size_t installedPages = 0;
+	for (size_t i = 0; i < load->pages.size(); i++) {
+		CachePage* cachePage = load->pages[i];
+		CachePartition& partition = getPartition(cachePage->filePageNo);
+		std::lock_guard<std::mutex> lock(partition.mutex);
+		partition.reserved--;
+		if (partition.pageTable.find(cachePage->filePageNo) != nullptr ||
+			writeBackStamp(partition, cachePage->filePageNo) != load->stamps[i]) {
+			cachePage->filePageNo = NOT_FOUND;
+			partition.freePages.push_back(cachePage);
+			continue;
+		}
+		cachePage->availableDataLength = load->batch.requests[i].bytesRead;
+		installCachePage(partition, cachePage);
+		installedPages++;
+	}
+
+	// Load is completed, wake up waiting threads
+	{
+		std::lock_guard<std::mutex> lock(loadsMutex);
+		load->completed = true;
+		pendingLoads.remove(load);
+	}
+	loadsChanged.notify_all();
+	return installedPages;
+}
+
+
+
+/**
+*
+*  @brief Completes all asynchronous loads in flight
+*
+*/
+void CachedFileIO::completeAllPageLoads() {
+	for (;;) {
+		std::shared_ptr<PendingPageLoad> load;
+		{
+			std::lock_guard<std::mutex> lock(loadsMutex);
+			if (pendingLoads.empty()) return;
+			load = pendingLoads.front();
+		}
+		completePageLoads(load);
+	}
+}
+
+
+
+/**
+*
+*  @brief Loads completion thread: places pages of submitted loads to the
+*  cache as soon as they are read, so reserved pages are not held until
+*  the asynchronous read result is requested
+*
+*/
+void CachedFileIO::loadsCompletionLoop() {
+	std::unique_lock<std::mutex> lock(loadsMutex);
+	while (completionRunning) {
+		std::shared_ptr<PendingPageLoad> load = nullptr;
+		for (std::shared_ptr<PendingPageLoad>& pending : pendingLoads) {
+			if (!pending->installed) {
+				load = pending;
+				break;
+			}
+		}
+		if (load == nullptr) {
+			loadsChanged.wait(lock);
+			continue;
+		}
+		lock.unlock();
+		completePageLoads(load);
+		lock.lock();
+	}
+}
+
+
+
+/**
+*
+*  @brief Stops loads completion thread (loads in flight stay pending)
+*
+*/
+void CachedFileIO::stopLoadsCompletion() {
+	{
+		std::lock_guard<std::mutex> lock(loadsMutex);
+		if (!completionRunning) return;
+		completionRunning = false;
+	}
+	loadsChanged.notify_all();
+	completionThread.join();
+}
+
+
+
+/**
+*
+*  @brief Background flusher thread: sleeps while dirty pages share is below
+*  low watermark and no dirty page has been evicted, otherwise writes dirty
+*  pages back in small batches and wakes up throttled writers after every
+*  batch
+*
+*/
+void CachedFileIO::flusherLoop() {
+	std::unique_lock<std::mutex> lock(flusherMutex);
+	while (flusherRunning) {
+		bool victimsDirty = dirtyVictimEvicted.exchange(false) && dirtyPages.load() > 0;
+		if (!victimsDirty && dirtyPages.load() <= lowDirtyPages.load()) {
+			flusherWakeup.wait_for(lock, std::chrono::milliseconds(FLUSHER_INTERVAL_MS));
+			continue;
+		}
+		lock.unlock();
+		size_t pagesWritten = writeBackDirtyPages(FLUSHER_BATCH_PAGES);
+		getStatsSlot().writeBackPages += pagesWritten;
+		lock.lock();
+		writersWakeup.notify_all();
+		// storage device failed to write: retry later
+		if (pagesWritten == 0) flusherWakeup.wait_for(lock, std::chrono::milliseconds(FLUSHER_INTERVAL_MS));
+	}
+}
+
+
+
+/**
+*
+*  @brief Writes dirty pages back to storage device in file order, starting
+*  from the page where previous write back stopped (wraps around to the file
+*  beginning)
+*
+*  @param[in]  maxPages   - maximum pages to write back
+*  @param[out] allWritten - set to false if some page failed to write
+*
+*  @return amount of pages written back
+*
+*/
+size_t CachedFileIO::writeBackDirtyPages(size_t maxPages, bool* allWritten) {
+
+	// Don't write pages back concurrently with flush()
+	std::lock_guard<std::mutex> writeBackLock(writeBackMutex);
+
+	// Lock all partitions in index order
+	std::vector<std::unique_lock<std::mutex>> locks;
+	locks.reserve(partitionsCount);
+	for (size_t i = 0; i < partitionsCount; i++) locks.emplace_back(partitions[i].mutex);
+
+	// Collect first dirty pages of file pages range from partitions indexes
+	std::vector<CachePage*> pages;
+	auto collectPages = [&](size_t fromPageNo, size_t toPageNo) {
+		std::vector<CachePage*> found;
+		for (size_t i = 0; i < partitionsCount; i++) {
+			DirtyPagesMap& dirtyMap = partitions[i].dirtyMap;
+			auto it = dirtyMap.lower_bound(fromPageNo);
+			for (size_t taken = 0; it != dirtyMap.end() && it->first < toPageNo && taken < maxPages; ++it, ++taken) {
+				found.push_back(it->second);
+			}
+		}
+		std::sort(found.begin(), found.end(), [](const CachePage* cp1, const CachePage* cp2)
+			{
+				return cp1->filePageNo < cp2->filePageNo;
+			});
+		found.resize(std::min<size_t>(found.size(), maxPages - pages.size()));
+		pages.insert(pages.end(), found.begin(), found.end());
+	};
+	collectPages(flushCursor, NOT_FOUND);
+	if (pages.size() < maxPages) collectPages(0, flushCursor);
+	if (pages.empty()) return 0;
+	flushCursor = pages.back()->filePageNo + 1;
+
+	size_t pagesWritten = writeBackSnapshots(pages, locks);
+	if (allWritten != nullptr && pagesWritten < pages.size()) *allWritten = false;
+	return pagesWritten;
+}
+
+
+
+/**
+*
+*  @brief Writes back specified file pages which are still dirty
+*
+*  @param[in] pageNumbers - file pages numbers in ascending order
+*  @param[in] count       - amount of page numbers (up to FLUSHER_BATCH_PAGES)
+*
+*  @return true if all pages still dirty have been written back
+*
+*/
+bool CachedFileIO::writeBackPages(const size_t* pageNumbers, size_t count) {
+
+	// Don't write pages back concurrently with background flusher
+	std::lock_guard<std::mutex> writeBackLock(writeBackMutex);
+
+	// Lock all partitions in index order
+	std::vector<std::unique_lock<std::mutex>> locks;
+	locks.reserve(partitionsCount);
+	for (size_t i = 0; i < partitionsCount; i++) locks.emplace_back(partitions[i].mutex);
+
+	// Skip pages written back or evicted since page numbers were collected
+	std::vector<CachePage*> pages;
+	for (size_t i = 0; i < count; i++) {
+		DirtyPagesMap& dirtyMap = getPartition(pageNumbers[i]).dirtyMap;
+		auto it = dirtyMap.find(pageNumbers[i]);
+		if (it != dirtyMap.end()) pages.push_back(it->second);
+	}
+	if (pages.empty()) return true;
+
+	return writeBackSnapshots(pages, locks) == pages.size();
+}
+
+
+
+/**
+*
+*  @brief Writes back dirty pages collected under partitions locks. Pages
+*  are copied, marked clean and pinned under the locks, so they can't be
+*  evicted (and reloaded from storage) until written, then locks are released
+*  and copies are written. Page rewritten meanwhile becomes dirty again and
+*  is written later. Caller holds write back mutex.
+*
+*  @param[in] pages - dirty pages in file order
+*  @param[in] locks - locks of all partitions (released by the call)
+*
+*  @return amount of pages written back
+*
+*/
+size_t CachedFileIO::writeBackSnapshots(const std::vector<CachePage*>& pages, std::vector<std::unique_lock<std::mutex>>& locks) {
+
+	// Take snapshots of pages, mark them clean and pin until written
+	if (writeBackBuffer.size() < pages.size()) writeBackBuffer.resize(pages.size());
+	for (size_t i = 0; i < pages.size(); i++) {
+		CachePage* cachePage = pages[i];
+		memcpy(writeBackBuffer[i].data, cachePage->data, PAGE_SIZE);
+		markPageClean(getPartition(cachePage->filePageNo), cachePage);
+		cachePage->pinCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	locks.clear();
+
+	// Write runs of adjacent pages (vector writes)
+	std::vector<IOBuffer> buffers;
+	size_t pagesWritten = 0;
+	size_t runStart = 0;
+	for (size_t i = 0; i < pages.size(); i++) {
+		buffers.push_back({ writeBackBuffer[i].data, PAGE_SIZE });
+		bool runEnds = (i + 1 == pages.size() || pages[i + 1]->filePageNo != pages[i]->filePageNo + 1);
+		if (!runEnds) continue;
+		size_t runWritten = persistPages(pages[runStart]->filePageNo, buffers.data(), buffers.size());
+		for (size_t j = runStart; j <= i; j++) {
+			CachePage* cachePage = pages[j];
+			if (j >= runStart + runWritten) {
+				// failed to write: page is dirty again
+				CachePartition& partition = getPartition(cachePage->filePageNo);
+				std::lock_guard<std::mutex> lock(partition.mutex);
+				markPageDirty(partition, cachePage);
+			}
+			releasePage(cachePage);
+		}
+		pagesWritten += runWritten;
+		buffers.clear();
+		runStart = i + 1;
+	}
+
+	return pagesWritten;
+}
+
+
+
+/**
+*
+*  @brief Blocks writer while dirty pages exceed high watermark (flusher
+*  writes them back), waiting is limited by flusher wake up interval
+*
+*/
+void CachedFileIO::throttleWriter() {
+	uint64_t startTime = timestamp();
+	{
+		std::unique_lock<std::mutex> lock(flusherMutex);
+		flusherWakeup.notify_one();
+		writersWakeup.wait_for(lock, std::chrono::milliseconds(FLUSHER_INTERVAL_MS), [this] {
+			return !flusherRunning || dirtyPages.load() <= highDirtyPages.load();
+		});
+	}
+	getStatsSlot().throttleDuration += timestamp() - startTime;
+}
+
+
+
+/**
+* @brief Constructor of empty page reference
+*/
+PageRef::PageRef() {
+	this->owner = nullptr;
+	this->page = nullptr;
+	this->bytes = nullptr;
+	this->bytesCount = 0;
+}
+
+
+
+/**
+* @brief Move constructor (pin is moved to the new reference)
+*/
+PageRef::PageRef(PageRef&& other) noexcept {
+	this->owner = other.owner;
+	this->page = other.page;
+	this->bytes = other.bytes;
+	this->bytesCount = other.bytesCount;
+	other.owner = nullptr;
+	other.page = nullptr;
+	other.bytes = nullptr;
+	other.bytesCount = 0;
+}
+
+
+
+/**
+* @brief Move assignment (releases own pin and takes pin of other reference)
+*/
+PageRef& PageRef::operator=(PageRef&& other) noexcept {
+	if (this == &other) return *this;
+	release();
+	this->owner = other.owner;
+	this->page = other.page;
+	this->bytes = other.bytes;
+	this->bytesCount = other.bytesCount;
+	other.owner = nullptr;
+	other.page = nullptr;
+	other.bytes = nullptr;
+	other.bytesCount = 0;
+	return *this;
+}
+
+
+
+/**
+* @brief Destructor unpins referenced page
+*/
+PageRef::~PageRef() {
+	release();
+}
+
+
+
+/**
+* @brief Unpins referenced page (page can be evicted), reference becomes empty
+*/
+void PageRef::release() {
+	if (this->page != nullptr) this->owner->releasePage(this->page);
+	this->owner = nullptr;
+	this->page = nullptr;
+	this->bytes = nullptr;
+	this->bytesCount = 0;
+}
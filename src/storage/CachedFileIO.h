@@ -11,11 +11,18 @@
 *  read/write operations ratio is 70% / 30%. Read/write operations are
 *  faster when aligned to storage device sector/block size and sequential.
 *
-*  CachedFileIO LRU/FBW (Linked list + Hashmap) caching strategy gives:
+*  CachedFileIO LRU/FBW (Linked list + Page table) caching strategy gives:
 *    - O(1) time complexity of page look up
 *    - O(1) time complexity of page insert
 *    - O(1) time complexity of page remove
-* 
+*
+*  Cache is split into lock striped partitions, each with its own page
+*  table and pluggable replacement policy (see ReplacementPolicy.h). Dirty
+*  pages are written back in file order by flush or background flusher,
+*  pages are moved to storage device by pluggable backend (see
+*  StorageBackend.h). Readahead, asynchronous loads, adaptive sizing,
+*  shared buffer pool and cache warm-up are described in README.md.
+*
 *  CachedFileIO vs STDIO performance tests (Release Mode):
 *    - 50%-97% cache read hits leads to 50%-600% performance growth
 *    - 35%-49% cache read hits leads to 12%-36% performance growth
@@ -30,24 +37,90 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdint>
-#include <unordered_map>
+#include <list>
+#include <map>
+#include <vector>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 #include <iostream>
+#include <string>
+
+#include "StorageBackend.h"
+#include "AsyncPageLoader.h"
+#include "ReplacementPolicy.h"
+#include "PageTable.h"
+#include "LatencyHistogram.h"
+#include "MissRatioCurve.h"
+#include "BufferPool.h"
+
+#define BOSON_INSTRUMENTATION_OFF     0         // Operations are not timed
+#define BOSON_INSTRUMENTATION_SAMPLED 1         // Every LATENCY_SAMPLE_PERIOD call timed
+#define BOSON_INSTRUMENTATION_FULL    2         // Every call timed
+
+#ifndef BOSON_INSTRUMENTATION
+#define BOSON_INSTRUMENTATION BOSON_INSTRUMENTATION_SAMPLED
+#endif
+
+#ifndef BOSON_PAGE_SIZE
+#define BOSON_PAGE_SIZE 8192                    // Cache page size (4K-64K, power of 2)
+#endif
 
 namespace Boson {
 
+	/**
+	*  @brief Returns binary logarithm of page size (page number shift)
+	*/
+	constexpr uint64_t pageSizeShift(uint64_t pageSize) {
+		uint64_t shift = 0;
+		while ((uint64_t(1) << shift) < pageSize) shift++;
+		return shift;
+	}
+
 	//-------------------------------------------------------------------------
-	constexpr uint64_t PAGE_SIZE      = 8192;         // 8192 bytes page size
+	constexpr uint64_t PAGE_SIZE        = BOSON_PAGE_SIZE;          // Page size (8192 by default)
+	constexpr uint64_t PAGE_SHIFT       = pageSizeShift(PAGE_SIZE); // Position to page No. shift
+	constexpr uint64_t PAGE_OFFSET_MASK = PAGE_SIZE - 1;            // Position to page offset mask
 	constexpr uint64_t MINIMAL_CACHE  = 256 * 1024;   // 256Kb minimal cache
 	constexpr uint64_t DEFAULT_CACHE  = 1*1024*1024;  // 1Mb default cache
 	constexpr uint64_t NOT_FOUND      = -1;           // "Not found" signature
+	constexpr uint64_t CACHE_PARTITIONS     = 16;     // Maximum cache partitions (power of 2)
+	constexpr uint64_t MIN_PARTITION_PAGES  = 16;     // Minimal pages per cache partition
+	constexpr uint64_t PINNED_WAIT_YIELDS   = 1024;   // Waits for pinned pages before lookup fails
+	constexpr uint64_t CLEAN_VICTIM_SCAN    = 8;      // Dirty victims skipped looking for clean one
+	constexpr uint64_t STATS_SLOTS          = 16;     // Thread striped stats counters slots
+	constexpr uint64_t WRITEBACK_STAMPS     = 32;     // Write back stamps per partition
+	constexpr uint64_t READAHEAD_STREAMS    = 8;      // Tracked sequential access streams
+	constexpr uint64_t READAHEAD_TRIGGER    = 3;      // Sequential misses to start readahead
+	constexpr uint64_t READAHEAD_MIN_PAGES  = 4;      // Initial readahead window (pages)
+	constexpr uint64_t READAHEAD_MAX_PAGES  = 32;     // Maximal readahead window (pages)
+	constexpr double   FLUSHER_LOW_WATERMARK  = 0.10; // Dirty pages share to start write back
+	constexpr double   FLUSHER_HIGH_WATERMARK = 0.40; // Dirty pages share to throttle writers
+	constexpr uint64_t FLUSHER_BATCH_PAGES  = 32;     // Pages written back per flusher pass
+	constexpr uint64_t FLUSHER_INTERVAL_MS  = 100;    // Flusher idle wake up interval (ms)
+	constexpr uint64_t MAX_WRITE_IO_SIZE    = 256 * 1024; // Coalesced write size limit (default)
+	constexpr uint64_t HUGE_PAGE_SIZE       = 2 * 1024 * 1024; // Huge page size of data pool
+	constexpr uint64_t LATENCY_SAMPLE_PERIOD = 16;    // Calls per timed call (sampled mode)
+	constexpr uint64_t ADAPTIVE_RESIZE_INTERVAL = 1024; // Sampled accesses between resizes
+	constexpr double   ADAPTIVE_MISS_TOLERANCE  = 0.01; // Acceptable miss ratio above minimum
+	constexpr uint64_t WARMUP_MAX_READ_PAGES = 64;    // Warm-up vector read limit (pages)
+	constexpr uint64_t WARMUP_GAP_PAGES     = 4;      // Gap read through by warm-up (pages)
+	constexpr uint64_t WARMUP_MAGIC = 0x31544F48534F42ull; // Manifest signature "BOSHOT1"
+	constexpr char     WARMUP_MANIFEST_SUFFIX[] = ".hot"; // Manifest file name suffix
 	//-------------------------------------------------------------------------
 
+	static_assert(PAGE_SIZE >= 4096 && PAGE_SIZE <= 65536 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+		"BOSON_PAGE_SIZE must be power of 2 from 4096 to 65536 bytes");
+
 	typedef enum {                              // Cache Page State
 		CLEAN = 0,                              // Page has not been changed
 		DIRTY = 1                               // Cache page is rewritten
 	} PageState;
 
-	typedef struct {
+	typedef struct alignas(DIRECT_IO_ALIGNMENT) CachePageData {  // Aligned for direct I/O
 		uint8_t data[PAGE_SIZE];
 	} CachePageData;
 
@@ -57,18 +130,80 @@ namespace Boson {
 		PageState state;                        // Current page state
 		uint64_t  availableDataLength;          // Available amount of data
 		uint8_t*  data;                         // Pointer to data (payload)
-		std::list<CachePage*>::iterator it;     // Cache list node iterator
+		std::list<CachePage*>::iterator it;     // Cache list node iterator (LRU)
+		uint32_t  policyState;                  // Replacement policy state flags
+		bool      prefetched;                   // Read ahead, not accessed yet
+		uint32_t  fileId;                       // Holding file id (shared buffer pool)
+		uint64_t  accessStamp;                  // Partition access clock at last access
+		uint64_t  loadStamp;                    // File load clock when page was cached
+		std::atomic<uint32_t> pinCount;         // Threads using page outside of lock
 	};
 
 	//-------------------------------------------------------------------------
 
-	typedef                                     // Double linked list
-		std::list<CachePage*>                   // of cached pages pointers
-		CacheLinkedList;
+	typedef                                     // Ordered map of dirty pages
+		std::map<size_t, CachePage*>            // File page No. -> CachePage*
+		DirtyPagesMap;                          // (in file order)
+
+	class alignas(64) CachePartition {          // Lock striped cache partition
+	public:
+		std::mutex      mutex;                  // Partition lock
+		PageTable       pageTable;              // Cached pages table
+		std::vector<PageTableSlot> tableSlots;  // Growing table slots (shared buffer pool)
+		DirtyPagesMap   dirtyMap;               // Dirty pages in file order
+		ReplacementPolicy* policy;              // Partition replacement policy
+		std::vector<CachePage*> freePages;      // Pages returned to the partition
+		CachePage*      firstPage;              // First page of partition pool slice
+		uint64_t        capacity;               // Partition pool slice size (pages)
+		uint64_t        limit;                  // Resident pages limit (capacity)
+		uint64_t        allocated;              // Allocated pages of the slice
+		uint64_t        reserved;               // Pages reserved by asynchronous loads
+		uint64_t        accessClock;            // Accesses counter (pages recency)
+		uint64_t        writeBacks[WRITEBACK_STAMPS]; // Dirty pages write back stamps
+	};
+
+	class alignas(64) CacheStatsSlot {          // Thread striped stats counters
+	public:
+		std::atomic<uint64_t> bytesRead;        // Bytes read
+		std::atomic<uint64_t> bytesWritten;     // Bytes written
+		std::atomic<uint64_t> readDuration;     // Time of read operations (ns)
+		std::atomic<uint64_t> writeDuration;    // Time of write operations (ns)
+		std::atomic<uint64_t> cacheRequests;    // Cache requests counter
+		std::atomic<uint64_t> cacheMisses;      // Cache misses counter
+		std::atomic<uint64_t> readaheadPages;   // Pages loaded by readahead
+		std::atomic<uint64_t> readaheadHits;    // Read ahead pages accessed
+		std::atomic<uint64_t> readaheadWasted;  // Read ahead pages evicted unused
+		std::atomic<uint64_t> writeBackPages;   // Pages written back by flusher
+		std::atomic<uint64_t> dirtyEvictions;   // Dirty pages written on eviction
+		std::atomic<uint64_t> throttleDuration; // Time writers waited for flusher (ns)
+		std::atomic<uint64_t> storageWrites;    // Write calls to storage backend
+		std::atomic<uint64_t> storageWriteBytes;// Bytes written to storage backend
+		std::atomic<uint64_t> warmupPages;      // Pages loaded by cache warm-up
+		LatencyHistogram      readLatency;      // Read operations latency (ns)
+		LatencyHistogram      writeLatency;     // Write operations latency (ns)
+	};
 
-	typedef                                     // Hashmap of cached pages
-		std::unordered_map<size_t, CachePage*>  // File page No. -> CachePage*           
-		CachedPagesMap;                         
+	typedef struct {                            // Sequential access stream
+		uint64_t lastPageNo;                    // Last missed page of the stream
+		uint64_t nextPageNo;                    // Page expected to miss next
+		uint64_t window;                        // Current readahead window (pages)
+		uint64_t missesCount;                   // Sequential misses of the stream
+		uint64_t lastUsed;                      // Stream use stamp (0 - unused)
+	} ReadaheadStream;
+
+	typedef struct {                            // Asynchronous pages load
+		PageReadBatch           batch;          // Submitted read requests
+		std::vector<CachePage*> pages;          // Reserved cache pages (per request)
+		std::vector<uint64_t>   stamps;         // Write back stamps at reservation
+		bool                    installed;      // Pages are being placed to the cache
+		bool                    completed;      // Pages placed to the cache
+	} PendingPageLoad;
+
+	typedef struct {                            // Hot pages manifest header
+		uint64_t magic;                         // Manifest signature (WARMUP_MAGIC)
+		uint64_t pageSize;                      // Page size of the build
+		uint64_t pagesCount;                    // Page numbers following the header
+	} WarmupManifestHeader;
 
 	//-------------------------------------------------------------------------
 
@@ -83,12 +218,58 @@ namespace Boson {
 		CACHE_HITS_RATE,                        // Cache hits rate (0-100%)
 		CACHE_MISSES_RATE,                      // Cache misses rate (0-100%)
 		WRITE_THROUGHPUT,                       // Write throughput Mb/sec
-		READ_THROUGHPUT                         // Read throughput Mb/sec
+		READ_THROUGHPUT,                        // Read throughput Mb/sec
+		TOTAL_ADMISSIONS_REJECTED,              // Pages not admitted by policy (W-TinyLFU)
+		READAHEAD_PAGES,                        // Pages loaded by readahead
+		READAHEAD_HITS,                         // Read ahead pages accessed
+		READAHEAD_WASTED,                       // Read ahead pages evicted unused
+		DIRTY_PAGES,                            // Dirty pages currently in cache
+		BACKGROUND_WRITEBACKS,                  // Pages written back by flusher
+		DIRTY_EVICTIONS,                        // Dirty pages written on eviction
+		TOTAL_THROTTLE_TIME_NS,                 // Time writers waited for flusher (ns)
+		TOTAL_STORAGE_WRITES,                   // Write calls to storage backend
+		AVERAGE_WRITE_IO_SIZE,                  // Average storage write size (bytes)
+		READ_LATENCY_P50_NS,                    // Read latency median (ns)
+		READ_LATENCY_P99_NS,                    // Read latency 99th percentile (ns)
+		READ_LATENCY_P999_NS,                   // Read latency 99.9th percentile (ns)
+		WRITE_LATENCY_P50_NS,                   // Write latency median (ns)
+		WRITE_LATENCY_P99_NS,                   // Write latency 99th percentile (ns)
+		WRITE_LATENCY_P999_NS,                  // Write latency 99.9th percentile (ns)
+		WARMUP_PAGES                            // Pages loaded by cache warm-up
 	} CachedFileStats;
 
 
+	class CachedFileIO;
+
 	//-------------------------------------------------------------------------
-	// Binary random access LRU cached file IO
+	// Pinned cache page reference (zero copy read access, see CachedFileIO::pin)
+	//-------------------------------------------------------------------------
+	class PageRef {
+	public:
+		PageRef();
+		PageRef(PageRef&& other) noexcept;
+		PageRef& operator=(PageRef&& other) noexcept;
+		PageRef(const PageRef&) = delete;
+		void operator=(const PageRef&) = delete;
+		~PageRef();
+
+		const uint8_t* data() { return bytes; }    // Data at pinned position
+		size_t length() { return bytesCount; }     // Data available up to page end
+		bool   isPinned() { return bytes != nullptr; }
+		uint64_t loadStamp() { return page != nullptr ? page->loadStamp : 0; } // 0 - not cached
+		void   release();
+
+	private:
+		friend class CachedFileIO;
+		CachedFileIO*  owner;                   // Cached file of the page
+		CachePage*     page;                    // Pinned cache page (nullptr if not cached)
+		const uint8_t* bytes;                   // Data pointer inside the page
+		size_t         bytesCount;              // Data length from pointer to page end
+	};
+
+
+	//-------------------------------------------------------------------------
+	// Binary random access cached file IO (lock striped partitions)
 	//-------------------------------------------------------------------------
 	class CachedFileIO {
 	public:
@@ -97,50 +278,173 @@ namespace Boson {
 		void operator=(const CachedFileIO&) = delete;
 		~CachedFileIO();
 		
-		bool open(const char* path, size_t cache = DEFAULT_CACHE, bool readOnly = false);
+		bool open(const char* path, size_t cache = DEFAULT_CACHE, bool readOnly = false,
+			StorageBackendType backendType = DEFAULT_BACKEND);
 		bool close();
+		bool snapshot(const char* path);
 		bool isOpen();
 		bool isReadOnly();
+		bool isMapped();
+		bool setAccessPattern(AccessPattern pattern);
+		bool setReplacementPolicy(ReplacementPolicyType type);
+		ReplacementPolicyType getReplacementPolicy();
+		bool startFlusher(double lowWatermark = FLUSHER_LOW_WATERMARK,
+			double highWatermark = FLUSHER_HIGH_WATERMARK);
+		bool stopFlusher();
+		bool isFlusherRunning();
+		size_t setMaxWriteSize(size_t maxWriteSize);
+		size_t getMaxWriteSize();
 
 		size_t read(size_t position, void* dataBuffer, size_t length);
 		size_t write(size_t position, const void* dataBuffer, size_t length);
 		size_t readPage(size_t pageNo, void* userPageBuffer);
 		size_t writePage(size_t pageNo, const void* userPageBuffer);
+		PageRef pin(size_t position);
 		size_t flush();
+		size_t flush(size_t maxPages);
+		size_t flush(size_t maxPages, bool& succeeded);
+		std::future<size_t> flushAsync(size_t maxPages = NOT_FOUND);
+		size_t prefetch(size_t position, size_t length);
+		std::future<size_t> readAsync(size_t position, void* dataBuffer, size_t length);
 
 		void   resetStats();
 		double getStats(CachedFileStats type);
 		size_t getFileSize();
 		size_t getCacheSize();
 		size_t setCacheSize(size_t cacheSize);
+		bool   setCacheBudget(size_t minCacheSize, size_t maxCacheSize);
+		bool   isAdaptiveCache();
+		bool   setBufferPool(BufferPool* pool);
+		BufferPool* getBufferPool();
+		void   setCacheWarmup(bool enabled);
+		bool   setFileGrowth(size_t increment, double percent);
+		bool   isWarmingUp();
 
 	private:
+		friend class PageRef;
+		friend class BufferPool;
 
+		size_t     readMapped(size_t position, void* dataBuffer, size_t length);
+		size_t     readInMemory(size_t position, void* dataBuffer, size_t length);
+		size_t     writeInMemory(size_t position, const void* dataBuffer, size_t length);
 		void       allocatePool(size_t pagesCount);
 		void       releasePool();
-		CachePage* allocatePage();
-		CachePage* getFreeCachePage();                            
-		CachePage* searchPageInCache(size_t filePageNo);
-		CachePage* loadPageToCache(size_t filePageNo);
+		static CachePageData* allocateDataPool(size_t pagesCount, bool hugePages, size_t& mappedSize);
+		static void releaseDataPool(CachePageData* dataPool, size_t mappedSize);
+		size_t     rebuildCache(size_t cacheSize);
+		size_t     resizeCache(size_t pagesCount);
+		void       trimPartition(CachePartition& partition);
+		void       releaseCachePage(CachePartition& partition, CachePage* pageInfo);
+		void       sampleAccess(size_t filePageNo);
+		size_t     selectCacheSize();
+		size_t     evictPages(size_t pagesCount);
+		void       growPageTable(CachePartition& partition);
+		CachePartition& getPartition(size_t filePageNo);
+		CacheStatsSlot& getStatsSlot();
+		static uint64_t timestamp();
+		uint64_t   startTiming();
+		void       stopTiming(CacheStatsSlot& stats, bool isWrite, uint64_t startTime);
+		double     getLatencyPercentile(bool isWrite, double percentile);
+		CachePage* acquirePage(size_t filePageNo);
+		void       releasePage(CachePage* pageInfo);
+		CachePage* allocatePage(CachePartition& partition);
+		CachePage* getFreeCachePage(CachePartition& partition, std::unique_lock<std::mutex>& lock);
+		CachePage* searchPageInCache(CachePartition& partition, size_t filePageNo);
+		CachePage* loadPageToCache(CachePartition& partition, size_t filePageNo, std::unique_lock<std::mutex>& lock);
+		void       installCachePage(CachePartition& partition, CachePage* pageInfo);
+		uint64_t&  writeBackStamp(CachePartition& partition, size_t filePageNo);
+		size_t     detectSequential(size_t filePageNo);
+		CachePage* readAhead(size_t filePageNo, size_t windowPages);
+		void       markPageDirty(CachePartition& partition, CachePage* pageInfo);
+		void       markPageClean(CachePartition& partition, CachePage* pageInfo);
 		bool       persistCachePage(CachePage* pageInfo);
-		bool       clearCachePage(CachePage* pageInfo);		
-				
-		uint64_t        maxPagesCount;           // Maximum cache capacity (pages)
-		uint64_t        pageCounter;             // Allocated pages counter
+		size_t     persistPages(size_t firstPageNo, const IOBuffer* buffers, size_t count);
+		bool       clearCachePage(CachePartition& partition, CachePage* pageInfo);
+		AsyncPageLoader* getPageLoader();
+		std::shared_ptr<PendingPageLoad> submitPageLoads(size_t firstPageNo, size_t lastPageNo);
+		size_t     completePageLoads(std::shared_ptr<PendingPageLoad> load);
+		void       completeAllPageLoads();
+		void       stopLoadsCompletion();
+		void       loadsCompletionLoop();
+		void       flusherLoop();
+		size_t     writeBackDirtyPages(size_t maxPages, bool* allWritten = nullptr);
+		bool       writeBackPages(const size_t* pageNumbers, size_t count);
+		size_t     writeBackSnapshots(const std::vector<CachePage*>& pages, std::vector<std::unique_lock<std::mutex>>& locks);
+		void       throttleWriter();
+		bool       saveManifest();
+		void       startWarmup();
+		void       stopWarmup();
+		void       warmupLoop(std::vector<uint64_t> pageNumbers);
+		size_t     warmUpPages(const uint64_t* pageNumbers, size_t count);
+		CachePage* takeFreeCachePage(CachePartition& partition);
 				
-		uint64_t        totalBytesRead;          // Total bytes read
-		uint64_t        totalBytesWritten;       // Total bytes written
-		uint64_t        totalReadDuration;       // Time of read operations (ns)
-		uint64_t        totalWriteDuration;      // Time of write operations (ns)
-		uint64_t        cacheRequests;           // Cache requests counter
-		uint64_t        cacheMisses;             // Cache misses counter
-
-		std::FILE*      fileHandler;             // OS file handler
+		std::atomic<uint64_t> maxPagesCount;     // Cache capacity (pages)
+		uint64_t        poolPagesCount;          // Allocated pool size (pages)
+		uint64_t        partitionsCount;         // Cache partitions count (power of 2)
+		uint64_t        partitionsMask;          // Partition index mask
+		CacheStatsSlot  statsSlots[STATS_SLOTS]; // Thread striped stats counters
+
+		StorageBackend* backend;                 // Storage positional I/O backend
+		const uint8_t*  mappedData;              // Mapped file data (read only mapped mode)
+		uint64_t        mappedSize;              // Mapped file size
+		bool            inMemory;                // Data is accessed in place (memory backend)
 		bool            readOnly;                // Read only flag
-		CachedPagesMap  cacheMap;                // Cached pages map 
-		CacheLinkedList cacheList;               // Cached pages double linked list
+		CachePartition* partitions;              // Cache partitions (lock striping)
+		ReplacementPolicyType policyType;        // Partitions replacement policy
 		CachePage*      cachePageInfoPool;       // Cache pages info memory pool
 		CachePageData*  cachePageDataPool;       // Cache pages data memory pool
+		PageTableSlot*  pageTablePool;           // Partitions page tables slots pool
+		size_t          dataPoolMapped;          // Mapped data pool size (0 - heap)
+		bool            hugePages;               // Data pool on huge pages (direct I/O)
+		BufferPool*     bufferPool;              // Shared buffer pool (nullptr - private)
+		BufferPoolFile* poolFile;                // Entry of the file attached to the pool
+		uint64_t        evictCursor;             // Next partition to evict for the pool
+
+		AsyncPageLoader* pageLoader;             // Asynchronous page loader (lazy)
+		std::mutex       loadsMutex;             // Guards page loader and loads list
+		std::list<std::shared_ptr<PendingPageLoad>> pendingLoads; // Loads in flight
+		std::condition_variable loadsChanged;    // Signals submitted and completed loads
+		std::thread      completionThread;       // Places loaded pages to the cache
+		bool             completionRunning;      // Completion thread is running
+
+		AccessPattern    accessPattern;          // Expected access pattern hint
+		std::mutex       streamsMutex;           // Guards readahead streams
+		ReadaheadStream  streams[READAHEAD_STREAMS]; // Sequential access streams
+		uint64_t         streamsClock;           // Streams use counter
+
+		std::atomic<uint64_t> dirtyPages;        // Dirty pages in cache
+		std::mutex       writeBackMutex;         // Serializes flusher and flush()
+		std::vector<CachePageData> writeBackBuffer; // Snapshots of pages written back
+		std::thread      flusherThread;          // Background write back thread
+		std::mutex       flusherMutex;           // Guards flusher state
+		std::condition_variable flusherWakeup;   // Wakes flusher up
+		std::condition_variable writersWakeup;   // Wakes throttled writers up
+		bool             flusherRunning;         // Flusher thread is running
+		std::atomic<bool> dirtyVictimEvicted;    // Dirty page written on eviction
+		double           lowWatermark;           // Dirty share to start write back
+		double           highWatermark;          // Dirty share to throttle writers
+		std::atomic<uint64_t> lowDirtyPages;     // Dirty pages to start write back
+		std::atomic<uint64_t> highDirtyPages;    // Dirty pages to throttle writers
+		uint64_t         flushCursor;            // Next file page of incremental flush
+		uint64_t         maxWritePages;          // Coalesced write size limit (pages)
+
+		bool             adaptiveSizing;         // Cache is resized by miss ratio curve
+		uint64_t         minBudgetPages;         // Adaptive cache minimal size (pages)
+		uint64_t         maxBudgetPages;         // Adaptive cache maximal size (pages)
+		std::mutex       sizingMutex;            // Guards miss ratio curve and resizes
+		MissRatioCurve   missRatioCurve;         // Sampled LRU miss ratio curve
+		uint64_t         sampledAccesses;        // Sampled accesses since last resize
+
+		uint64_t         growthIncrement;        // File preallocation chunk (bytes)
+		double           growthPercent;          // File preallocation share of size
+
+		bool             cacheWarmup;            // Save and load hot pages manifest
+		std::string      manifestPath;           // Hot pages manifest of open file
+		std::thread      warmupThread;           // Background warm-up thread
+		std::atomic<bool> warmupRunning;         // Warm-up thread loads pages
+		std::atomic<bool> warmupStop;            // Warm-up thread stop request
+
+		std::atomic<uint64_t> loadClock;         // Pages placed to cache counter
 	};
 
 
@@ -0,0 +1,258 @@
+/******************************************************************************
+*
+*  Checksum class implementation
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "Checksum.h"
+
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BOSON_CHECKSUM_X86
+#include <immintrin.h>
+#endif
+
+using namespace Boson;
+
+constexpr uint32_t ADLER_MODULUS = 65521;   // Largest prime below 2^16
+constexpr uint64_t ADLER_NMAX    = 5552;    // Bytes summed before 32-bit overflow
+constexpr uint32_t CRC32C_POLY   = 0x82F63B78; // Reflected Castagnoli polynomial
+
+
+/**
+*  @brief Adler-32 portable implementation (modulo once per ADLER_NMAX bytes)
+*/
+static uint32_t adler32Portable(const uint8_t* data, uint64_t length) {
+	uint32_t a = 1, b = 0;
+	while (length > 0) {
+		uint64_t chunk = std::min(length, ADLER_NMAX);
+		length -= chunk;
+		while (chunk-- > 0) {
+			a += *data++;
+			b += a;
+		}
+		a %= ADLER_MODULUS;
+		b %= ADLER_MODULUS;
+	}
+	return (b << 16) | a;
+}
+
+
+/**
+*  @brief CRC32C portable implementation (byte lookup table)
+*/
+static uint32_t crc32cPortable(const uint8_t* data, uint64_t length) {
+	static const struct CrcTable {
+		uint32_t entries[256];
+		CrcTable() {
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t crc = i;
+				for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (CRC32C_POLY & (0 - (crc & 1)));
+				entries[i] = crc;
+			}
+		}
+	} table;
+	uint32_t crc = 0xFFFFFFFF;
+	while (length-- > 0) crc = (crc >> 8) ^ table.entries[(crc ^ *data++) & 0xFF];
+	return ~crc;
+}
+
+
+#ifdef BOSON_CHECKSUM_X86
+
+/**
+*
+*  @brief Adler-32 AVX2 implementation: every 32 bytes block adds its byte
+*  sum to A and its bytes weighted 32..1 to B, B also gets 32 times A of
+*  previous blocks (summed once per chunk)
+*
+*/
+__attribute__((target("avx2")))
+static uint32_t adler32Avx2(const uint8_t* data, uint64_t length) {
+	constexpr uint64_t BLOCK = 32;
+	const __m256i weights = _mm256_setr_epi8(
+		32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+		16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+	const __m256i ones = _mm256_set1_epi16(1);
+	const __m256i zero = _mm256_setzero_si256();
+	uint64_t a = 1, b = 0;
+	while (length >= BLOCK) {
+		uint64_t blocks = std::min(length / BLOCK, ADLER_NMAX / BLOCK);
+		uint64_t chunk = blocks * BLOCK;
+		__m256i sumA = zero, sumB = zero, previousA = zero;
+		for (uint64_t i = 0; i < blocks; i++) {
+			__m256i bytes = _mm256_loadu_si256((const __m256i*)(data + i * BLOCK));
+			previousA = _mm256_add_epi32(previousA, sumA);
+			sumA = _mm256_add_epi32(sumA, _mm256_sad_epu8(bytes, zero));
+			sumB = _mm256_add_epi32(sumB, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, weights), ones));
+		}
+		sumB = _mm256_add_epi32(sumB, _mm256_slli_epi32(previousA, 5));
+		alignas(32) uint32_t lanesA[8], lanesB[8];
+		_mm256_store_si256((__m256i*)lanesA, sumA);
+		_mm256_store_si256((__m256i*)lanesB, sumB);
+		uint64_t totalA = 0, totalB = 0;
+		for (int i = 0; i < 8; i++) {
+			totalA += lanesA[i];
+			totalB += lanesB[i];
+		}
+		b = (b + a * chunk + totalB) % ADLER_MODULUS;
+		a = (a + totalA) % ADLER_MODULUS;
+		data += chunk;
+		length -= chunk;
+	}
+	// tail shorter than block
+	while (length-- > 0) {
+		a += *data++;
+		b += a;
+	}
+	return uint32_t(((b % ADLER_MODULUS) << 16) | (a % ADLER_MODULUS));
+}
+
+
+/**
+*  @brief CRC32C SSE4.2 implementation (crc32 instruction, 8 bytes per step)
+*/
+__attribute__((target("sse4.2")))
+static uint32_t crc32cSse42(const uint8_t* data, uint64_t length) {
+	uint64_t crc = 0xFFFFFFFF;
+	for (; length > 0 && (uintptr_t(data) & 7) != 0; length--) {
+		crc = _mm_crc32_u8(uint32_t(crc), *data++);
+	}
+#if defined(__x86_64__)
+	for (; length >= 8; length -= 8, data += 8) {
+		crc = _mm_crc32_u64(crc, *(const uint64_t*)data);
+	}
+#endif
+	for (; length >= 4; length -= 4, data += 4) {
+		crc = _mm_crc32_u32(uint32_t(crc), *(const uint32_t*)data);
+	}
+	for (; length > 0; length--) {
+		crc = _mm_crc32_u8(uint32_t(crc), *data++);
+	}
+	return ~uint32_t(crc);
+}
+
+#endif
+
+
+/**
+*
+*  @brief Returns the fastest implementation of checksum algorithm
+*  supported by CPU
+*
+*  @param[in] type - checksum algorithm
+*
+*  @return checksum function or nullptr if algorithm is unknown
+*
+*/
+ChecksumFunction Checksum::get(ChecksumType type) {
+#ifdef BOSON_CHECKSUM_X86
+	static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+	static const bool hasSse42 = __builtin_cpu_supports("sse4.2");
+#else
+	constexpr bool hasAvx2 = false;
+	constexpr bool hasSse42 = false;
+#endif
+	switch (type) {
+#ifdef BOSON_CHECKSUM_X86
+	case ADLER32_CHECKSUM:
+		return hasAvx2 ? adler32Avx2 : adler32Portable;
+	case CRC32C_CHECKSUM:
+		return hasSse42 ? crc32cSse42 : crc32cPortable;
+#else
+	case ADLER32_CHECKSUM:
+		return adler32Portable;
+	case CRC32C_CHECKSUM:
+		return crc32cPortable;
+#endif
+	default:
+		return nullptr;
+	}
+}
+
+
+/**
+*
+*  @brief Returns name of checksum implementation chosen for the CPU
+*
+*  @param[in] type - checksum algorithm
+*
+*  @return implementation name or "unknown"
+*
+*/
+const char* Checksum::getImplementation(ChecksumType type) {
+	return getName(get(type));
+}
+
+
+/**
+*
+*  @brief Returns all implementations of checksum algorithm supported by
+*  CPU, portable implementation first (to compare results of the others)
+*
+*  @param[in] type - checksum algorithm
+*
+*  @return checksum functions or empty vector if algorithm is unknown
+*
+*/
+std::vector<ChecksumFunction> Checksum::getSupported(ChecksumType type) {
+	std::vector<ChecksumFunction> functions;
+	switch (type) {
+	case ADLER32_CHECKSUM:
+		functions.push_back(adler32Portable);
+#ifdef BOSON_CHECKSUM_X86
+		if (__builtin_cpu_supports("avx2")) functions.push_back(adler32Avx2);
+#endif
+		break;
+	case CRC32C_CHECKSUM:
+		functions.push_back(crc32cPortable);
+#ifdef BOSON_CHECKSUM_X86
+		if (__builtin_cpu_supports("sse4.2")) functions.push_back(crc32cSse42);
+#endif
+		break;
+	default:
+		break;
+	}
+	return functions;
+}
+
+
+/**
+*
+*  @brief Returns name of checksum implementation
+*
+*  @param[in] function - checksum function
+*
+*  @return implementation name or "unknown"
+*
+*/
+const char* Checksum::getName(ChecksumFunction function) {
+	if (function == adler32Portable) return "Adler-32 portable";
+	if (function == crc32cPortable) return "CRC32C portable";
+#ifdef BOSON_CHECKSUM_X86
+	if (function == adler32Avx2) return "Adler-32 AVX2";
+	if (function == crc32cSse42) return "CRC32C SSE4.2";
+#endif
+	return "unknown";
+}
+
+
+/**
+*  @brief Calculates Adler-32 checksum of data
+*/
+uint32_t Checksum::adler32(const uint8_t* data, uint64_t length) {
+	static const ChecksumFunction function = get(ADLER32_CHECKSUM);
+	return function(data, length);
+}
+
+
+/**
+*  @brief Calculates CRC32C checksum of data
+*/
+uint32_t Checksum::crc32c(const uint8_t* data, uint64_t length) {
+	static const ChecksumFunction function = get(CRC32C_CHECKSUM);
+	return function(data, length);
+}
@@ -0,0 +1,46 @@
+/******************************************************************************
+*
+*  Checksum class header
+*
+*  Checksum engine of record headers and payloads. Algorithm is recorded
+*  per storage file: Adler-32 (files created before checksum type field)
+*  or CRC32C (Castagnoli). Implementation is chosen once at runtime by CPU
+*  features: CRC32C uses SSE4.2 crc32 instruction, Adler-32 uses AVX2 sums
+*  of 32 byte blocks, both fall back to portable code. All implementations
+*  of the algorithm return the same value.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Boson {
+
+	typedef enum : uint32_t {                    // Record checksum algorithms
+		ADLER32_CHECKSUM = 0,                    // Adler-32 (zero in older files)
+		CRC32C_CHECKSUM  = 1                     // CRC32C (Castagnoli)
+	} ChecksumType;
+
+	constexpr ChecksumType DEFAULT_CHECKSUM = CRC32C_CHECKSUM; // New files checksum
+
+	typedef uint32_t (*ChecksumFunction)(const uint8_t* data, uint64_t length);
+
+	//-------------------------------------------------------------------------
+	// Checksum algorithms with runtime CPU dispatch
+	//-------------------------------------------------------------------------
+	class Checksum {
+	public:
+		static ChecksumFunction get(ChecksumType type);
+		static const char* getImplementation(ChecksumType type);
+		static std::vector<ChecksumFunction> getSupported(ChecksumType type);
+		static const char* getName(ChecksumFunction function);
+		static uint32_t adler32(const uint8_t* data, uint64_t length);
+		static uint32_t crc32c(const uint8_t* data, uint64_t length);
+	};
+
+}
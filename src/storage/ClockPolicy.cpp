@@ -0,0 +1,267 @@
+/******************************************************************************
+*
+*  ClockPolicy and ClockProPolicy classes implementation
+*
+*  Both policies keep no separate structures for resident pages: the clock
+*  ring is the contiguous pool slice of cache partition and per page state
+*  is stored in CachePage::policyState, so cache hit is a single bit store.
+*
+*  CLOCK-Pro (S. Jiang, F. Chen, X. Zhang, 2005) divides pages into hot and
+*  cold ones. New page is cold and gets a test period: if it is referenced
+*  again during the test, it becomes hot. Evicted cold pages in test period
+*  are remembered in history (non resident pages), re-access of such page
+*  grows cold pages target, expiration of test period shrinks it.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "ReplacementPolicy.h"
+#include "CachedFileIO.h"
+
+#include <algorithm>
+
+using namespace Boson;
+
+
+//=============================================================================
+//
+//                              CLOCK policy
+//
+//=============================================================================
+
+/**
+*  @brief Constructor
+*  @param[in] pages    - partition slice of cache pages pool
+*  @param[in] capacity - partition capacity (pages)
+*/
+ClockPolicy::ClockPolicy(CachePage* pages, size_t capacity) {
+	this->pages = pages;
+	this->capacity = capacity;
+	this->hand = 0;
+}
+
+
+/**
+*  @brief Marks loaded page as resident (not referenced yet)
+*/
+void ClockPolicy::onInsert(CachePage* page) {
+	page->policyState = POLICY_RESIDENT;
+}
+
+
+/**
+*  @brief Sets page reference bit
+*/
+void ClockPolicy::onAccess(CachePage* page) {
+	page->policyState |= POLICY_REFERENCED;
+}
+
+
+/**
+*
+*  @brief Moves clock hand clearing reference bits until not referenced
+*  and not pinned resident page found. Clean page is preferred if it is
+*  found before CLEAN_VICTIM_SCAN dirty pages.
+*
+*  @return victim page or nullptr if all pages are pinned
+*
+*/
+CachePage* ClockPolicy::selectVictim() {
+	CachePage* dirtyPage = nullptr;
+	size_t dirtyScanned = 0;
+	// two full turns clear all reference bits, third one finds victim
+	for (size_t scanned = 0; scanned < capacity * 3; scanned++) {
+		CachePage* page = &pages[hand];
+		if (++hand == capacity) hand = 0;
+		if ((page->policyState & POLICY_RESIDENT) == 0) continue;
+		if (page->pinCount.load(std::memory_order_acquire) != 0) continue;
+		if (page->policyState & POLICY_REFERENCED) {
+			page->policyState &= ~POLICY_REFERENCED;
+			continue;
+		}
+		if (page->state == PageState::DIRTY) {
+			if (dirtyPage == nullptr) dirtyPage = page;
+			if (++dirtyScanned < CLEAN_VICTIM_SCAN) continue;
+			page = dirtyPage;
+		}
+		page->policyState = 0;
+		return page;
+	}
+	if (dirtyPage != nullptr) dirtyPage->policyState = 0;
+	return dirtyPage;
+}
+
+
+//=============================================================================
+//
+//                            CLOCK-Pro policy
+//
+//=============================================================================
+
+/**
+*  @brief Constructor
+*  @param[in] pages    - partition slice of cache pages pool
+*  @param[in] capacity - partition capacity (pages)
+*/
+ClockProPolicy::ClockProPolicy(CachePage* pages, size_t capacity) : history(capacity) {
+	this->pages = pages;
+	this->capacity = capacity;
+	this->hotHand = 0;
+	this->coldHand = 0;
+	this->hotCount = 0;
+	this->coldCount = 0;
+	this->coldTarget = capacity / 2 < 1 ? 1 : capacity / 2;
+	this->residentLimit = capacity;
+}
+
+
+/**
+*
+*  @brief Sets resident pages limit of cache resized in place (ring stays
+*  the whole pool slice), cold pages target is kept below the limit
+*
+*  @param[in] capacity - partition capacity (pages)
+*
+*/
+void ClockProPolicy::setCapacity(size_t capacity) {
+	this->residentLimit = std::max<size_t>(std::min(capacity, this->capacity), 1);
+	if (coldTarget + 1 > residentLimit) coldTarget = std::max<size_t>(residentLimit - 1, 1);
+}
+
+
+/**
+*
+*  @brief Places loaded page to the ring: page re-accessed during its test
+*  period becomes hot (and cold target grows), other pages start as cold
+*  pages in test period
+*
+*/
+void ClockProPolicy::onInsert(CachePage* page) {
+	if (history.remove(page->filePageNo)) {
+		if (coldTarget + 1 < residentLimit) coldTarget++;
+		page->policyState = POLICY_RESIDENT | POLICY_HOT;
+		hotCount++;
+		runHotHand();
+	} else {
+		page->policyState = POLICY_RESIDENT | POLICY_TEST;
+		coldCount++;
+	}
+}
+
+
+/**
+*  @brief Sets page reference bit
+*/
+void ClockProPolicy::onAccess(CachePage* page) {
+	page->policyState |= POLICY_REFERENCED;
+}
+
+
+/**
+*
+*  @brief Returns not evicted victim to the ring as cold page in test period,
+*  history entry added on its eviction is dropped (page is not promoted)
+*
+*/
+void ClockProPolicy::onRestore(CachePage* page) {
+	history.remove(page->filePageNo);
+	page->policyState = POLICY_RESIDENT | POLICY_TEST;
+	coldCount++;
+}
+
+
+/**
+*
+*  @brief Moves cold hand: referenced cold pages in test period are promoted
+*  to hot, other referenced cold pages get new test period. First not
+*  referenced and not pinned cold page is evicted, clean page is preferred
+*  if it is found before CLEAN_VICTIM_SCAN dirty pages.
+*
+*  @return victim page or nullptr if all pages are pinned
+*
+*/
+CachePage* ClockProPolicy::selectVictim() {
+	CachePage* dirtyPage = nullptr;
+	size_t dirtyScanned = 0;
+	for (size_t scanned = 0; scanned < capacity * 4; scanned++) {
+		// no cold pages: demote hot pages
+		if (coldCount == 0) {
+			if (hotCount == 0) return nullptr;
+			runHotHand();
+		}
+		CachePage* page = &pages[coldHand];
+		if (++coldHand == capacity) coldHand = 0;
+		uint32_t state = page->policyState;
+		if ((state & POLICY_RESIDENT) == 0 || (state & POLICY_HOT)) continue;
+		if (page->pinCount.load(std::memory_order_acquire) != 0) continue;
+		if (state & POLICY_REFERENCED) {
+			if (state & POLICY_TEST) {
+				// re-accessed during test period: promote to hot
+				page->policyState = POLICY_RESIDENT | POLICY_HOT;
+				coldCount--;
+				hotCount++;
+				runHotHand();
+			} else page->policyState = POLICY_RESIDENT | POLICY_TEST;
+			continue;
+		}
+		if (page->state == PageState::DIRTY) {
+			if (dirtyPage == nullptr) dirtyPage = page;
+			if (++dirtyScanned < CLEAN_VICTIM_SCAN) continue;
+			page = dirtyPage;
+		}
+		return evictCold(page);
+	}
+	return dirtyPage == nullptr ? nullptr : evictCold(dirtyPage);
+}
+
+
+/**
+*  @brief Evicts cold page, remembers it if it is still in test period
+*  @return evicted page
+*/
+CachePage* ClockProPolicy::evictCold(CachePage* page) {
+	if ((page->policyState & POLICY_TEST) && history.add(page->filePageNo)) decreaseColdTarget();
+	page->policyState = 0;
+	coldCount--;
+	return page;
+}
+
+
+/**
+*
+*  @brief Moves hot hand while hot pages exceed target (or there are no
+*  cold pages): not referenced hot pages are demoted to cold, test periods
+*  of passed not referenced cold pages expire
+*
+*/
+void ClockProPolicy::runHotHand() {
+	size_t hotTarget = residentLimit > coldTarget ? residentLimit - coldTarget : 0;
+	for (size_t scanned = 0; scanned < capacity * 2; scanned++) {
+		if (hotCount == 0 || (hotCount <= hotTarget && coldCount > 0)) return;
+		CachePage* page = &pages[hotHand];
+		if (++hotHand == capacity) hotHand = 0;
+		uint32_t state = page->policyState;
+		if ((state & POLICY_RESIDENT) == 0) continue;
+		if (state & POLICY_HOT) {
+			if (state & POLICY_REFERENCED) {
+				page->policyState = state & ~POLICY_REFERENCED;
+				continue;
+			}
+			page->policyState = POLICY_RESIDENT;
+			hotCount--;
+			coldCount++;
+		} else if ((state & POLICY_TEST) && !(state & POLICY_REFERENCED)) {
+			page->policyState = state & ~POLICY_TEST;
+			decreaseColdTarget();
+		}
+	}
+}
+
+
+/**
+*  @brief Shrinks cold pages target when test period expired without re-access
+*/
+void ClockProPolicy::decreaseColdTarget() {
+	if (coldTarget > 1) coldTarget--;
+}
@@ -0,0 +1,209 @@
+/******************************************************************************
+*
+*  DirectBackend class implementation
+*
+*  POSIX positional I/O backend with O_DIRECT. Block aligned transfers
+*  (cache pages of CachedFileIO) go directly between page buffers and
+*  storage device bypassing OS page cache, so database pages are not
+*  cached twice. Unaligned transfers use second buffered descriptor of
+*  the same file. If file system does not support direct I/O, backend
+*  works as regular PosixBackend.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#ifndef _WIN32
+
+#include "StorageBackend.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace Boson;
+
+
+/**
+* @brief Constructor
+*/
+DirectBackend::DirectBackend() {
+	this->bufferedDescriptor = -1;
+}
+
+
+/**
+* @brief Destructor closes file if it still open
+*/
+DirectBackend::~DirectBackend() {
+	this->close();
+}
+
+
+/**
+*
+*  @brief Opens existing file or creates new one (if write permitted) for
+*  direct I/O and buffered descriptor for unaligned transfers
+*
+*  @param[in] path     - the name of the file to be opened (path)
+*  @param[in] readOnly - if true, file is opened for reading only
+*
+*  @return true if file opened, false if can't open file
+*
+*/
+bool DirectBackend::open(const char* path, bool readOnly) {
+	if (path == nullptr) return false;
+	if (isOpen()) close();
+	int flags = readOnly ? O_RDONLY : (O_RDWR | O_CREAT);
+	// buffered descriptor creates file if required
+	do {
+		this->bufferedDescriptor = ::open(path, flags | O_CLOEXEC, 0644);
+	} while (this->bufferedDescriptor < 0 && errno == EINTR);
+	if (this->bufferedDescriptor < 0) return false;
+#ifdef O_DIRECT
+	do {
+		this->fileDescriptor = ::open(path, (flags & ~O_CREAT) | O_DIRECT | O_CLOEXEC);
+	} while (this->fileDescriptor < 0 && errno == EINTR);
+#elif defined(F_NOCACHE)
+	do {
+		this->fileDescriptor = ::open(path, (flags & ~O_CREAT) | O_CLOEXEC);
+	} while (this->fileDescriptor < 0 && errno == EINTR);
+	if (this->fileDescriptor >= 0) fcntl(this->fileDescriptor, F_NOCACHE, 1);
+#endif
+	// file system does not support direct I/O: use buffered descriptor only
+	if (this->fileDescriptor < 0) {
+		this->fileDescriptor = this->bufferedDescriptor;
+		this->bufferedDescriptor = -1;
+	}
+	this->preallocatedEnd = getSize();
+	return true;
+}
+
+
+/**
+*  @brief Closes both file descriptors
+*  @return true if file closed, false if file has not been opened
+*/
+bool DirectBackend::close() {
+	if (this->bufferedDescriptor >= 0) {
+		::close(this->bufferedDescriptor);
+		this->bufferedDescriptor = -1;
+	}
+	return PosixBackend::close();
+}
+
+
+/**
+*
+*  @brief Reads data at given offset of the file: directly if offset, length
+*  and buffer are block aligned, otherwise through buffered descriptor
+*
+*  @param[in]  offset - offset from beginning of the file
+*  @param[out] buffer - data buffer where data copied
+*  @param[in]  length - data amount to read
+*
+*  @return bytes actually read (less than length at the end of file)
+*
+*/
+size_t DirectBackend::read(uint64_t offset, void* buffer, size_t length) {
+	if (isAligned(offset, buffer, length)) return PosixBackend::read(offset, buffer, length);
+	uint8_t* dst = (uint8_t*)buffer;
+	size_t bytesRead = 0;
+	while (bytesRead < length) {
+		ssize_t result = ::pread(this->bufferedDescriptor, dst + bytesRead,
+			length - bytesRead, (off_t)(offset + bytesRead));
+		if (result < 0 && errno == EINTR) continue;
+		if (result <= 0) break;
+		bytesRead += (size_t)result;
+	}
+	return bytesRead;
+}
+
+
+/**
+*
+*  @brief Writes data at given offset of the file: directly if offset, length
+*  and buffer are block aligned, otherwise through buffered descriptor
+*
+*  @param[in] offset - offset from beginning of the file
+*  @param[in] buffer - data buffer to write
+*  @param[in] length - data amount to write
+*
+*  @return bytes actually written
+*
+*/
+size_t DirectBackend::write(uint64_t offset, const void* buffer, size_t length) {
+	if (isAligned(offset, buffer, length)) return PosixBackend::write(offset, buffer, length);
+	preallocate(offset + length);
+	const uint8_t* src = (const uint8_t*)buffer;
+	size_t bytesWritten = 0;
+	while (bytesWritten < length) {
+		ssize_t result = ::pwrite(this->bufferedDescriptor, src + bytesWritten,
+			length - bytesWritten, (off_t)(offset + bytesWritten));
+		if (result < 0 && errno == EINTR) continue;
+		if (result <= 0) break;
+		bytesWritten += (size_t)result;
+	}
+	return bytesWritten;
+}
+
+
+/**
+*
+*  @brief Reads contiguous file range into several buffers: single direct
+*  preadv if all buffers are block aligned, otherwise buffer by buffer
+*
+*  @param[in] offset  - offset from beginning of the file
+*  @param[in] buffers - destination buffers in file order
+*  @param[in] count   - buffers count
+*
+*  @return total bytes actually read (stops at end of file)
+*
+*/
+size_t DirectBackend::readVector(uint64_t offset, const IOBuffer* buffers, size_t count) {
+	bool aligned = isAligned(offset, nullptr, 0);
+	for (size_t i = 0; i < count && aligned; i++) aligned = isAligned(0, buffers[i].data, buffers[i].length);
+	if (aligned) return PosixBackend::readVector(offset, buffers, count);
+	return StorageBackend::readVector(offset, buffers, count);
+}
+
+
+/**
+*
+*  @brief Writes several buffers to contiguous file range: single direct
+*  pwritev if all buffers are block aligned, otherwise buffer by buffer
+*
+*  @param[in] offset  - offset from beginning of the file
+*  @param[in] buffers - source buffers in file order
+*  @param[in] count   - buffers count
+*
+*  @return total bytes actually written
+*
+*/
+size_t DirectBackend::writeVector(uint64_t offset, const IOBuffer* buffers, size_t count) {
+	bool aligned = isAligned(offset, nullptr, 0);
+	for (size_t i = 0; i < count && aligned; i++) aligned = isAligned(0, buffers[i].data, buffers[i].length);
+	if (aligned) return PosixBackend::writeVector(offset, buffers, count);
+	return StorageBackend::writeVector(offset, buffers, count);
+}
+
+
+/**
+*
+*  @brief Checks if transfer can be done with direct I/O
+*
+*  @param[in] offset - file offset
+*  @param[in] buffer - memory buffer
+*  @param[in] length - transfer length
+*
+*  @return true if direct I/O is on and all values are block aligned
+*
+*/
+bool DirectBackend::isAligned(uint64_t offset, const void* buffer, size_t length) {
+	if (this->bufferedDescriptor < 0) return true;
+	uint64_t bits = offset | (uint64_t)(uintptr_t)buffer | (uint64_t)length;
+	return (bits & (DIRECT_IO_ALIGNMENT - 1)) == 0;
+}
+
+#endif
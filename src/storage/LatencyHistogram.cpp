@@ -0,0 +1,92 @@
+/******************************************************************************
+*
+*  LatencyHistogram class implementation
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "LatencyHistogram.h"
+
+using namespace Boson;
+
+
+/**
+* @brief Constructor (all buckets empty)
+*/
+LatencyHistogram::LatencyHistogram() {
+	reset();
+}
+
+
+
+/**
+* @brief Clears all buckets
+*/
+void LatencyHistogram::reset() {
+	for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		counts[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+
+
+/**
+*
+*  @brief Adds bucket counts of this histogram to totals array
+*
+*  @param[in,out] totals - array of HISTOGRAM_BUCKETS counters
+*
+*/
+void LatencyHistogram::addTo(uint64_t* totals) {
+	for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		totals[i] += counts[i].load(std::memory_order_relaxed);
+	}
+}
+
+
+
+/**
+*
+*  @brief Calculates percentile of values counted in buckets
+*
+*  @param[in] totals     - array of HISTOGRAM_BUCKETS counters
+*  @param[in] percentile - requested percentile (0-100)
+*
+*  @return highest value of the bucket holding percentile or 0 if no values
+*
+*/
+uint64_t LatencyHistogram::percentile(const uint64_t* totals, double percentile) {
+	uint64_t valuesCount = 0;
+	for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) valuesCount += totals[i];
+	if (valuesCount == 0) return 0;
+	// rank of the value (at least first value)
+	uint64_t rank = uint64_t(percentile / 100.0 * double(valuesCount) + 0.5);
+	if (rank == 0) rank = 1;
+	if (rank > valuesCount) rank = valuesCount;
+	uint64_t counted = 0;
+	for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		counted += totals[i];
+		if (counted >= rank) return bucketValue(i);
+	}
+	return bucketValue(HISTOGRAM_BUCKETS - 1);
+}
+
+
+
+/**
+*
+*  @brief Returns highest value counted in the bucket
+*
+*  @param[in] index - bucket index
+*
+*  @return highest value of the bucket range
+*
+*/
+uint64_t LatencyHistogram::bucketValue(size_t index) {
+	uint64_t row = index / HISTOGRAM_SUB_BUCKETS;
+	uint64_t subBucket = index % HISTOGRAM_SUB_BUCKETS;
+	if (row == 0) return subBucket;
+	uint64_t lowest = (HISTOGRAM_SUB_BUCKETS + subBucket) << (row - 1);
+	return lowest + (uint64_t(1) << (row - 1)) - 1;
+}
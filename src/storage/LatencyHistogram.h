@@ -0,0 +1,72 @@
+/******************************************************************************
+*
+*  LatencyHistogram class header
+*
+*  LatencyHistogram counts operation latencies (ns) in log-linear buckets
+*  (HDR histogram style): values below 16 have exact buckets, every next
+*  power of two range is split into 16 equal sub-buckets, so any recorded
+*  value is known within 6.25% precision up to ~18 minutes. Recording is
+*  single relaxed atomic increment, percentiles are calculated on demand
+*  from bucket counts merged from several histograms.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+namespace Boson {
+
+	constexpr uint64_t HISTOGRAM_SUB_BUCKET_BITS = 4;   // Sub-buckets per power of 2 (bits)
+	constexpr uint64_t HISTOGRAM_SUB_BUCKETS     = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+	constexpr uint64_t HISTOGRAM_MAX_EXPONENT    = 40;  // Values up to 2^40 ns (~18 min)
+	constexpr uint64_t HISTOGRAM_BUCKETS         =      // Total buckets count
+		(HISTOGRAM_MAX_EXPONENT - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS;
+
+	//-------------------------------------------------------------------------
+	// Log-linear latency histogram (thread safe recording)
+	//-------------------------------------------------------------------------
+	class LatencyHistogram {
+	public:
+		LatencyHistogram();
+		void     reset();
+		void     addTo(uint64_t* totals);
+		static uint64_t percentile(const uint64_t* totals, double percentile);
+		static uint64_t bucketValue(size_t index);
+
+		/**
+		*  @brief Counts value in its bucket
+		*  @param[in] value - latency (ns)
+		*/
+		inline void record(uint64_t value) {
+			counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		*  @brief Returns bucket index of value
+		*  @param[in] value - latency (ns)
+		*  @return bucket index (last bucket for values out of range)
+		*/
+		static inline size_t bucketOf(uint64_t value) {
+			if (value < HISTOGRAM_SUB_BUCKETS) return size_t(value);
+#if defined(__GNUC__) || defined(__clang__)
+			uint64_t exponent = 63 - __builtin_clzll(value);
+#else
+			uint64_t exponent = 0;
+			while ((value >> exponent) > 1) exponent++;
+#endif
+			if (exponent >= HISTOGRAM_MAX_EXPONENT) return HISTOGRAM_BUCKETS - 1;
+			uint64_t row = exponent - HISTOGRAM_SUB_BUCKET_BITS + 1;
+			uint64_t subBucket = (value >> (row - 1)) & (HISTOGRAM_SUB_BUCKETS - 1);
+			return size_t(row * HISTOGRAM_SUB_BUCKETS + subBucket);
+		}
+
+	private:
+		std::atomic<uint64_t> counts[HISTOGRAM_BUCKETS]; // Values count per bucket
+	};
+
+}
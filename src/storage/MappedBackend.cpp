@@ -0,0 +1,175 @@
+/******************************************************************************
+*
+*  MappedBackend class implementation
+*
+*  Read only storage backend based on memory mapped file. Pages are not
+*  copied into private buffers: CachedFileIO resolves reads directly
+*  against the mapping, so data lives only in OS page cache, which is
+*  shared between all processes that open the same database file.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#ifndef _WIN32
+
+#include "StorageBackend.h"
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace Boson;
+
+
+/**
+* @brief Constructor
+*/
+MappedBackend::MappedBackend() {
+	this->fileDescriptor = -1;
+	this->mappedData = nullptr;
+	this->mappedSize = 0;
+}
+
+
+/**
+* @brief Destructor unmaps and closes file if it still open
+*/
+MappedBackend::~MappedBackend() {
+	this->close();
+}
+
+
+/**
+*
+*  @brief Opens existing file and maps it into memory (read only)
+*
+*  @param[in] path     - the name of the file to be opened (path)
+*  @param[in] readOnly - must be true, mapped files can't be written
+*
+*  @return true if file opened and mapped, false otherwise
+*
+*/
+bool MappedBackend::open(const char* path, bool readOnly) {
+	if (path == nullptr || !readOnly) return false;
+	if (this->fileDescriptor >= 0) close();
+	do {
+		this->fileDescriptor = ::open(path, O_RDONLY | O_CLOEXEC);
+	} while (this->fileDescriptor < 0 && errno == EINTR);
+	if (this->fileDescriptor < 0) return false;
+	// get file size to map whole file
+	struct stat fileStats;
+	if (::fstat(this->fileDescriptor, &fileStats) != 0) {
+		close();
+		return false;
+	}
+	this->mappedSize = (uint64_t)fileStats.st_size;
+	// empty file can't be mapped, but it is still valid open file
+	if (this->mappedSize == 0) return true;
+	void* address = ::mmap(nullptr, this->mappedSize, PROT_READ, MAP_SHARED, this->fileDescriptor, 0);
+	if (address == MAP_FAILED) {
+		close();
+		return false;
+	}
+	this->mappedData = (uint8_t*)address;
+	return true;
+}
+
+
+/**
+*  @brief Unmaps and closes file
+*  @return true if file closed, false if file has not been opened
+*/
+bool MappedBackend::close() {
+	if (this->fileDescriptor < 0) return false;
+	if (this->mappedData != nullptr) ::munmap(this->mappedData, this->mappedSize);
+	::close(this->fileDescriptor);
+	this->fileDescriptor = -1;
+	this->mappedData = nullptr;
+	this->mappedSize = 0;
+	return true;
+}
+
+
+/**
+*  @brief Checks if file is open
+*  @return true - if file open, false - otherwise
+*/
+bool MappedBackend::isOpen() {
+	return this->fileDescriptor >= 0;
+}
+
+
+/**
+*
+*  @brief Copies data at given offset from the mapping
+*
+*  @param[in]  offset - offset from beginning of the file
+*  @param[out] buffer - data buffer where data copied
+*  @param[in]  length - data amount to read
+*
+*  @return bytes actually read (less than length at the end of file)
+*
+*/
+size_t MappedBackend::read(uint64_t offset, void* buffer, size_t length) {
+	if (this->mappedData == nullptr || offset >= this->mappedSize) return 0;
+	size_t bytesToCopy = (size_t)std::min<uint64_t>(length, this->mappedSize - offset);
+	memcpy(buffer, this->mappedData + offset, bytesToCopy);
+	return bytesToCopy;
+}
+
+
+/**
+*  @brief Mapped files are read only, so nothing is written
+*  @return always zero
+*/
+size_t MappedBackend::write(uint64_t offset, const void* buffer, size_t length) {
+	return 0;
+}
+
+
+/**
+*  @brief Nothing to persist for read only mapping
+*  @return true if file is open
+*/
+bool MappedBackend::sync() {
+	return this->fileDescriptor >= 0;
+}
+
+
+/**
+*  @brief Get mapped file size
+*  @return file size in bytes at the moment of mapping
+*/
+uint64_t MappedBackend::getSize() {
+	return this->mappedSize;
+}
+
+
+/**
+*  @brief Advises kernel about expected access pattern of mapping (madvise)
+*  @param[in] pattern - expected access pattern
+*  @return true if advice accepted, false otherwise
+*/
+bool MappedBackend::advise(AccessPattern pattern) {
+	if (this->mappedData == nullptr) return false;
+	int advice = MADV_NORMAL;
+	if (pattern == AccessPattern::RANDOM_ACCESS) advice = MADV_RANDOM;
+	if (pattern == AccessPattern::SEQUENTIAL_ACCESS) advice = MADV_SEQUENTIAL;
+	return ::madvise(this->mappedData, this->mappedSize, advice) == 0;
+}
+
+
+/**
+*  @brief Get pointer to the beginning of mapped file
+*  @return mapped data pointer or nullptr if file is empty or not open
+*/
+const uint8_t* MappedBackend::getMappedData() {
+	return this->mappedData;
+}
+
+#endif
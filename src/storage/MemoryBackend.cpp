@@ -0,0 +1,299 @@
+/******************************************************************************
+*
+*  MemoryBackend class implementation
+*
+*  In-memory storage backend: database lives in growable arena of zeroed
+*  chunks, so reads and writes are plain memory copies without system
+*  calls. Chunks table grows under exclusive lock, copies run under shared
+*  lock, so concurrent transfers of different pages never block each other.
+*  Arena can be loaded from snapshot file on open and saved to snapshot file
+*  at any time, otherwise data is lost on close.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "StorageBackend.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Boson;
+
+
+/**
+* @brief Constructor
+*/
+MemoryBackend::MemoryBackend() {
+	this->dataSize = 0;
+	this->opened = false;
+	this->readOnly = false;
+}
+
+
+/**
+* @brief Destructor releases arena memory
+*/
+MemoryBackend::~MemoryBackend() {
+	this->close();
+}
+
+
+/**
+*
+*  @brief Opens empty arena or loads it from snapshot file
+*
+*  @param[in] path     - snapshot file to load (nullptr or missing file
+*                        gives empty database if write permitted)
+*  @param[in] readOnly - if true, write operations are not allowed
+*
+*  @return true if arena opened, false if snapshot exists but can't be
+*          loaded (so it is not replaced by empty database snapshot)
+*
+*/
+bool MemoryBackend::open(const char* path, bool readOnly) {
+	if (this->opened) close();
+	this->readOnly = false;
+	bool missing = true;
+	bool loaded = (path != nullptr && *path != 0) ? load(path, missing) : false;
+	if (!loaded && (readOnly || !missing)) {
+		release();
+		return false;
+	}
+	this->readOnly = readOnly;
+	this->opened = true;
+	return true;
+}
+
+
+/**
+*
+*  @brief Closes arena and releases its memory (data is lost)
+*
+*  @return true if arena was open, false otherwise
+*
+*/
+bool MemoryBackend::close() {
+	if (!this->opened) return false;
+	release();
+	this->opened = false;
+	return true;
+}
+
+
+/**
+*  @brief Checks if arena is open
+*/
+bool MemoryBackend::isOpen() {
+	return this->opened;
+}
+
+
+/**
+*
+*  @brief Copies data from the arena
+*
+*  @param[in]  offset - offset from beginning of the database
+*  @param[out] buffer - destination buffer
+*  @param[in]  length - bytes to read
+*
+*  @return bytes actually read (stops at end of data)
+*
+*/
+size_t MemoryBackend::read(uint64_t offset, void* buffer, size_t length) {
+	std::shared_lock<std::shared_mutex> lock(arenaMutex);
+	uint64_t size = dataSize.load();
+	if (!opened || offset >= size) return 0;
+	length = (size_t)std::min<uint64_t>(length, size - offset);
+	uint8_t* destination = (uint8_t*)buffer;
+	size_t bytesRead = 0;
+	while (bytesRead < length) {
+		uint64_t position = offset + bytesRead;
+		size_t chunkOffset = size_t(position % MEMORY_CHUNK_SIZE);
+		size_t bytesCount = std::min(length - bytesRead, MEMORY_CHUNK_SIZE - chunkOffset);
+		memcpy(destination + bytesRead, chunks[position / MEMORY_CHUNK_SIZE] + chunkOffset, bytesCount);
+		bytesRead += bytesCount;
+	}
+	return bytesRead;
+}
+
+
+/**
+*
+*  @brief Copies data to the arena, arena grows by whole chunks
+*
+*  @param[in] offset - offset from beginning of the database
+*  @param[in] buffer - source buffer
+*  @param[in] length - bytes to write
+*
+*  @return bytes actually written (0 if read only or out of memory)
+*
+*/
+size_t MemoryBackend::write(uint64_t offset, const void* buffer, size_t length) {
+	if (!opened || readOnly || length == 0) return 0;
+	uint64_t endOffset = offset + length;
+	if (!reserve(endOffset)) return 0;
+	{
+		std::shared_lock<std::shared_mutex> lock(arenaMutex);
+		const uint8_t* source = (const uint8_t*)buffer;
+		size_t bytesWritten = 0;
+		while (bytesWritten < length) {
+			uint64_t position = offset + bytesWritten;
+			size_t chunkOffset = size_t(position % MEMORY_CHUNK_SIZE);
+			size_t bytesCount = std::min(length - bytesWritten, MEMORY_CHUNK_SIZE - chunkOffset);
+			memcpy(chunks[position / MEMORY_CHUNK_SIZE] + chunkOffset, source + bytesWritten, bytesCount);
+			bytesWritten += bytesCount;
+		}
+	}
+	// extend data size up to the end of written range
+	uint64_t size = dataSize.load();
+	while (size < endOffset && !dataSize.compare_exchange_weak(size, endOffset));
+	return length;
+}
+
+
+/**
+*
+*  @brief Returns pointer to arena data, so reads and writes can be resolved
+*  in place (chunks never move while arena is open)
+*
+*  @param[in]  offset - offset from beginning of the database
+*  @param[out] length - bytes available at pointer (up to end of data or chunk)
+*
+*  @return pointer to data at offset or nullptr if offset is beyond data
+*
+*/
+uint8_t* MemoryBackend::getMemoryData(uint64_t offset, size_t& length) {
+	std::shared_lock<std::shared_mutex> lock(arenaMutex);
+	uint64_t size = dataSize.load();
+	if (!opened || offset >= size) return nullptr;
+	size_t chunkOffset = size_t(offset % MEMORY_CHUNK_SIZE);
+	length = (size_t)std::min<uint64_t>(size - offset, MEMORY_CHUNK_SIZE - chunkOffset);
+	return chunks[offset / MEMORY_CHUNK_SIZE] + chunkOffset;
+}
+
+
+/**
+*  @brief Returns data size in bytes
+*/
+uint64_t MemoryBackend::getSize() {
+	return dataSize.load();
+}
+
+
+/**
+*
+*  @brief Saves arena data to snapshot file. File is written to temporary
+*  file, synced to storage device and renamed, so crash never leaves torn
+*  snapshot. Concurrent writes must be avoided by the caller.
+*
+*  @param[in] path - snapshot file path
+*
+*  @return true if snapshot saved, false otherwise
+*
+*/
+bool MemoryBackend::snapshot(const char* path) {
+	if (!opened || path == nullptr) return false;
+	std::string tempPath = std::string(path) + ".tmp";
+	std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+	if (file == nullptr) return false;
+	bool saved = true;
+	{
+		std::shared_lock<std::shared_mutex> lock(arenaMutex);
+		uint64_t size = dataSize.load();
+		for (uint64_t position = 0; position < size && saved; position += MEMORY_CHUNK_SIZE) {
+			size_t bytesCount = (size_t)std::min<uint64_t>(MEMORY_CHUNK_SIZE, size - position);
+			saved = std::fwrite(chunks[position / MEMORY_CHUNK_SIZE], 1, bytesCount, file) == bytesCount;
+		}
+	}
+	saved = saved && std::fflush(file) == 0;
+#ifdef _WIN32
+	saved = saved && _commit(_fileno(file)) == 0;
+#else
+	saved = saved && ::fsync(fileno(file)) == 0;
+#endif
+	saved = (std::fclose(file) == 0) && saved;
+	if (saved) saved = std::rename(tempPath.c_str(), path) == 0;
+	if (!saved) std::remove(tempPath.c_str());
+	return saved;
+}
+
+
+/**
+*
+*  @brief Loads snapshot file to the arena
+*
+*  @param[in]  path    - snapshot file path
+*  @param[out] missing - true if snapshot file doesn't exist
+*
+*  @return true if snapshot loaded, false if file is missing or can't be read
+*
+*/
+bool MemoryBackend::load(const char* path, bool& missing) {
+	std::FILE* file = std::fopen(path, "rb");
+	missing = (file == nullptr && errno == ENOENT);
+	if (file == nullptr) return false;
+	uint64_t size = 0;
+	bool loaded = true;
+	for (;;) {
+		if (!reserve(size + MEMORY_CHUNK_SIZE)) {
+			loaded = false;
+			break;
+		}
+		size_t bytesRead = std::fread(chunks[size / MEMORY_CHUNK_SIZE], 1, MEMORY_CHUNK_SIZE, file);
+		size += bytesRead;
+		if (bytesRead < MEMORY_CHUNK_SIZE) {
+			loaded = std::ferror(file) == 0;
+			break;
+		}
+	}
+	std::fclose(file);
+	this->dataSize = size;
+	return loaded;
+}
+
+
+/**
+*
+*  @brief Grows chunks table to hold data up to the size
+*
+*  @param[in] size - required arena size in bytes
+*
+*  @return true if arena is large enough, false if out of memory
+*
+*/
+bool MemoryBackend::reserve(uint64_t size) {
+	size_t chunksCount = size_t((size + MEMORY_CHUNK_SIZE - 1) / MEMORY_CHUNK_SIZE);
+	{
+		std::shared_lock<std::shared_mutex> lock(arenaMutex);
+		if (chunks.size() >= chunksCount) return true;
+	}
+	std::unique_lock<std::shared_mutex> lock(arenaMutex);
+	while (chunks.size() < chunksCount) {
+		uint8_t* chunk = (uint8_t*)std::calloc(1, MEMORY_CHUNK_SIZE);
+		if (chunk == nullptr) return false;
+		chunks.push_back(chunk);
+	}
+	return true;
+}
+
+
+/**
+*  @brief Releases all arena chunks
+*/
+void MemoryBackend::release() {
+	std::unique_lock<std::shared_mutex> lock(arenaMutex);
+	for (uint8_t* chunk : chunks) std::free(chunk);
+	chunks.clear();
+	chunks.shrink_to_fit();
+	this->dataSize = 0;
+}
@@ -0,0 +1,160 @@
+/******************************************************************************
+*
+*  MissRatioCurve class implementation
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "MissRatioCurve.h"
+
+#include <algorithm>
+
+using namespace Boson;
+
+constexpr uint64_t MRC_TIME_SLOTS = MRC_MAX_SAMPLES * 4;  // Access times before compaction
+
+
+/**
+* @brief Constructor (curve is empty until initialized)
+*/
+MissRatioCurve::MissRatioCurve() {
+	this->threshold = 0;
+	this->bucketPages = 1;
+	this->clock = 0;
+	this->totalWeight = 0;
+}
+
+
+/**
+*
+*  @brief Clears the curve and sets its size range
+*
+*  @param[in] maxPages - largest cache size curve is estimated for (pages)
+*
+*/
+void MissRatioCurve::init(size_t maxPages) {
+	this->threshold = MRC_HASH_MODULUS / MRC_INITIAL_RATE;
+	this->bucketPages = std::max<uint64_t>((maxPages + MRC_BUCKETS - 1) / MRC_BUCKETS, 1);
+	this->clock = 0;
+	this->totalWeight = 0;
+	tree.assign(MRC_TIME_SLOTS + 1, 0);
+	histogram.assign(MRC_BUCKETS + 1, 0.0);
+	lastAccess.clear();
+}
+
+
+/**
+*
+*  @brief Counts access of sampled page: reuse distance is the number of
+*  distinct sampled pages accessed since previous access of the page, first
+*  access is counted as cold miss (last histogram bucket)
+*
+*  @param[in] filePageNo - accessed file page number
+*
+*/
+void MissRatioCurve::record(size_t filePageNo) {
+	if (tree.empty() || !isSampled(filePageNo)) return;
+	double scale = double(MRC_HASH_MODULUS) / double(threshold.load());
+	if (++clock > MRC_TIME_SLOTS) compactTimes();
+	auto entry = lastAccess.find(filePageNo);
+	if (entry != lastAccess.end()) {
+		uint64_t previousTime = entry->second;
+		uint64_t distance = treeSum(clock - 1) - treeSum(previousTime);
+		uint64_t bucket = uint64_t(double(distance) * scale) / bucketPages;
+		histogram[std::min<uint64_t>(bucket, MRC_BUCKETS)] += scale;
+		treeAdd(previousTime, -1);
+		entry->second = clock;
+	} else {
+		histogram[MRC_BUCKETS] += scale;
+		lastAccess[filePageNo] = clock;
+	}
+	treeAdd(clock, 1);
+	totalWeight += scale;
+	if (lastAccess.size() > MRC_MAX_SAMPLES) lowerThreshold();
+}
+
+
+/**
+*
+*  @brief Estimates LRU miss ratio of the cache size
+*
+*  @param[in] cachePages - cache size (pages)
+*
+*  @return miss ratio (0..1) or 1 if no accesses have been sampled
+*
+*/
+double MissRatioCurve::missRatio(size_t cachePages) {
+	if (totalWeight <= 0) return 1.0;
+	// access hits if its reuse distance is less than cache size
+	double hits = 0;
+	uint64_t fullBuckets = std::min<uint64_t>(cachePages / bucketPages, MRC_BUCKETS);
+	for (uint64_t i = 0; i < fullBuckets; i++) hits += histogram[i];
+	if (fullBuckets < MRC_BUCKETS) {
+		double share = double(cachePages - fullBuckets * bucketPages) / double(bucketPages);
+		hits += histogram[fullBuckets] * share;
+	}
+	return std::max(0.0, 1.0 - hits / totalWeight);
+}
+
+
+/**
+*  @brief Halves accumulated accesses, so the curve follows workload changes
+*/
+void MissRatioCurve::age() {
+	for (double& weight : histogram) weight /= 2;
+	totalWeight /= 2;
+}
+
+
+/**
+*  @brief Adds delta to access time counter of Fenwick tree
+*/
+void MissRatioCurve::treeAdd(uint64_t time, int32_t delta) {
+	for (; time <= MRC_TIME_SLOTS; time += time & (~time + 1)) tree[time] += delta;
+}
+
+
+/**
+*  @brief Returns count of tracked pages last accessed at or before the time
+*/
+uint64_t MissRatioCurve::treeSum(uint64_t time) {
+	int64_t sum = 0;
+	for (; time > 0; time -= time & (~time + 1)) sum += tree[time];
+	return uint64_t(sum);
+}
+
+
+/**
+*
+*  @brief Renumbers last access times of tracked pages from 1 keeping their
+*  order, so access clock continues within Fenwick tree range
+*
+*/
+void MissRatioCurve::compactTimes() {
+	std::vector<std::pair<uint64_t, size_t>> order;
+	order.reserve(lastAccess.size());
+	for (auto& entry : lastAccess) order.emplace_back(entry.second, entry.first);
+	std::sort(order.begin(), order.end());
+	std::fill(tree.begin(), tree.end(), 0);
+	uint64_t time = 0;
+	for (auto& item : order) {
+		lastAccess[item.second] = ++time;
+		treeAdd(time, 1);
+	}
+	clock = time + 1;
+}
+
+
+/**
+*  @brief Halves sampling threshold and stops tracking pages above it
+*/
+void MissRatioCurve::lowerThreshold() {
+	threshold = std::max<uint64_t>(threshold.load() / 2, 1);
+	for (auto entry = lastAccess.begin(); entry != lastAccess.end();) {
+		if (!isSampled(entry->first)) {
+			treeAdd(entry->second, -1);
+			entry = lastAccess.erase(entry);
+		} else entry++;
+	}
+}
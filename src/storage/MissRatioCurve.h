@@ -0,0 +1,75 @@
+/******************************************************************************
+*
+*  MissRatioCurve class header
+*
+*  MissRatioCurve estimates LRU cache miss ratio for every cache size from
+*  the stream of page accesses (SHARDS, C. Waldspurger et al., 2015). Only
+*  pages whose hash is below sampling threshold are tracked, reuse distance
+*  of sampled access (distinct sampled pages accessed since previous access
+*  of the same page) is counted with Fenwick tree over access times and is
+*  scaled by sampling rate. When tracked pages exceed the limit, threshold
+*  is halved and pages above it are dropped (fixed size SHARDS), so memory
+*  and time overhead do not depend on the file size.
+*
+*  isSampled() may be called concurrently, other calls are serialized by
+*  CachedFileIO.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <atomic>
+#include <unordered_map>
+
+namespace Boson {
+
+	constexpr uint64_t MRC_HASH_MODULUS  = 1 << 24;  // Sampling hash space
+	constexpr uint64_t MRC_INITIAL_RATE  = 8;        // Initial sampling (1 of N pages)
+	constexpr uint64_t MRC_MAX_SAMPLES   = 8192;     // Maximum tracked sampled pages
+	constexpr uint64_t MRC_BUCKETS       = 64;       // Reuse distance histogram buckets
+
+	//-------------------------------------------------------------------------
+	// Sampled LRU miss ratio curve (reuse distance histogram)
+	//-------------------------------------------------------------------------
+	class MissRatioCurve {
+	public:
+		MissRatioCurve();
+		void   init(size_t maxPages);
+		void   record(size_t filePageNo);
+		double missRatio(size_t cachePages);
+		void   age();
+
+		/**
+		*  @brief Checks if page accesses are sampled (page hash below threshold)
+		*/
+		inline bool isSampled(size_t filePageNo) {
+			return pageHash(filePageNo) < threshold.load(std::memory_order_relaxed);
+		}
+
+	private:
+		static inline uint64_t pageHash(size_t filePageNo) {
+			uint64_t h = uint64_t(filePageNo) + 0x9E3779B97F4A7C15ull;
+			h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+			h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+			return (h ^ (h >> 31)) & (MRC_HASH_MODULUS - 1);
+		}
+		void     treeAdd(uint64_t time, int32_t delta);
+		uint64_t treeSum(uint64_t time);
+		void     compactTimes();
+		void     lowerThreshold();
+
+		std::atomic<uint64_t> threshold;          // Sampling hash threshold
+		uint64_t bucketPages;                     // Reuse distance per bucket (pages)
+		uint64_t clock;                           // Last sampled access time
+		double   totalWeight;                     // Scaled sampled accesses count
+		std::vector<int32_t>  tree;               // Fenwick tree of last access times
+		std::vector<double>   histogram;          // Scaled accesses per distance bucket
+		std::unordered_map<size_t, uint64_t> lastAccess; // Page No. -> last access time
+	};
+
+}
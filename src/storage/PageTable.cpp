@@ -0,0 +1,152 @@
+/******************************************************************************
+*
+*  PageTable class implementation
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "PageTable.h"
+
+using namespace Boson;
+
+
+/**
+* @brief Constructor (table has no slots until initialized)
+*/
+PageTable::PageTable() {
+	this->slots = nullptr;
+	this->mask = 0;
+	this->shift = 64;
+	this->count = 0;
+}
+
+
+/**
+*
+*  @brief Returns slots count required for the capacity: power of 2 at
+*  least twice as large as capacity, so table is at most half full
+*
+*  @param[in] capacity - maximum entries count
+*
+*  @return slots count
+*
+*/
+size_t PageTable::slotsFor(size_t capacity) {
+	size_t slotsCount = 16;
+	while (slotsCount < capacity * 2) slotsCount *= 2;
+	return slotsCount;
+}
+
+
+/**
+*
+*  @brief Attaches table to slots array and marks all slots empty
+*
+*  @param[in] slots      - slots array (owned by caller)
+*  @param[in] slotsCount - slots count (power of 2, see slotsFor())
+*
+*/
+void PageTable::init(PageTableSlot* slots, size_t slotsCount) {
+	this->slots = slots;
+	this->mask = slotsCount - 1;
+	this->shift = 64;
+	for (size_t n = slotsCount; n > 1; n >>= 1) this->shift--;
+	this->count = 0;
+	for (size_t i = 0; i < slotsCount; i++) {
+		slots[i].filePageNo = EMPTY_SLOT;
+		slots[i].page = nullptr;
+	}
+}
+
+
+/**
+*
+*  @brief Rehashes entries to the new slots array (table growth)
+*
+*  @param[in] slots      - new slots array (owned by caller)
+*  @param[in] slotsCount - slots count (power of 2, at least current count)
+*
+*/
+void PageTable::moveTo(PageTableSlot* slots, size_t slotsCount) {
+	PageTableSlot* oldSlots = this->slots;
+	size_t oldSlotsCount = size_t(mask + 1);
+	init(slots, slotsCount);
+	if (oldSlots == nullptr) return;
+	for (size_t i = 0; i < oldSlotsCount; i++) {
+		if (oldSlots[i].filePageNo != EMPTY_SLOT) insert(oldSlots[i].filePageNo, oldSlots[i].page);
+	}
+}
+
+
+
+/**
+*
+*  @brief Inserts file page or replaces its cached page
+*
+*  @param[in] filePageNo - file page number
+*  @param[in] page       - cached page
+*
+*/
+void PageTable::insert(uint64_t filePageNo, CachePage* page) {
+	size_t index = slotIndex(filePageNo);
+	while (slots[index].filePageNo != EMPTY_SLOT) {
+		if (slots[index].filePageNo == filePageNo) {
+			slots[index].page = page;
+			return;
+		}
+		index = (index + 1) & mask;
+	}
+	slots[index].filePageNo = filePageNo;
+	slots[index].page = page;
+	count++;
+}
+
+
+/**
+*
+*  @brief Erases file page from the table. Following entries of the probe
+*  chain are shifted back to the freed slot (no tombstones left).
+*
+*  @param[in] filePageNo - file page number
+*
+*  @return true if file page has been in the table, false otherwise
+*
+*/
+bool PageTable::erase(uint64_t filePageNo) {
+	size_t index = slotIndex(filePageNo);
+	while (slots[index].filePageNo != filePageNo) {
+		if (slots[index].filePageNo == EMPTY_SLOT) return false;
+		index = (index + 1) & mask;
+	}
+	size_t next = (index + 1) & mask;
+	while (slots[next].filePageNo != EMPTY_SLOT) {
+		// entry moves to the hole if its home slot is not between hole and entry
+		size_t home = slotIndex(slots[next].filePageNo);
+		if (((next - home) & mask) >= ((next - index) & mask)) {
+			slots[index] = slots[next];
+			index = next;
+		}
+		next = (next + 1) & mask;
+	}
+	slots[index].filePageNo = EMPTY_SLOT;
+	slots[index].page = nullptr;
+	count--;
+	return true;
+}
+
+
+
+/**
+*
+*  @brief Appends all cached pages of the table (in slots order)
+*
+*  @param[out] pages - cached pages
+*
+*/
+void PageTable::getPages(std::vector<CachePage*>& pages) {
+	if (slots == nullptr) return;
+	for (size_t i = 0; i <= mask; i++) {
+		if (slots[i].filePageNo != EMPTY_SLOT) pages.push_back(slots[i].page);
+	}
+}
@@ -0,0 +1,76 @@
+/******************************************************************************
+*
+*  PageTable class header
+*
+*  PageTable maps file page numbers to cached pages of CachedFileIO
+*  partition. It is a flat power of two array of slots with linear probing
+*  (open addressing): lookup is a multiplicative hash and a scan of few
+*  adjacent slots in the same CPU cache line, without bucket pointers and
+*  heap allocated nodes. Table is at most half full, erased entries are
+*  shifted back, so probe chains have no tombstones.
+*
+*  Slots memory is owned by CachedFileIO (one pool for all partitions, or
+*  growable per partition arrays when file uses shared buffer pool).
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Boson {
+
+	class CachePage;
+
+	constexpr uint64_t EMPTY_SLOT = UINT64_MAX;   // Empty slot file page No.
+
+	typedef struct {                            // Page table slot
+		uint64_t   filePageNo;                  // File page No. (EMPTY_SLOT if free)
+		CachePage* page;                        // Cached page
+	} PageTableSlot;
+
+	//-------------------------------------------------------------------------
+	// Open addressing (linear probing) table: file page No. -> CachePage*
+	//-------------------------------------------------------------------------
+	class PageTable {
+	public:
+		PageTable();
+		static size_t slotsFor(size_t capacity);
+		void       init(PageTableSlot* slots, size_t slotsCount);
+		void       moveTo(PageTableSlot* slots, size_t slotsCount);
+		void       insert(uint64_t filePageNo, CachePage* page);
+		bool       erase(uint64_t filePageNo);
+		void       getPages(std::vector<CachePage*>& pages);
+		size_t     size() { return count; }
+		size_t     capacity() { return size_t(mask + 1) / 2; }
+
+		/**
+		*  @brief Looks up cached page of file page
+		*  @return cached page or nullptr if file page is not in the table
+		*/
+		inline CachePage* find(uint64_t filePageNo) {
+			size_t index = slotIndex(filePageNo);
+			for (;;) {
+				PageTableSlot& slot = slots[index];
+				if (slot.filePageNo == filePageNo) return slot.page;
+				if (slot.filePageNo == EMPTY_SLOT) return nullptr;
+				index = (index + 1) & mask;
+			}
+		}
+
+	private:
+		inline size_t slotIndex(uint64_t filePageNo) {
+			return size_t((filePageNo * 0x9E3779B97F4A7C15ull) >> shift);
+		}
+
+		PageTableSlot* slots;                    // Slots array (power of 2)
+		uint64_t       mask;                     // Slot index mask
+		uint32_t       shift;                    // Hash shift to get slot index
+		size_t         count;                    // Occupied slots count
+	};
+
+}
@@ -0,0 +1,358 @@
+/******************************************************************************
+*
+*  PosixBackend class implementation
+*
+*  Native Linux/POSIX storage backend. Pages are transferred with
+*  pread/pwrite on raw file descriptor: single system call per page
+*  and no shared file position, so calls can be issued concurrently.
+*
+*  Writes past preallocated space reserve next chunk of file space with
+*  fallocate (FALLOC_FL_KEEP_SIZE): file grows by few large extents
+*  instead of page sized ones, while file size stays exact. Unused
+*  preallocated tail is released on close.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#ifndef _WIN32
+
+#include "StorageBackend.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+using namespace Boson;
+
+
+/**
+* @brief Constructor
+*/
+PosixBackend::PosixBackend() {
+	this->fileDescriptor = -1;
+	this->preallocatedEnd = 0;
+	this->growthIncrement = FILE_GROWTH_INCREMENT;
+	this->growthPercent = FILE_GROWTH_PERCENT;
+}
+
+
+/**
+* @brief Destructor closes file if it still open
+*/
+PosixBackend::~PosixBackend() {
+	this->close();
+}
+
+
+/**
+*
+*  @brief Opens existing file or creates new one (if write permitted)
+*
+*  @param[in] path     - the name of the file to be opened (path)
+*  @param[in] readOnly - if true, file is opened for reading only
+*
+*  @return true if file opened, false if can't open file
+*
+*/
+bool PosixBackend::open(const char* path, bool readOnly) {
+	if (path == nullptr) return false;
+	if (this->fileDescriptor >= 0) close();
+	int flags = readOnly ? O_RDONLY : (O_RDWR | O_CREAT);
+	do {
+		this->fileDescriptor = ::open(path, flags | O_CLOEXEC, 0644);
+	} while (this->fileDescriptor < 0 && errno == EINTR);
+	this->preallocatedEnd = getSize();
+	return this->fileDescriptor >= 0;
+}
+
+
+/**
+*  @brief Closes file descriptor
+*  @return true if file closed, false if file has not been opened
+*/
+bool PosixBackend::close() {
+	if (this->fileDescriptor < 0) return false;
+	trimPreallocated();
+	::close(this->fileDescriptor);
+	this->fileDescriptor = -1;
+	return true;
+}
+
+
+/**
+*  @brief Checks if file is open
+*  @return true - if file open, false - otherwise
+*/
+bool PosixBackend::isOpen() {
+	return this->fileDescriptor >= 0;
+}
+
+
+/**
+*
+*  @brief Reads data at given offset of the file (single pread in common case)
+*
+*  @param[in]  offset - offset from beginning of the file
+*  @param[out] buffer - data buffer where data copied
+*  @param[in]  length - data amount to read
+*
+*  @return bytes actually read (less than length at the end of file)
+*
+*/
+size_t PosixBackend::read(uint64_t offset, void* buffer, size_t length) {
+	if (this->fileDescriptor < 0) return 0;
+	uint8_t* dst = (uint8_t*)buffer;
+	size_t bytesRead = 0;
+	// repeat on short reads and signal interruptions until EOF or error
+	while (bytesRead < length) {
+		ssize_t result = ::pread(this->fileDescriptor, dst + bytesRead,
+			length - bytesRead, (off_t)(offset + bytesRead));
+		if (result < 0 && errno == EINTR) continue;
+		if (result <= 0) break;
+		bytesRead += (size_t)result;
+	}
+	return bytesRead;
+}
+
+
+/**
+*
+*  @brief Reads contiguous file range into several buffers with single
+*  preadv call in common case (repeats on short reads and interruptions)
+*
+*  @param[in] offset  - offset from beginning of the file
+*  @param[in] buffers - destination buffers in file order
+*  @param[in] count   - buffers count
+*
+*  @return total bytes actually read (stops at end of file)
+*
+*/
+size_t PosixBackend::readVector(uint64_t offset, const IOBuffer* buffers, size_t count) {
+	if (this->fileDescriptor < 0) return 0;
+	std::vector<struct iovec> vectors(count);
+	for (size_t i = 0; i < count; i++) {
+		vectors[i].iov_base = buffers[i].data;
+		vectors[i].iov_len = buffers[i].length;
+	}
+	size_t totalRead = 0;
+	size_t index = 0;
+	while (index < count) {
+		int vectorsCount = (int)std::min<size_t>(count - index, IOV_MAX);
+		ssize_t result = ::preadv(this->fileDescriptor, &vectors[index], vectorsCount, (off_t)(offset + totalRead));
+		if (result < 0 && errno == EINTR) continue;
+		if (result <= 0) break;
+		totalRead += (size_t)result;
+		// skip completely read buffers and shift partially read one
+		size_t consumed = (size_t)result;
+		while (index < count && consumed >= vectors[index].iov_len) {
+			consumed -= vectors[index].iov_len;
+			index++;
+		}
+		if (consumed > 0) {
+			vectors[index].iov_base = (uint8_t*)vectors[index].iov_base + consumed;
+			vectors[index].iov_len -= consumed;
+		}
+	}
+	return totalRead;
+}
+
+
+/**
+*
+*  @brief Writes data at given offset of the file (single pwrite in common case)
+*
+*  @param[in] offset - offset from beginning of the file
+*  @param[in] buffer - data buffer with write data
+*  @param[in] length - data amount to write
+*
+*  @return bytes actually written
+*
+*/
+size_t PosixBackend::write(uint64_t offset, const void* buffer, size_t length) {
+	if (this->fileDescriptor < 0) return 0;
+	preallocate(offset + length);
+	const uint8_t* src = (const uint8_t*)buffer;
+	size_t bytesWritten = 0;
+	// repeat on short writes and signal interruptions until done or error
+	while (bytesWritten < length) {
+		ssize_t result = ::pwrite(this->fileDescriptor, src + bytesWritten,
+			length - bytesWritten, (off_t)(offset + bytesWritten));
+		if (result < 0 && errno == EINTR) continue;
+		if (result <= 0) break;
+		bytesWritten += (size_t)result;
+	}
+	return bytesWritten;
+}
+
+
+
+/**
+*
+*  @brief Writes several buffers to contiguous file range with single
+*  pwritev call in common case (repeats on short writes and interruptions)
+*
+*  @param[in] offset  - offset from beginning of the file
+*  @param[in] buffers - source buffers in file order
+*  @param[in] count   - buffers count
+*
+*  @return total bytes actually written
+*
+*/
+size_t PosixBackend::writeVector(uint64_t offset, const IOBuffer* buffers, size_t count) {
+	if (this->fileDescriptor < 0) return 0;
+	std::vector<struct iovec> vectors(count);
+	uint64_t endOffset = offset;
+	for (size_t i = 0; i < count; i++) {
+		vectors[i].iov_base = buffers[i].data;
+		vectors[i].iov_len = buffers[i].length;
+		endOffset += buffers[i].length;
+	}
+	preallocate(endOffset);
+	size_t totalWritten = 0;
+	size_t index = 0;
+	while (index < count) {
+		int vectorsCount = (int)std::min<size_t>(count - index, IOV_MAX);
+		ssize_t result = ::pwritev(this->fileDescriptor, &vectors[index], vectorsCount, (off_t)(offset + totalWritten));
+		if (result < 0 && errno == EINTR) continue;
+		if (result <= 0) break;
+		totalWritten += (size_t)result;
+		// skip completely written buffers and shift partially written one
+		size_t consumed = (size_t)result;
+		while (index < count && consumed >= vectors[index].iov_len) {
+			consumed -= vectors[index].iov_len;
+			index++;
+		}
+		if (consumed > 0) {
+			vectors[index].iov_base = (uint8_t*)vectors[index].iov_base + consumed;
+			vectors[index].iov_len -= consumed;
+		}
+	}
+	return totalWritten;
+}
+
+
+/**
+*  @brief Persists written data to storage device (fdatasync)
+*  @return true if succeeded, false otherwise
+*/
+bool PosixBackend::sync() {
+	if (this->fileDescriptor < 0) return false;
+#ifdef __APPLE__
+	return ::fsync(this->fileDescriptor) == 0;
+#else
+	return ::fdatasync(this->fileDescriptor) == 0;
+#endif
+}
+
+
+/**
+*  @brief Advises kernel about expected access pattern (posix_fadvise)
+*  @param[in] pattern - expected access pattern
+*  @return true if advice accepted, false otherwise
+*/
+bool PosixBackend::advise(AccessPattern pattern) {
+	if (this->fileDescriptor < 0) return false;
+#ifdef POSIX_FADV_NORMAL
+	int advice = POSIX_FADV_NORMAL;
+	if (pattern == AccessPattern::RANDOM_ACCESS) advice = POSIX_FADV_RANDOM;
+	if (pattern == AccessPattern::SEQUENTIAL_ACCESS) advice = POSIX_FADV_SEQUENTIAL;
+	return ::posix_fadvise(this->fileDescriptor, 0, 0, advice) == 0;
+#else
+	return false;
+#endif
+}
+
+
+/**
+*
+*  @brief Sets file growth policy: file space is preallocated in chunks of
+*  the larger of increment and percent of file size (0, 0 disables it)
+*
+*  @param[in] increment - minimal preallocation chunk (bytes)
+*  @param[in] percent   - preallocation chunk share of file size (0..1)
+*
+*  @return true if file space can be preallocated on this platform
+*
+*/
+bool PosixBackend::setGrowthPolicy(uint64_t increment, double percent) {
+	std::lock_guard<std::mutex> lock(growthMutex);
+	this->growthIncrement = increment;
+	this->growthPercent = std::max(percent, 0.0);
+#ifdef __linux__
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+/**
+*
+*  @brief Preallocates next chunk of file space if write ends past
+*  preallocated space. File size is not changed (FALLOC_FL_KEEP_SIZE),
+*  preallocation is turned off if file system does not support it.
+*
+*  @param[in] endOffset - end of written range
+*
+*/
+void PosixBackend::preallocate(uint64_t endOffset) {
+#ifdef __linux__
+	if (endOffset <= preallocatedEnd.load(std::memory_order_relaxed)) return;
+	std::lock_guard<std::mutex> lock(growthMutex);
+	uint64_t allocatedEnd = preallocatedEnd.load();
+	if (endOffset <= allocatedEnd) return;
+	uint64_t chunk = std::max(growthIncrement, uint64_t(double(endOffset) * growthPercent));
+	chunk = std::min(chunk, FILE_GROWTH_MAX_CHUNK);
+	if (chunk == 0) return;
+	uint64_t newEnd = (endOffset + chunk + DIRECT_IO_ALIGNMENT - 1) & ~uint64_t(DIRECT_IO_ALIGNMENT - 1);
+	int result;
+	do {
+		result = ::fallocate(this->fileDescriptor, FALLOC_FL_KEEP_SIZE, (off_t)allocatedEnd, (off_t)(newEnd - allocatedEnd));
+	} while (result != 0 && errno == EINTR);
+	if (result != 0) {
+		// not supported or no space: write allocates blocks itself
+		growthIncrement = 0;
+		growthPercent = 0;
+		return;
+	}
+	preallocatedEnd = newEnd;
+#endif
+}
+
+
+/**
+*  @brief Releases preallocated file space past the end of file
+*/
+void PosixBackend::trimPreallocated() {
+	std::lock_guard<std::mutex> lock(growthMutex);
+	uint64_t fileSize = getSize();
+	// truncate to the same size drops blocks allocated beyond end of file
+	if (preallocatedEnd.load() > fileSize) {
+		if (::ftruncate(this->fileDescriptor, (off_t)fileSize) != 0) return;
+	}
+	preallocatedEnd = fileSize;
+}
+
+
+/**
+*  @brief Get current file size
+*  @return actual file size in bytes
+*/
+uint64_t PosixBackend::getSize() {
+	if (this->fileDescriptor < 0) return 0;
+	struct stat fileStats;
+	if (::fstat(this->fileDescriptor, &fileStats) != 0) return 0;
+	return (uint64_t)fileStats.st_size;
+}
+
+#endif
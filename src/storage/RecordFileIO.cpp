@@ -26,6 +26,35 @@
 
 using namespace Boson;
 
+
+/**
+*  @brief Returns index of the highest set bit of non-zero value
+*/
+static constexpr uint32_t highestBit(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+	return 31 - __builtin_clz(value);
+#else
+	uint32_t bit = 0;
+	while ((value >> bit) > 1) bit++;
+	return bit;
+#endif
+}
+
+
+/**
+*  @brief Returns index of the lowest set bit of non-zero value
+*/
+static constexpr uint32_t lowestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+	return uint32_t(__builtin_ctzll(value));
+#else
+	uint32_t bit = 0;
+	while (((value >> bit) & 1) == 0) bit++;
+	return bit;
+#endif
+}
+
+
 /*
 * 
 * @brief RecordFileIO constructor and initializations
@@ -41,10 +70,18 @@ RecordFileIO::RecordFileIO(CachedFileIO& cachedFile, size_t freeDepth) : cachedF
 		throw std::runtime_error(msg);
 	}
 	// Initialize internal data structures and variables to zero
-	memset(&storageHeader, 0, sizeof StorageHeader);
-	memset(&recordHeader, 0, sizeof RecordHeader);
+	memset(&storageHeader, 0, sizeof(StorageHeader));
+	memset(&recordHeader, 0, sizeof(RecordHeader));
 	currentPosition = NOT_FOUND;
 	freeLookupDepth = freeDepth;
+	freeClassMask = 0;
+	checksumFunction = Checksum::get(ADLER32_CHECKSUM);
+	verifyPolicy = VERIFY_ALWAYS;
+	verifySamplePeriod = VERIFY_SAMPLE_PERIOD;
+	verifyReads = 0;
+	scrubPosition = NOT_FOUND;
+	headerDirty = false;
+	resetStats();
 	// If file is empty and write is permitted, then write storage header
 	if (cachedFile.getFileSize() == 0 && !cachedFile.isReadOnly()) {
 		initStorageHeader();
@@ -55,6 +92,14 @@ RecordFileIO::RecordFileIO(CachedFileIO& cachedFile, size_t freeDepth) : cachedF
 		std::cerr << msg;
 		throw std::runtime_error(msg);
 	}
+	// Upgrade version 1 file to size class free lists
+	if (storageHeader.version == BOSONDB_LEGACY_VERSION && !cachedFile.isReadOnly()) {
+		if (!upgradeLegacyFile()) {
+			const char* msg = "ERROR: Can't upgrade version 1 storage file.\n";
+			std::cerr << msg;
+			throw std::runtime_error(msg);
+		}
+	}
 }
 
 
@@ -65,12 +110,31 @@ RecordFileIO::RecordFileIO(CachedFileIO& cachedFile, size_t freeDepth) : cachedF
 *
 */
 RecordFileIO::~RecordFileIO() {
-	if (!cachedFile.isOpen()) return;	
-	persistStorageHeader();
-	cachedFile.flush();
+	flush();
+}
+
+
+/**
+*
+* @brief Persists storage header if it has been changed and flushes changed
+* cache pages (header is kept in memory between flushes)
+* @param[in] maxPages - maximum pages to flush (incremental checkpoint)
+* @return true - if succeeded, false - if file is not open, page write or
+* storage device sync failed
+*
+*/
+bool RecordFileIO::flush(size_t maxPages) {
+	if (!cachedFile.isOpen()) return false;
+	if (cachedFile.isReadOnly()) return true;
+	if (headerDirty && !persistStorageHeader()) return false;
+	if (maxPages == NOT_FOUND) return cachedFile.flush() != 0;
+	bool succeeded = false;
+	cachedFile.flush(maxPages, succeeded);
+	return succeeded;
 }
 
 
+
 /**
 * @brief Checks if file is open 
 * @return true if file is open, or false otherwise
@@ -104,6 +168,130 @@ uint64_t RecordFileIO::getTotalFreeRecords() {
 
 
 
+/*
+*
+* @brief Get checksum algorithm of records
+* @return checksum algorithm recorded in the storage header
+*
+*/
+ChecksumType RecordFileIO::getChecksumType() {
+	return ChecksumType(storageHeader.checksumType);
+}
+
+
+
+/*
+*
+* @brief Sets data checksum verification policy of reads
+* @param[in] policy - verification policy
+* @param[in] samplePeriod - reads per verified read (VERIFY_SAMPLED)
+*
+*/
+void RecordFileIO::setChecksumVerify(ChecksumVerifyPolicy policy, uint64_t samplePeriod) {
+	verifyPolicy = policy;
+	verifySamplePeriod = std::max<uint64_t>(samplePeriod, 1);
+	verifyReads = 0;
+	if (policy == VERIFY_ON_LOAD) {
+		verifiedTable.assign(VERIFIED_RECORDS_SLOTS, VerifiedRecord{ NOT_FOUND, 0 });
+	} else verifiedTable.clear();
+}
+
+
+
+/*
+*
+* @brief Get data checksum verification policy of reads
+* @return verification policy
+*
+*/
+ChecksumVerifyPolicy RecordFileIO::getChecksumVerify() {
+	return verifyPolicy;
+}
+
+
+
+/*
+*
+* @brief Verifies header and data checksums of next records, continues
+* from the record where previous call stopped (incremental background
+* check, call it between other calls like any RecordFileIO method). Pass
+* stops at the last record, next call starts from the first one.
+* @param[in] maxRecords - maximum records to check
+* @return records checked
+*
+*/
+uint64_t RecordFileIO::scrub(uint64_t maxRecords) {
+	if (!cachedFile.isOpen()) return 0;
+	RecordHeader header;
+	std::vector<uint8_t> data;
+	uint64_t checked = 0;
+	while (checked < maxRecords) {
+		if (scrubPosition == NOT_FOUND) scrubPosition = storageHeader.firstRecord;
+		if (scrubPosition == NOT_FOUND) break;
+		checked++;
+		scrubbedRecords++;
+		// records chain can't be followed after corrupted header
+		if (getRecordHeader(scrubPosition, header) == NOT_FOUND) {
+			checksumFailures++;
+			scrubPosition = NOT_FOUND;
+			break;
+		}
+		data.resize(header.dataLength);
+		uint64_t loadStamp;
+		uint64_t bytesRead = readData(scrubPosition + sizeof(RecordHeader), data.data(), data.size(), loadStamp);
+		if (bytesRead == data.size() && checksum(data.data(), data.size()) == header.dataChecksum) {
+			verifiedRecords++;
+			verifiedBytes += bytesRead;
+		} else checksumFailures++;
+		scrubPosition = header.next;
+		if (scrubPosition == NOT_FOUND) break;
+	}
+	return checked;
+}
+
+
+
+/*
+*
+* @brief Get checksum verification stats
+* @param[in] type - requested stats type
+* @return value of stats
+*
+*/
+double RecordFileIO::getStats(RecordFileStats type) {
+	switch (type) {
+	case RecordFileStats::VERIFIED_RECORDS:
+		return double(verifiedRecords);
+	case RecordFileStats::VERIFIED_BYTES:
+		return double(verifiedBytes);
+	case RecordFileStats::UNVERIFIED_BYTES:
+		return double(unverifiedBytes);
+	case RecordFileStats::CHECKSUM_FAILURES:
+		return double(checksumFailures);
+	case RecordFileStats::SCRUBBED_RECORDS:
+		return double(scrubbedRecords);
+	default:
+		return 0;
+	}
+}
+
+
+
+/*
+*
+* @brief Resets checksum verification stats
+*
+*/
+void RecordFileIO::resetStats() {
+	verifiedRecords = 0;
+	verifiedBytes = 0;
+	unverifiedBytes = 0;
+	checksumFailures = 0;
+	scrubbedRecords = 0;
+}
+
+
+
 /*
 *
 * @brief Set cursor position
@@ -118,7 +306,7 @@ bool RecordFileIO::setPosition(uint64_t offset) {
 	if (getRecordHeader(offset, header)==NOT_FOUND) return false;
 	
 	// If everything is ok - copy to internal buffer
-	memcpy(&recordHeader, &header, sizeof RecordHeader);
+	memcpy(&recordHeader, &header, sizeof(RecordHeader));
 	currentPosition = offset;
 	return true;
 }
@@ -219,15 +407,16 @@ uint64_t RecordFileIO::createRecord(const void* data, uint32_t length) {
 	newRecordHeader.next = NOT_FOUND;                       
 	newRecordHeader.dataLength = length;
 	newRecordHeader.dataChecksum = checksum((uint8_t*) data, length);
-	uint32_t headerDataLength = sizeof RecordHeader - sizeof newRecordHeader.headChecksum;
+	uint32_t headerDataLength = sizeof(RecordHeader) - sizeof newRecordHeader.headChecksum;
 	newRecordHeader.headChecksum = checksum((uint8_t*)&newRecordHeader, headerDataLength);
 
 	// copy to working record
-	memcpy(&recordHeader, &newRecordHeader, sizeof RecordHeader);
+	memcpy(&recordHeader, &newRecordHeader, sizeof(RecordHeader));
 	currentPosition = offset;
+	forgetVerified(offset);
 
 	// Write record header and data to the storage file
-	constexpr uint64_t HEADER_SIZE = sizeof RecordHeader;
+	constexpr uint64_t HEADER_SIZE = sizeof(RecordHeader);
 	cachedFile.write(currentPosition, &recordHeader, HEADER_SIZE);
 	cachedFile.write(currentPosition + HEADER_SIZE, data, length);
 
@@ -252,6 +441,10 @@ uint64_t RecordFileIO::removeRecord() {
 	std::cout << "RecordFileIO: removing record at " << currentPosition << std::endl;
 #endif
 	
+	// scrub continues from the next record
+	if (scrubPosition == currentPosition) scrubPosition = recordHeader.next;
+	forgetVerified(currentPosition);
+
 	// check siblings
 	uint64_t leftSiblingOffset = recordHeader.previous;
 	uint64_t rightSiblingOffset = recordHeader.next;
@@ -297,7 +490,7 @@ uint64_t RecordFileIO::removeRecord() {
 	}
 	// Update storage header information about total records number
 	storageHeader.totalRecords--;
-	persistStorageHeader();
+	headerDirty = true;
 	return returnOffset;
 }
 
@@ -368,11 +561,49 @@ uint64_t RecordFileIO::getPrevPosition() {
 uint64_t RecordFileIO::getRecordData(void* data, uint32_t length) {
 	if (!cachedFile.isOpen() || currentPosition == NOT_FOUND || length==0) return NOT_FOUND;
 	uint64_t bytesToRead = std::min(recordHeader.dataLength, length);
-	uint64_t dataOffset = currentPosition + sizeof RecordHeader;
-	cachedFile.read(dataOffset, data, bytesToRead);
+	uint64_t dataOffset = currentPosition + sizeof(RecordHeader);
+	uint64_t loadStamp = 0;
+	// load stamps of pages are needed only to skip verified records
+	if (verifyPolicy == VERIFY_ON_LOAD) {
+		readData(dataOffset, (uint8_t*)data, bytesToRead, loadStamp);
+	} else cachedFile.read(dataOffset, data, bytesToRead);
+	// check data consistency by checksum
+	if (!verifyData((uint8_t*)data, bytesToRead, loadStamp)) return NOT_FOUND;
+	return currentPosition;
+}
+
+
+
+/**
+*
+* @brief Reads record data in current position to the string straight from
+* pinned cache pages (no intermediate buffer) and checks consistency
+*
+* @param[out] data - string to assign record data
+*
+* @return returns offset of the record or NOT_FOUND if data corrupted
+*
+*/
+uint64_t RecordFileIO::getRecordData(std::string& data) {
+	if (!cachedFile.isOpen() || currentPosition == NOT_FOUND) return NOT_FOUND;
+	uint64_t dataOffset = currentPosition + sizeof(RecordHeader);
+	uint64_t dataEnd = dataOffset + recordHeader.dataLength;
+	uint64_t loadStamp = 0;
+	bool stampKnown = true;
+	data.clear();
+	data.reserve(recordHeader.dataLength);
+	while (dataOffset < dataEnd) {
+		PageRef page = cachedFile.pin(dataOffset);
+		if (!page.isPinned()) break;
+		size_t bytesToCopy = std::min<uint64_t>(page.length(), dataEnd - dataOffset);
+		data.append((const char*)page.data(), bytesToCopy);
+		dataOffset += bytesToCopy;
+		stampKnown = stampKnown && page.loadStamp() != 0;
+		loadStamp = std::max(loadStamp, page.loadStamp());
+	}
 	// check data consistency by checksum
-	uint32_t dataCheckSum = checksum((uint8_t*)data, bytesToRead);
-	if (dataCheckSum != recordHeader.dataChecksum) return NOT_FOUND;
+	if (data.size() != recordHeader.dataLength) return NOT_FOUND;
+	if (!verifyData((const uint8_t*)data.data(), data.size(), stampKnown ? loadStamp : 0)) return NOT_FOUND;
 	return currentPosition;
 }
 
@@ -396,14 +627,15 @@ uint64_t RecordFileIO::setRecordData(const void* data, uint32_t length) {
 		currentPosition == NOT_FOUND) return NOT_FOUND;
 	// if there is enough capacity in record
 	if (length <= recordHeader.recordCapacity) {
+		forgetVerified(currentPosition);
 		// Update header data length info without affecting ID
 		recordHeader.dataLength = length;
 		// Update checksum
 		recordHeader.dataChecksum = checksum((uint8_t*)data, length);
-		uint32_t headerLength = sizeof RecordHeader - sizeof recordHeader.headChecksum;
+		uint32_t headerLength = sizeof(RecordHeader) - sizeof recordHeader.headChecksum;
 		recordHeader.headChecksum = checksum((uint8_t*) &recordHeader, headerLength);
 		// Write record header and data to the storage file
-		constexpr uint64_t HEADER_SIZE = sizeof RecordHeader;
+		constexpr uint64_t HEADER_SIZE = sizeof(RecordHeader);
 		cachedFile.write(currentPosition, &recordHeader, HEADER_SIZE);
 		cachedFile.write(currentPosition + HEADER_SIZE, data, length);
 
@@ -420,18 +652,20 @@ uint64_t RecordFileIO::setRecordData(const void* data, uint32_t length) {
 	newRecordHeader.previous = recordHeader.previous;
 	newRecordHeader.dataLength = length;
 	newRecordHeader.dataChecksum = checksum((uint8_t*)data, length);
-	uint32_t headerLength = sizeof RecordHeader - sizeof newRecordHeader.headChecksum;
+	uint32_t headerLength = sizeof(RecordHeader) - sizeof newRecordHeader.headChecksum;
 	newRecordHeader.headChecksum = checksum((uint8_t*)&newRecordHeader, headerLength);
 
 	// Delete old record and add it to the free records list
 	if (!putToFreeList(currentPosition)) return NOT_FOUND;
+	forgetVerified(currentPosition);
+	if (scrubPosition == currentPosition) scrubPosition = offset;
 	// if this is first record, then update storage header
 	if (recordHeader.previous == NOT_FOUND) {
 		storageHeader.firstRecord = offset;
-		persistStorageHeader();
+		headerDirty = true;
 	};
 	// Write record header and data to the storage file
-	constexpr uint64_t HEADER_SIZE = sizeof RecordHeader;
+	constexpr uint64_t HEADER_SIZE = sizeof(RecordHeader);
 	cachedFile.write(offset, &newRecordHeader, HEADER_SIZE);
 	cachedFile.write(offset + HEADER_SIZE, data, length);
 	// Update current record in memory
@@ -459,7 +693,7 @@ void RecordFileIO::initStorageHeader() {
 	
 	storageHeader.signature = BOSONDB_SIGNATURE;
 	storageHeader.version = BOSONDB_VERSION;
-	storageHeader.endOfFile = sizeof StorageHeader;
+	storageHeader.endOfFile = sizeof(StorageHeader);
 
 	storageHeader.totalRecords = 0;
 	storageHeader.firstRecord = NOT_FOUND;
@@ -469,6 +703,11 @@ void RecordFileIO::initStorageHeader() {
 	storageHeader.firstFreeRecord = NOT_FOUND;
 	storageHeader.lastFreeRecord = NOT_FOUND;
 
+	storageHeader.pageSize = PAGE_SIZE;
+	storageHeader.headerSize = sizeof(StorageHeader);
+	std::fill(storageHeader.freeListHeads, storageHeader.freeListHeads + FREE_LIST_CLASSES, NOT_FOUND);
+	storageHeader.checksumType = DEFAULT_CHECKSUM;
+
 	persistStorageHeader();
 
 }
@@ -481,29 +720,61 @@ void RecordFileIO::initStorageHeader() {
 */
 bool RecordFileIO::persistStorageHeader() {
 	if (!cachedFile.isOpen()) return false;
-	uint64_t bytesWritten = cachedFile.write(0, &storageHeader, sizeof StorageHeader);
+	// legacy file header is shorter, records follow it
+	uint64_t headerSize = storageHeader.headerSize;
+	uint64_t bytesWritten = cachedFile.write(0, &storageHeader, headerSize);
 	// check read success
-	if (bytesWritten != sizeof StorageHeader) return false;
+	if (bytesWritten != headerSize) return false;
+	headerDirty = false;
 	return true;
 }
 
 
 
 /*
-*  @brief Loads file storage header to memory storage header
-*  @return true - if succeeded, false - if failed
+*  @brief Loads file storage header to memory storage header. Version 1
+*  files (64 bytes header, 8K pages) are accepted as legacy to be upgraded
+*  on writable open. Version 1 files have zero in checksum type (Adler-32).
+*  @return true - if succeeded, false - if failed, page size mismatch or
+*  unknown checksum algorithm
 */
 bool RecordFileIO::loadStorageHeader() {
 	if (!cachedFile.isOpen()) return false;
 	StorageHeader sh;
-	uint64_t bytesRead = cachedFile.read(0, &sh, sizeof StorageHeader);
+	memset(&sh, 0, sizeof(StorageHeader));
+	uint64_t bytesRead = cachedFile.read(0, &sh, LEGACY_HEADER_SIZE);
 	// check read success
-	if (bytesRead != sizeof StorageHeader) return false;  
+	if (bytesRead != LEGACY_HEADER_SIZE) return false;  
 	// check signature and version
 	if (sh.signature != BOSONDB_SIGNATURE) return false;
-	if (sh.version != BOSONDB_VERSION) return false;
+	if (sh.version == BOSONDB_LEGACY_VERSION) {
+		sh.pageSize = LEGACY_PAGE_SIZE;
+		sh.headerSize = LEGACY_HEADER_SIZE;
+	} else if (sh.version == BOSONDB_VERSION) {
+		bytesRead = cachedFile.read(0, &sh, sizeof(StorageHeader));
+		if (bytesRead != sizeof(StorageHeader)) return false;
+		if (sh.headerSize != sizeof(StorageHeader)) return false;
+	} else return false;
+	// check file has been created with the same page size
+	if (sh.pageSize != PAGE_SIZE) {
+		std::cerr << "ERROR: Storage file page size " << sh.pageSize
+			<< " bytes differs from " << PAGE_SIZE << " bytes.\n";
+		return false;
+	}
+	// check checksum algorithm is known
+	ChecksumFunction function = Checksum::get(ChecksumType(sh.checksumType));
+	if (function == nullptr) return false;
+	checksumFunction = function;
 	// Copy header data to internal structure
-	memcpy(&storageHeader, &sh, sizeof StorageHeader);
+	memcpy(&storageHeader, &sh, sizeof(StorageHeader));
+	// mark non-empty free list classes (legacy file has single free list)
+	freeClassMask = 0;
+	if (storageHeader.version == BOSONDB_LEGACY_VERSION) {
+		std::fill(storageHeader.freeListHeads, storageHeader.freeListHeads + FREE_LIST_CLASSES, NOT_FOUND);
+	}
+	for (uint32_t i = 0; i < FREE_LIST_CLASSES; i++) {
+		if (storageHeader.freeListHeads[i] != NOT_FOUND) freeClassMask |= uint64_t(1) << i;
+	}
 	return true;
 }
 
@@ -517,10 +788,10 @@ bool RecordFileIO::loadStorageHeader() {
 */
 uint64_t RecordFileIO::getRecordHeader(uint64_t offset, RecordHeader& result) {
 	// Read header
-	uint64_t bytesRead = cachedFile.read(offset, &result, sizeof RecordHeader);
-	if (bytesRead != sizeof RecordHeader) return NOT_FOUND;
+	uint64_t bytesRead = cachedFile.read(offset, &result, sizeof(RecordHeader));
+	if (bytesRead != sizeof(RecordHeader)) return NOT_FOUND;
 	// Check data consistency
-	uint32_t headerDataLength = sizeof RecordHeader - sizeof result.headChecksum;
+	uint32_t headerDataLength = sizeof(RecordHeader) - sizeof result.headChecksum;
 	uint32_t expectedChecksum = checksum((uint8_t*)&result, headerDataLength);
 	if (expectedChecksum != result.headChecksum) return NOT_FOUND;
 	return offset;
@@ -536,11 +807,11 @@ uint64_t RecordFileIO::getRecordHeader(uint64_t offset, RecordHeader& result) {
 */
 uint64_t RecordFileIO::putRecordHeader(uint64_t offset, RecordHeader& header) {
 	// calculate checksum and write to the record header end
-	uint32_t headerDataLength = sizeof RecordHeader - sizeof header.headChecksum;
+	uint32_t headerDataLength = sizeof(RecordHeader) - sizeof header.headChecksum;
 	header.headChecksum = checksum((uint8_t*)&header, headerDataLength);
 	// write data
-	uint64_t bytesWritten = cachedFile.write(offset, &header, sizeof RecordHeader);
-	if (bytesWritten != sizeof RecordHeader) return NOT_FOUND;
+	uint64_t bytesWritten = cachedFile.write(offset, &header, sizeof(RecordHeader));
+	if (bytesWritten != sizeof(RecordHeader)) return NOT_FOUND;
 	// return header offset in file
 	return offset;
 }
@@ -556,12 +827,12 @@ uint64_t RecordFileIO::putRecordHeader(uint64_t offset, RecordHeader& header) {
 uint64_t RecordFileIO::allocateRecord(uint32_t capacity, RecordHeader& result) {
 
 	// if there is no free records yet
-	if (storageHeader.firstFreeRecord == NOT_FOUND && storageHeader.lastRecord == NOT_FOUND) {
+	if (storageHeader.totalFreeRecords == 0 && storageHeader.lastRecord == NOT_FOUND) {
 		// if there is no records at all create first record
 		return createFirstRecord(capacity, result);
 	} else {
-		// look up free list for record of suitable capacity
-		uint64_t offset = getFromFreeList(capacity, result);
+		// look up free lists for record of suitable capacity
+		uint64_t offset = getFromSizeClass(capacity, result);
 		// if found, then just return it
 		if (offset != NOT_FOUND) return offset;
 	}
@@ -581,19 +852,19 @@ uint64_t RecordFileIO::allocateRecord(uint32_t capacity, RecordHeader& result) {
 */
 uint64_t RecordFileIO::createFirstRecord(uint32_t capacity, RecordHeader& result) {
 	// clear record header
-	memset(&result, 0, sizeof RecordHeader);
+	memset(&result, 0, sizeof(RecordHeader));
 	// set value to capacity
 	result.next = NOT_FOUND;
 	result.previous = NOT_FOUND;
 	result.recordCapacity = capacity;
 	result.dataLength = 0;
 	// calculate offset right after Storage header
-	uint64_t offset = sizeof StorageHeader;
+	uint64_t offset = storageHeader.headerSize;
 	storageHeader.firstRecord = offset;
     storageHeader.lastRecord = offset;
 	storageHeader.endOfFile += sizeof(RecordHeader) + capacity;
 	storageHeader.totalRecords++;
-	persistStorageHeader();
+	headerDirty = true;
 	
 	return offset;
 }
@@ -615,9 +886,12 @@ uint64_t RecordFileIO::appendNewRecord(uint32_t capacity, RecordHeader& result)
 	RecordHeader lastRecord;
 	uint64_t freeRecordOffset;
 
-	getRecordHeader(storageHeader.lastRecord, lastRecord);
-	lastRecord.next = freeRecordOffset = storageHeader.endOfFile;
-	putRecordHeader(storageHeader.lastRecord, lastRecord);
+	freeRecordOffset = storageHeader.endOfFile;
+	if (storageHeader.lastRecord != NOT_FOUND) {
+		getRecordHeader(storageHeader.lastRecord, lastRecord);
+		lastRecord.next = freeRecordOffset;
+		putRecordHeader(storageHeader.lastRecord, lastRecord);
+	} else storageHeader.firstRecord = freeRecordOffset;
 
 	result.next = NOT_FOUND;
 	result.previous = storageHeader.lastRecord;
@@ -627,178 +901,383 @@ uint64_t RecordFileIO::appendNewRecord(uint32_t capacity, RecordHeader& result)
 	storageHeader.lastRecord = freeRecordOffset;
 	storageHeader.endOfFile += sizeof(RecordHeader) + capacity;
 	storageHeader.totalRecords++;
-	persistStorageHeader();
+	headerDirty = true;
 
 	return freeRecordOffset;
 }
 
 
+/*
+*  @brief Put record to the free list of its size class
+*  @return true - if record added to the free list, false - if not found
+*/
+bool RecordFileIO::putToFreeList(uint64_t offset) {
+	RecordHeader newFreeRecord;
+	if (getRecordHeader(offset, newFreeRecord) == NOT_FOUND) return false;
+	// push to the free list of record capacity class
+	linkToSizeClass(offset, newFreeRecord);
+	// storage header is persisted on flush
+	headerDirty = true;
+	return true;
+}
+
+
+
 /*
 *
-*  @brief Creates record from the free list (previously deleted records)
+*  @brief Links free record to the end of data records list
+*  @param[in] offset   - free record offset (removed from free list)
+*  @param[in] capacity - free record capacity
+*  @param[out] result  - record header of reused record
+*  @return offset of record in the storage file
+*/
+uint64_t RecordFileIO::reuseFreeRecord(uint64_t offset, uint32_t capacity, RecordHeader& result) {
+	// update last record to point to reused record
+	if (storageHeader.lastRecord != NOT_FOUND) {
+		RecordHeader lastRecord;
+		getRecordHeader(storageHeader.lastRecord, lastRecord);
+		lastRecord.next = offset;
+		putRecordHeader(storageHeader.lastRecord, lastRecord);
+	} else storageHeader.firstRecord = offset;
+	// connect reused record with previous
+	result.next = NOT_FOUND;
+	result.previous = storageHeader.lastRecord;
+	result.recordCapacity = capacity;
+	result.dataLength = 0;
+	// update storage header last record to reused record
+	storageHeader.lastRecord = offset;
+	storageHeader.totalRecords++;
+	headerDirty = true;
+	return offset;
+}
+
+
+
+/*
+*
+*  @brief Returns free list class of record capacity: class 0 holds
+*  capacities below FREE_CLASS_MIN, every next capacity doubling is split
+*  into 2^FREE_CLASS_STEP_BITS classes, the last class holds the rest
+*  @param[in] capacity - record capacity in bytes
+*  @return size class index
+*/
+uint32_t RecordFileIO::getSizeClass(uint32_t capacity) {
+	constexpr uint32_t minExponent = highestBit(FREE_CLASS_MIN);
+	if (capacity < FREE_CLASS_MIN) return 0;
+	uint32_t exponent = highestBit(capacity);
+	uint32_t step = (capacity >> (exponent - FREE_CLASS_STEP_BITS)) & ((1 << FREE_CLASS_STEP_BITS) - 1);
+	uint32_t sizeClass = 1 + ((exponent - minExponent) << FREE_CLASS_STEP_BITS) + step;
+	return std::min(sizeClass, FREE_LIST_CLASSES - 1);
+}
+
+
+
+/*
+*
+*  @brief Creates record from the size class free lists: records of
+*  requested capacity class are checked for the best fit (up to
+*  FREE_CLASS_LOOKUP), otherwise head of the lowest non-empty higher class
+*  is taken, any of its records fits.
 *  @param[in] capacity - requested capacity of record
 *  @param[out] result  - record header of created new record
-*  @return offset of record in the storage file
+*  @return offset of record in the storage file or NOT_FOUND
 */
-uint64_t RecordFileIO::getFromFreeList(uint32_t capacity, RecordHeader& result) {
+uint64_t RecordFileIO::getFromSizeClass(uint32_t capacity, RecordHeader& result) {
 
 	if (storageHeader.totalFreeRecords == 0) return NOT_FOUND;
 
-	// If there are free records
 	RecordHeader freeRecord;
-	
-	freeRecord.next = storageHeader.firstFreeRecord;
-	uint64_t offset = freeRecord.next;
-	uint64_t maximumIterations = std::min(storageHeader.totalFreeRecords, freeLookupDepth);
-	uint64_t iterationCounter = 0;
-	// iterate through free list and check iterations counter
-	while (freeRecord.next != NOT_FOUND && iterationCounter < maximumIterations) {
-		// Read next free record header
-		getRecordHeader(offset, freeRecord);
-		// if record with requested capacity found
-		if (freeRecord.recordCapacity >= capacity) {
-			// Remove free record from the free list
-			removeFromFreeList(freeRecord);			
-			// update last record to point to new record
-			RecordHeader lastRecord;
-			getRecordHeader(storageHeader.lastRecord, lastRecord);
-			lastRecord.next = offset;			
-			putRecordHeader(storageHeader.lastRecord, lastRecord);
-			// connect new record with previous
-			result.next = NOT_FOUND;
-			result.previous = storageHeader.lastRecord;
-			result.recordCapacity = freeRecord.recordCapacity;
-			result.dataLength = 0;
-
-			// update storage header last record to new record
-			storageHeader.lastRecord = offset;
-			storageHeader.totalRecords++;
-			persistStorageHeader();
-			return offset;
+	uint32_t sizeClass = getSizeClass(capacity);
+	uint64_t bestOffset = NOT_FOUND;
+	uint32_t bestCapacity = UINT32_MAX;
+
+	// records of the requested class may be smaller than requested
+	uint64_t offset = storageHeader.freeListHeads[sizeClass];
+	uint64_t maximumIterations = std::min<uint64_t>(FREE_CLASS_LOOKUP, freeLookupDepth);
+	for (uint64_t i = 0; offset != NOT_FOUND && i < maximumIterations; i++) {
+		if (getRecordHeader(offset, freeRecord) == NOT_FOUND) break;
+		if (freeRecord.recordCapacity >= capacity && freeRecord.recordCapacity < bestCapacity) {
+			bestOffset = offset;
+			bestCapacity = freeRecord.recordCapacity;
+			if (bestCapacity == capacity) break;
 		}
 		offset = freeRecord.next;
-		iterationCounter++;
 	}
-	return NOT_FOUND;
+
+	// otherwise take record of the lowest non-empty higher class
+	if (bestOffset == NOT_FOUND) {
+		uint64_t higherClasses = freeClassMask & ~((uint64_t(2) << sizeClass) - 1);
+		if (higherClasses == 0) return NOT_FOUND;
+		bestOffset = storageHeader.freeListHeads[lowestBit(higherClasses)];
+	}
+
+	if (getRecordHeader(bestOffset, freeRecord) == NOT_FOUND) return NOT_FOUND;
+	unlinkFromSizeClass(freeRecord);
+	return reuseFreeRecord(bestOffset, freeRecord.recordCapacity, result);
 }
 
 
 
 /*
-*  @brief Put record to the free list
-*  @return true - if record added to the free list, false - if not found
+*  @brief Pushes record to the head of its size class free list
+*  (storage header is not persisted)
+*  @param[in] offset     - record offset
+*  @param[in] freeRecord - record header (updated)
 */
-bool RecordFileIO::putToFreeList(uint64_t offset) {
-	
-	RecordHeader newFreeRecord;
-	RecordHeader previousFreeRecord;
-	
-	if (getRecordHeader(offset, newFreeRecord) == NOT_FOUND) return false;
-
-	// Update previous free record to reference next new free record
-	size_t previousFreeRecordOffset = storageHeader.lastFreeRecord;
-	// if free records list is not empty
-	if (previousFreeRecordOffset != NOT_FOUND) {
-		// load previous last record
-		getRecordHeader(previousFreeRecordOffset, previousFreeRecord);
-		// set last recrod next value to recently deleted free record
-		previousFreeRecord.next = offset;
-		// save previous last record
-		putRecordHeader(previousFreeRecordOffset, previousFreeRecord);
-	}
-		
-	// Update new free record fields	
-	newFreeRecord.next = NOT_FOUND;
-	// Point to the previous free record position
-	newFreeRecord.previous = previousFreeRecordOffset;
-	// Set data length and data checksum to zero, because it doesn't matter
-	newFreeRecord.dataLength = 0;
-	newFreeRecord.dataChecksum = 0;
-	// Save record header
-	putRecordHeader(offset, newFreeRecord);
-
-	// if its first free record, save its offset to the storage header	
-	if (storageHeader.firstFreeRecord == NOT_FOUND) {
-		storageHeader.firstFreeRecord = offset;
+void RecordFileIO::linkToSizeClass(uint64_t offset, RecordHeader& freeRecord) {
+	uint32_t sizeClass = getSizeClass(freeRecord.recordCapacity);
+	uint64_t headOffset = storageHeader.freeListHeads[sizeClass];
+	// point current head back to the new free record
+	if (headOffset != NOT_FOUND) {
+		RecordHeader headRecord;
+		getRecordHeader(headOffset, headRecord);
+		headRecord.previous = offset;
+		putRecordHeader(headOffset, headRecord);
 	}
-
-	// save it as last added free record
-	storageHeader.lastFreeRecord = offset;
+	// data length and data checksum doesn't matter for free record
+	freeRecord.next = headOffset;
+	freeRecord.previous = NOT_FOUND;
+	freeRecord.dataLength = 0;
+	freeRecord.dataChecksum = 0;
+	putRecordHeader(offset, freeRecord);
+	storageHeader.freeListHeads[sizeClass] = offset;
 	storageHeader.totalFreeRecords++;
+	freeClassMask |= uint64_t(1) << sizeClass;
+}
 
-	// save storage header
-	persistStorageHeader();
-	return true;
+
+
+/*
+*  @brief Removes record from its size class free list
+*  (storage header is not persisted)
+*  @param[in] freeRecord - record header
+*/
+void RecordFileIO::unlinkFromSizeClass(RecordHeader& freeRecord) {
+	uint32_t sizeClass = getSizeClass(freeRecord.recordCapacity);
+	RecordHeader siblingRecord;
+	if (freeRecord.previous != NOT_FOUND) {
+		getRecordHeader(freeRecord.previous, siblingRecord);
+		siblingRecord.next = freeRecord.next;
+		putRecordHeader(freeRecord.previous, siblingRecord);
+	} else storageHeader.freeListHeads[sizeClass] = freeRecord.next;
+	if (freeRecord.next != NOT_FOUND) {
+		getRecordHeader(freeRecord.next, siblingRecord);
+		siblingRecord.previous = freeRecord.previous;
+		putRecordHeader(freeRecord.next, siblingRecord);
+	}
+	if (storageHeader.freeListHeads[sizeClass] == NOT_FOUND) {
+		freeClassMask &= ~(uint64_t(1) << sizeClass);
+	}
+	storageHeader.totalFreeRecords--;
 }
 
 
+
 /*
-*  @brief Remove record from free list and update siblings interlinks
-*  @param[in] freeRecord - header of record to remove from free list
+*
+*  @brief Upgrades version 1 file (64 bytes header, single free list) to
+*  current format. Records follow each other from the end of legacy header,
+*  ones overlapping current header space are relocated to the end of file
+*  (free ones are dropped), the rest of the last of them becomes a free
+*  record (records are taken until the rest fits FREE_CLASS_MIN bytes). Free records are relinked to size class lists and the header is
+*  rewritten in place.
+*  @return true - if succeeded, false - if file records are corrupt
+*
 */
-void RecordFileIO::removeFromFreeList(RecordHeader& freeRecord) {
-	// Simplify namings and check
-	uint64_t leftSiblingOffset = freeRecord.previous;
-	uint64_t rightSiblingOffset = freeRecord.next;
-	bool leftSiblingExists = (leftSiblingOffset != NOT_FOUND);
-	bool rightSiblingExists = (rightSiblingOffset != NOT_FOUND);
+bool RecordFileIO::upgradeLegacyFile() {
+	RecordHeader header;
+	uint64_t headerEnd = sizeof(StorageHeader);
+	uint64_t legacyEnd = storageHeader.endOfFile;
+
+	// collect free records of the single free list
+	std::vector<uint64_t> freeRecords;
+	uint64_t offset = storageHeader.firstFreeRecord;
+	while (offset != NOT_FOUND && freeRecords.size() < storageHeader.totalFreeRecords) {
+		if (getRecordHeader(offset, header) == NOT_FOUND) return false;
+		freeRecords.push_back(offset);
+		offset = header.next;
+	}
+	std::sort(freeRecords.begin(), freeRecords.end());
+
+	// find records overlapping header, the rest must fit a small record
+	std::vector<uint64_t> overlapped;
+	uint64_t regionEnd = LEGACY_HEADER_SIZE;
+	uint64_t minimalRest = sizeof(RecordHeader) + FREE_CLASS_MIN;
+	while (regionEnd < legacyEnd && regionEnd != headerEnd && regionEnd < headerEnd + minimalRest) {
+		if (getRecordHeader(regionEnd, header) == NOT_FOUND) return false;
+		overlapped.push_back(regionEnd);
+		regionEnd += sizeof(RecordHeader) + header.recordCapacity;
+	}
+	if (regionEnd > legacyEnd) return false;
 
+	// switch header to size class free lists
+	storageHeader.version = BOSONDB_VERSION;
+	storageHeader.headerSize = sizeof(StorageHeader);
+	storageHeader.endOfFile = std::max(legacyEnd, headerEnd);
+	storageHeader.totalFreeRecords = 0;
+	storageHeader.firstFreeRecord = NOT_FOUND;
+	storageHeader.lastFreeRecord = NOT_FOUND;
+	std::fill(storageHeader.freeListHeads, storageHeader.freeListHeads + FREE_LIST_CLASSES, NOT_FOUND);
+	storageHeader.checksumType = ADLER32_CHECKSUM;
+	memset(storageHeader.reserved, 0, sizeof(storageHeader.reserved));
+	freeClassMask = 0;
+	for (uint64_t freeOffset : freeRecords) {
+		if (freeOffset < regionEnd) continue;
+		if (getRecordHeader(freeOffset, header) == NOT_FOUND) return false;
+		linkToSizeClass(freeOffset, header);
+	}
 
-	RecordHeader leftSiblingHeader;
-	RecordHeader rightSiblingHeader;
+	// move data records out of header space
+	for (uint64_t recordOffset : overlapped) {
+		if (std::binary_search(freeRecords.begin(), freeRecords.end(), recordOffset)) continue;
+		if (!relocateRecord(recordOffset)) return false;
+	}
 
-	// If both of siblings exists then we removing record in the middle
-	if (leftSiblingExists && rightSiblingExists) {		               
-		// If removing in the middle
-		getRecordHeader(freeRecord.previous, leftSiblingHeader);
-		getRecordHeader(freeRecord.next, rightSiblingHeader);
-		leftSiblingHeader.next = rightSiblingOffset;
-		rightSiblingHeader.previous = leftSiblingOffset;
-		putRecordHeader(leftSiblingOffset, leftSiblingHeader);
-		putRecordHeader(rightSiblingOffset, rightSiblingHeader);
-	}   // if left sibling exists and right is not
-	else if (leftSiblingExists) {                                    
-		// if removing last free record
-		getRecordHeader(freeRecord.previous, leftSiblingHeader);
-		leftSiblingHeader.next = NOT_FOUND;
-		putRecordHeader(leftSiblingOffset, leftSiblingHeader);
-		storageHeader.lastFreeRecord = leftSiblingOffset;
-	}   // if right sibling exists and left is not
-	else if (rightSiblingExists) {                                   
-		// if removing first free record
-		getRecordHeader(freeRecord.next, rightSiblingHeader);
-		rightSiblingHeader.previous = NOT_FOUND;
-		putRecordHeader(rightSiblingOffset, rightSiblingHeader);
-		storageHeader.firstFreeRecord = rightSiblingOffset;
-	} else {                                                           
-		// If removing last free record
-		storageHeader.firstFreeRecord = NOT_FOUND;
-		storageHeader.lastFreeRecord = NOT_FOUND;
+	// the rest of the last overlapped record is free
+	if (regionEnd > headerEnd) {
+		memset(&header, 0, sizeof(RecordHeader));
+		header.recordCapacity = uint32_t(regionEnd - headerEnd - sizeof(RecordHeader));
+		linkToSizeClass(headerEnd, header);
 	}
-	// Decrement total free records
-	storageHeader.totalFreeRecords--;
-	// Persist storage header
-	persistStorageHeader();
+
+	return persistStorageHeader();
+}
+
+
+
+/*
+*
+*  @brief Moves record with its data to the end of file and relinks its
+*  siblings (storage header is not persisted)
+*  @param[in] offset - record offset
+*  @return true - if succeeded, false - if failed
+*
+*/
+bool RecordFileIO::relocateRecord(uint64_t offset) {
+	RecordHeader header;
+	RecordHeader siblingRecord;
+	if (getRecordHeader(offset, header) == NOT_FOUND) return false;
+	uint64_t newOffset = storageHeader.endOfFile;
+	// copy data
+	std::vector<uint8_t> data(header.dataLength);
+	uint64_t dataOffset = offset + sizeof(RecordHeader);
+	if (cachedFile.read(dataOffset, data.data(), data.size()) != data.size()) return false;
+	if (cachedFile.write(newOffset + sizeof(RecordHeader), data.data(), data.size()) != data.size()) return false;
+	if (putRecordHeader(newOffset, header) == NOT_FOUND) return false;
+	// point siblings to the new position
+	if (header.previous != NOT_FOUND) {
+		if (getRecordHeader(header.previous, siblingRecord) == NOT_FOUND) return false;
+		siblingRecord.next = newOffset;
+		putRecordHeader(header.previous, siblingRecord);
+	} else storageHeader.firstRecord = newOffset;
+	if (header.next != NOT_FOUND) {
+		if (getRecordHeader(header.next, siblingRecord) == NOT_FOUND) return false;
+		siblingRecord.previous = newOffset;
+		putRecordHeader(header.next, siblingRecord);
+	} else storageHeader.lastRecord = newOffset;
+	storageHeader.endOfFile += sizeof(RecordHeader) + header.recordCapacity;
+	return true;
 }
 
 
 
 /**
-*  @brief Adler-32 checksum algoritm (strightforward and not efficent, but its okay)
+*  @brief Checksum of the file algorithm (see Checksum)
 *  @param[in] data - byte array of data to be checksummed
 *  @param[in] length - length of data in bytes
 *  @return 32-bit checksum of given data
 */
 uint32_t RecordFileIO::checksum(const uint8_t* data, uint64_t length) {
+	return checksumFunction(data, length);
+}
+
+
+
+/**
+*  @brief Copies data from pinned cache pages
+*  @param[in] offset - data position in the file
+*  @param[out] buffer - destination buffer
+*  @param[in] length - bytes to copy
+*  @param[out] loadStamp - latest load stamp of data pages (0 - unknown)
+*  @return bytes copied
+*/
+uint64_t RecordFileIO::readData(uint64_t offset, uint8_t* buffer, uint64_t length, uint64_t& loadStamp) {
+	uint64_t bytesCopied = 0;
+	bool stampKnown = true;
+	loadStamp = 0;
+	while (bytesCopied < length) {
+		PageRef page = cachedFile.pin(offset + bytesCopied);
+		if (!page.isPinned()) break;
+		size_t bytesToCopy = std::min<uint64_t>(page.length(), length - bytesCopied);
+		memcpy(buffer + bytesCopied, page.data(), bytesToCopy);
+		bytesCopied += bytesToCopy;
+		stampKnown = stampKnown && page.loadStamp() != 0;
+		loadStamp = std::max(loadStamp, page.loadStamp());
+	}
+	if (!stampKnown) loadStamp = 0;
+	return bytesCopied;
+}
+
 
-	const uint32_t MOD_ADLER = 65521;
-	uint32_t a = 1, b = 0;
-	uint64_t index;
-	// Process each byte of the data in order
-	for (index = 0; index < length; ++index)
-	{
-		a = (a + data[index]) % MOD_ADLER;
-		b = (b + a) % MOD_ADLER;
+/**
+*  @brief Verifies data of current record by verification policy. Load
+*  stamp of a page is larger than stamps of all pages loaded before, so
+*  record is verified again if any of its pages has been reloaded.
+*  @param[in] data - record data
+*  @param[in] length - data length in bytes
+*  @param[in] loadStamp - latest load stamp of record pages (0 - unknown)
+*  @return true - if data is consistent or not verified, false - if corrupted
+*/
+bool RecordFileIO::verifyData(const uint8_t* data, uint64_t length, uint64_t loadStamp) {
+	bool verify = true;
+	switch (verifyPolicy) {
+	case VERIFY_ON_LOAD: {
+		VerifiedRecord& entry = getVerifiedRecord(currentPosition);
+		verify = loadStamp == 0 || entry.offset != currentPosition || entry.loadStamp != loadStamp;
+		break;
+	}
+	case VERIFY_SAMPLED:
+		verify = (verifyReads++ % verifySamplePeriod) == 0;
+		break;
+	case VERIFY_ON_SCRUB:
+		verify = false;
+		break;
+	default:
+		break;
+	}
+	if (!verify) {
+		unverifiedBytes += length;
+		return true;
+	}
+	if (checksum(data, length) != recordHeader.dataChecksum) {
+		checksumFailures++;
+		return false;
 	}
-	return (b << 16) | a;
-}
\ No newline at end of file
+	verifiedRecords++;
+	verifiedBytes += length;
+	if (verifyPolicy == VERIFY_ON_LOAD && loadStamp != 0) {
+		VerifiedRecord& entry = getVerifiedRecord(currentPosition);
+		entry.offset = currentPosition;
+		entry.loadStamp = loadStamp;
+	}
+	return true;
+}
+
+
+/**
+*  @brief Returns verified records table slot of record offset
+*/
+VerifiedRecord& RecordFileIO::getVerifiedRecord(uint64_t offset) {
+	uint64_t hash = (offset * 0x9E3779B97F4A7C15ull) >> 32;
+	return verifiedTable[hash % VERIFIED_RECORDS_SLOTS];
+}
+
+
+/**
+*  @brief Drops record from verified records table (record is rewritten)
+*/
+void RecordFileIO::forgetVerified(uint64_t offset) {
+	if (verifiedTable.empty()) return;
+	VerifiedRecord& entry = getVerifiedRecord(offset);
+	if (entry.offset == offset) entry.offset = NOT_FOUND;
+}
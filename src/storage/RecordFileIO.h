@@ -13,12 +13,32 @@
 *    - reuse space of deleted records
 *    - data consistency check (checksum)
 *
+*  Checksum algorithm is recorded in the storage header: new files use
+*  CRC32C, files created before the field keep Adler-32 (zero value).
+*  Data checksum verification on read is configurable: always, once per
+*  record after its pages are loaded to the cache (cache hits skip it),
+*  every N-th read or never on read with incremental scrub() instead.
+*
+*  Storage header is kept in memory and marked dirty by changes, it is
+*  persisted by flush() and on destruction only, so record changes do not
+*  rewrite the first page every time.
+*
+*  Deleted records are kept in segregated free lists by capacity class
+*  (4 classes per capacity doubling), heads of the lists are
+*  persisted in the storage header. Allocation takes the head of the lowest
+*  non-empty class above requested capacity class (O(1) by class bitmap),
+*  only a few records of the requested class itself are checked for fit.
+*  Version 1 (legacy) files are upgraded on writable open: records in the
+*  space of the larger header are relocated to the end of file and free
+*  records are relinked to size class lists.
+*
 *  (C) Boson Database, Bolat Basheyev 2022-2023
 *
 ******************************************************************************/
 #pragma once
 
 #include "CachedFileIO.h"
+#include "Checksum.h"
 
 #include <vector>
 #include <string>
@@ -29,10 +49,21 @@ namespace Boson {
 	// Boson storage header signature and version
 	//----------------------------------------------------------------------------
 	constexpr uint32_t BOSONDB_SIGNATURE = 0x42445342; // BSDB signature
-	constexpr uint32_t BOSONDB_VERSION   = 0x00000001; // Version 1
+	constexpr uint32_t BOSONDB_VERSION   = 0x00000002; // Version 2
+	constexpr uint32_t BOSONDB_LEGACY_VERSION = 0x00000001; // Version 1 (legacy)
+	constexpr uint64_t LEGACY_HEADER_SIZE     = 64;         // Version 1 header size
+	constexpr uint64_t LEGACY_PAGE_SIZE       = 8192;       // Version 1 page size
+
+	//----------------------------------------------------------------------------
+	// Free records size classes
+	//----------------------------------------------------------------------------
+	constexpr uint32_t FREE_LIST_CLASSES  = 48;  // Free lists by capacity class
+	constexpr uint32_t FREE_CLASS_MIN     = 16;  // Class 0 holds capacities below
+	constexpr uint32_t FREE_CLASS_STEP_BITS = 2; // Classes per capacity doubling (log2)
+	constexpr uint64_t FREE_CLASS_LOOKUP  = 16;  // Records checked in requested class
 	
 	//----------------------------------------------------------------------------
-	// Boson storage header structure (64 bytes)
+	// Boson storage header structure (512 bytes)
 	//----------------------------------------------------------------------------
 	typedef struct {
 		uint32_t      signature;           // BSDB signature
@@ -46,8 +77,43 @@ namespace Boson {
 		uint64_t      totalFreeRecords;    // Total number of free records
 		uint64_t      firstFreeRecord;     // First free record offset
 		uint64_t      lastFreeRecord;      // Last free record offset
+
+		uint32_t      pageSize;            // Cache page size of the file
+		uint32_t      headerSize;          // Storage header size in the file
+		uint64_t      freeListHeads[FREE_LIST_CLASSES]; // Free list heads by class
+		uint32_t      checksumType;        // Records checksum algorithm (ChecksumType)
+		uint8_t       reserved[52];        // Reserved (zeroed)
 	} StorageHeader;
 
+	static_assert(sizeof(StorageHeader) == 512, "Storage header must be 512 bytes");
+
+
+	//----------------------------------------------------------------------------
+	// Record data checksum verification
+	//----------------------------------------------------------------------------
+	constexpr uint64_t VERIFY_SAMPLE_PERIOD   = 16;   // Reads per verified read (sampled)
+	constexpr uint64_t VERIFIED_RECORDS_SLOTS = 4096; // Verified records table size
+
+	typedef enum {                              // Data checksum verification policy
+		VERIFY_ALWAYS,                          // Every read verifies data (default)
+		VERIFY_ON_LOAD,                         // Once after record pages loaded to cache
+		VERIFY_SAMPLED,                         // Every N-th read verifies data
+		VERIFY_ON_SCRUB                         // Reads don't verify, scrub() does
+	} ChecksumVerifyPolicy;
+
+	typedef enum {                              // RecordFileIO stats types
+		VERIFIED_RECORDS,                       // Records data verified (reads and scrub)
+		VERIFIED_BYTES,                         // Data bytes verified
+		UNVERIFIED_BYTES,                       // Data bytes read without verification
+		CHECKSUM_FAILURES,                      // Records failed verification
+		SCRUBBED_RECORDS                        // Records checked by scrub()
+	} RecordFileStats;
+
+	typedef struct {                            // Verified record (VERIFY_ON_LOAD)
+		uint64_t    offset;                     // Record offset (NOT_FOUND - empty)
+		uint64_t    loadStamp;                  // Latest load stamp of record pages
+	} VerifiedRecord;
+
 
 	//----------------------------------------------------------------------------
 	// Record header structure (32 bytes)
@@ -70,9 +136,16 @@ namespace Boson {
 		RecordFileIO(CachedFileIO& cachedFile, size_t freeDepth = NOT_FOUND);
 		~RecordFileIO();
 		bool     isOpen();
+		bool     flush(size_t maxPages = NOT_FOUND);
 		uint64_t getTotalRecords();
 		uint64_t getTotalFreeRecords();
+		ChecksumType getChecksumType();
 		void     setFreeRecordLookupDepth(uint64_t maxDepth) { freeLookupDepth = maxDepth; }
+		void     setChecksumVerify(ChecksumVerifyPolicy policy, uint64_t samplePeriod = VERIFY_SAMPLE_PERIOD);
+		ChecksumVerifyPolicy getChecksumVerify();
+		uint64_t scrub(uint64_t maxRecords);
+		double   getStats(RecordFileStats type);
+		void     resetStats();
 
 		// records navigation
 		bool     setPosition(uint64_t offset);
@@ -90,14 +163,29 @@ namespace Boson {
 		uint64_t getNextPosition();
 		uint64_t getPrevPosition();
 		uint64_t getRecordData(void* data, uint32_t length);
+		uint64_t getRecordData(std::string& data);
 		uint64_t setRecordData(const void* data, uint32_t length);
 
 	private:
 		CachedFileIO& cachedFile;
 		StorageHeader storageHeader;
+		bool          headerDirty;         // Storage header changed since persisted
 		RecordHeader  recordHeader;
 		size_t        currentPosition;
 		size_t        freeLookupDepth;
+		uint64_t      freeClassMask;       // Bit per non-empty free list class
+		ChecksumFunction checksumFunction; // Checksum of file algorithm
+
+		ChecksumVerifyPolicy verifyPolicy; // Data checksum verification policy
+		uint64_t      verifySamplePeriod;  // Reads per verified read (sampled)
+		uint64_t      verifyReads;         // Reads counter (sampled)
+		std::vector<VerifiedRecord> verifiedTable; // Verified records (on load)
+		uint64_t      scrubPosition;       // Next record to scrub
+		uint64_t      verifiedRecords;     // Records data verified
+		uint64_t      verifiedBytes;       // Data bytes verified
+		uint64_t      unverifiedBytes;     // Data bytes read without verification
+		uint64_t      checksumFailures;    // Records failed verification
+		uint64_t      scrubbedRecords;     // Records checked by scrub()
 
 		void     initStorageHeader();
 		bool     persistStorageHeader();
@@ -107,10 +195,19 @@ namespace Boson {
 		uint64_t allocateRecord(uint32_t capacity, RecordHeader& result);
 		uint64_t createFirstRecord(uint32_t capacity, RecordHeader& result);
 		uint64_t appendNewRecord(uint32_t capacity, RecordHeader& result);
-		uint64_t getFromFreeList(uint32_t capacity, RecordHeader& result);
 		bool     putToFreeList(uint64_t offset);
-		void     removeFromFreeList(RecordHeader& freeRecord);
+		uint64_t reuseFreeRecord(uint64_t offset, uint32_t capacity, RecordHeader& result);
+		uint64_t getFromSizeClass(uint32_t capacity, RecordHeader& result);
+		void     linkToSizeClass(uint64_t offset, RecordHeader& freeRecord);
+		void     unlinkFromSizeClass(RecordHeader& freeRecord);
+		bool     upgradeLegacyFile();
+		bool     relocateRecord(uint64_t offset);
+		static uint32_t getSizeClass(uint32_t capacity);
 		uint32_t checksum(const uint8_t* data, uint64_t length);
+		uint64_t readData(uint64_t offset, uint8_t* buffer, uint64_t length, uint64_t& loadStamp);
+		bool     verifyData(const uint8_t* data, uint64_t length, uint64_t loadStamp);
+		VerifiedRecord& getVerifiedRecord(uint64_t offset);
+		void     forgetVerified(uint64_t offset);
 	};
 
 
@@ -0,0 +1,196 @@
+/******************************************************************************
+*
+*  ReplacementPolicy factory, PageHistory and LRUPolicy implementation
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "ReplacementPolicy.h"
+#include "CachedFileIO.h"
+
+using namespace Boson;
+
+
+/**
+*
+*  @brief Creates replacement policy of requested type for cache partition
+*
+*  @param[in] type     - replacement policy type
+*  @param[in] pages    - partition slice of cache pages pool
+*  @param[in] capacity - partition capacity (pages)
+*
+*  @return new replacement policy instance (caller owns)
+*
+*/
+ReplacementPolicy* ReplacementPolicy::create(ReplacementPolicyType type, CachePage* pages, size_t capacity) {
+	switch (type) {
+	case ReplacementPolicyType::CLOCK_POLICY:
+		return new ClockPolicy(pages, capacity);
+	case ReplacementPolicyType::CLOCK_PRO_POLICY:
+		return new ClockProPolicy(pages, capacity);
+	case ReplacementPolicyType::TWO_QUEUE_POLICY:
+		return new TwoQueuePolicy(capacity);
+	case ReplacementPolicyType::ARC_POLICY:
+		return new ArcPolicy(capacity);
+	case ReplacementPolicyType::TINY_LFU_POLICY:
+		return new TinyLfuPolicy(capacity);
+	default:
+		return new LRUPolicy();
+	}
+}
+
+
+/**
+*
+*  @brief Returns least recently used not pinned page of the list, clean page
+*  is preferred if it is found before CLEAN_VICTIM_SCAN dirty pages
+*
+*  @param[in] list - pages list in recency order
+*
+*  @return page or nullptr if all list pages are pinned
+*
+*/
+CachePage* ReplacementPolicy::lastUnpinned(std::list<CachePage*>& list) {
+	CachePage* dirtyPage = nullptr;
+	size_t dirtyScanned = 0;
+	for (auto it = list.rbegin(); it != list.rend(); ++it) {
+		CachePage* page = *it;
+		if (page->pinCount.load(std::memory_order_acquire) != 0) continue;
+		if (page->state != PageState::DIRTY) return page;
+		if (dirtyPage == nullptr) dirtyPage = page;
+		if (++dirtyScanned == CLEAN_VICTIM_SCAN) break;
+	}
+	return dirtyPage;
+}
+
+
+//=============================================================================
+//
+//                          Evicted pages history
+//
+//=============================================================================
+
+/**
+*  @brief Constructor
+*  @param[in] capacity - maximum entries count
+*/
+PageHistory::PageHistory(size_t capacity) {
+	this->capacity = capacity < 1 ? 1 : capacity;
+	this->sequence = 0;
+}
+
+
+/**
+*
+*  @brief Adds evicted page to the history, drops oldest entries over capacity
+*
+*  @param[in] filePageNo - evicted file page number
+*
+*  @return true if oldest entry has been dropped (expired), false otherwise
+*
+*/
+bool PageHistory::add(size_t filePageNo) {
+	bool expired = false;
+	sequence++;
+	fifo.emplace_back(filePageNo, sequence);
+	entries[filePageNo] = sequence;
+	// removed and re-added entries stay in fifo until reach the front
+	while (entries.size() > capacity || fifo.size() > capacity * 2) {
+		auto oldest = fifo.front();
+		fifo.pop_front();
+		auto entry = entries.find(oldest.first);
+		if (entry != entries.end() && entry->second == oldest.second) {
+			entries.erase(entry);
+			expired = true;
+		}
+	}
+	return expired;
+}
+
+
+/**
+*  @brief Removes page from the history
+*  @return true if page has been in the history, false otherwise
+*/
+bool PageHistory::remove(size_t filePageNo) {
+	return entries.erase(filePageNo) > 0;
+}
+
+
+/**
+*  @brief Checks if page is in the history
+*  @return true if page is in the history, false otherwise
+*/
+bool PageHistory::contains(size_t filePageNo) {
+	return entries.find(filePageNo) != entries.end();
+}
+
+
+/**
+*
+*  @brief Drops oldest entries until history has no more than requested size
+*
+*  @param[in] maxSize - maximum entries count to keep
+*
+*  @return amount of dropped entries
+*
+*/
+size_t PageHistory::shrink(size_t maxSize) {
+	size_t dropped = 0;
+	while (entries.size() > maxSize && !fifo.empty()) {
+		auto oldest = fifo.front();
+		fifo.pop_front();
+		auto entry = entries.find(oldest.first);
+		if (entry != entries.end() && entry->second == oldest.second) {
+			entries.erase(entry);
+			dropped++;
+		}
+	}
+	return dropped;
+}
+
+
+/**
+*  @brief Returns history entries count
+*/
+size_t PageHistory::size() {
+	return entries.size();
+}
+
+
+//=============================================================================
+//
+//                        Least recently used policy
+//
+//=============================================================================
+
+/**
+*  @brief Places loaded page to the front of the list
+*/
+void LRUPolicy::onInsert(CachePage* page) {
+	cacheList.push_front(page);
+	page->it = cacheList.begin();
+	page->policyState = POLICY_RESIDENT;
+}
+
+
+/**
+*  @brief Moves page to the front of the list (list node is relinked in place)
+*/
+void LRUPolicy::onAccess(CachePage* page) {
+	cacheList.splice(cacheList.begin(), cacheList, page->it);
+}
+
+
+/**
+*  @brief Removes most aged not pinned (preferably clean) page from the list back
+*  @return victim page or nullptr if all pages are pinned
+*/
+CachePage* LRUPolicy::selectVictim() {
+	CachePage* page = lastUnpinned(cacheList);
+	if (page == nullptr) return nullptr;
+	cacheList.erase(page->it);
+	page->policyState = 0;
+	return page;
+}
@@ -0,0 +1,259 @@
+/******************************************************************************
+*
+*  ReplacementPolicy classes header
+*
+*  ReplacementPolicy decides which cached page of CachedFileIO partition is
+*  evicted when partition has no free pages. Policy is notified when page
+*  is placed to the cache and on every cache hit, and selects victim page
+*  skipping pages pinned by other threads. Among next CLEAN_VICTIM_SCAN
+*  dirty candidates clean page is preferred, so eviction doesn't wait for
+*  write to storage device. Victim which can't be evicted
+*  (dirty page failed to persist) is restored as newly loaded page without
+*  consulting history of evicted pages. When cache is resized in place,
+*  policy gets new partition capacity to rescale its targets. All calls are
+*  made under partition lock.
+*
+*  Policies:
+*    - LRUPolicy      - least recently used (double linked list)
+*    - ClockPolicy    - CLOCK, reference bit set on hit, clock hand scans
+*                       contiguous pool slice of partition as a ring
+*    - ClockProPolicy - CLOCK-Pro, hot/cold pages with test period and
+*                       history of evicted cold pages, adapts cold pages
+*                       target size to the workload
+*    - TwoQueuePolicy - 2Q, new pages land in probationary FIFO queue and
+*                       only pages re-referenced after eviction from it are
+*                       promoted to the main LRU queue (scan resistant)
+*    - ArcPolicy      - ARC, recency and frequency LRU lists with histories
+*                       of evicted pages, balance between lists adapts to
+*                       the workload (scan resistant)
+*    - TinyLfuPolicy  - W-TinyLFU, small admission window in front of main
+*                       segmented LRU, page leaving the window is admitted
+*                       to main cache only if it is accessed more frequently
+*                       than main cache victim (count-min frequency sketch)
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+namespace Boson {
+
+	class CachePage;
+
+	//-------------------------------------------------------------------------
+
+	typedef enum {                              // Cache replacement policies
+		LRU_POLICY       = 0,                   // Least recently used (linked list)
+		CLOCK_POLICY     = 1,                   // CLOCK (reference bit, ring over pool)
+		CLOCK_PRO_POLICY = 2,                   // CLOCK-Pro (hot/cold pages, test period)
+		TWO_QUEUE_POLICY = 3,                   // 2Q (probationary FIFO + main LRU)
+		ARC_POLICY       = 4,                   // Adaptive replacement cache
+		TINY_LFU_POLICY  = 5                    // W-TinyLFU (frequency based admission)
+	} ReplacementPolicyType;
+
+	typedef enum {                              // Page policy state flags
+		POLICY_RESIDENT   = 1,                  // Page is tracked by policy
+		POLICY_REFERENCED = 2,                  // Page referenced since last scan
+		POLICY_HOT        = 4,                  // Hot page (CLOCK-Pro)
+		POLICY_TEST       = 8,                  // Cold page in test period (CLOCK-Pro)
+		POLICY_PROTECTED  = 16,                 // Page in main/frequency list (2Q, ARC)
+		POLICY_WINDOW     = 32                  // Page in admission window (W-TinyLFU)
+	} PolicyStateFlags;
+
+	//-------------------------------------------------------------------------
+	// Bounded FIFO history of evicted pages numbers (non resident pages)
+	//-------------------------------------------------------------------------
+	class PageHistory {
+	public:
+		PageHistory(size_t capacity);
+		bool   add(size_t filePageNo);
+		bool   remove(size_t filePageNo);
+		bool   contains(size_t filePageNo);
+		size_t shrink(size_t maxSize);
+		size_t size();
+	private:
+		size_t   capacity;                       // Maximum entries count
+		uint64_t sequence;                       // Entries sequence counter
+		std::deque<std::pair<size_t, uint64_t>> fifo;   // Entries in eviction order
+		std::unordered_map<size_t, uint64_t> entries;   // Page No. -> entry sequence
+	};
+
+	//-------------------------------------------------------------------------
+	// Count-min sketch of page access frequency (4-bit counters with aging)
+	//-------------------------------------------------------------------------
+	class FrequencySketch {
+	public:
+		FrequencySketch(size_t capacity);
+		void     increment(size_t filePageNo);
+		uint32_t frequency(size_t filePageNo);
+	private:
+		void     age();
+
+		std::vector<uint64_t> table;             // 16 counters of 4 bits per word
+		uint64_t tableMask;                      // Table index mask
+		size_t   additions;                      // Increments since last aging
+		size_t   sampleSize;                     // Increments between agings
+	};
+
+	//-------------------------------------------------------------------------
+	// Replacement policy interface
+	//-------------------------------------------------------------------------
+	class ReplacementPolicy {
+	public:
+		virtual ~ReplacementPolicy() {}
+		virtual void       onMiss(size_t filePageNo) {}
+		virtual void       onInsert(CachePage* page) = 0;
+		virtual void       onAccess(CachePage* page) = 0;
+		virtual void       onRestore(CachePage* page) { onInsert(page); }
+		virtual CachePage* selectVictim() = 0;
+		virtual const char* getName() = 0;
+		virtual uint64_t   getAdmissionsRejected() { return 0; }
+		virtual void       resetStats() {}
+		virtual void       setCapacity(size_t capacity) {}
+
+		static ReplacementPolicy* create(ReplacementPolicyType type, CachePage* pages, size_t capacity);
+	protected:
+		static CachePage* lastUnpinned(std::list<CachePage*>& list);
+	};
+
+	//-------------------------------------------------------------------------
+	// Least recently used policy (double linked list)
+	//-------------------------------------------------------------------------
+	class LRUPolicy : public ReplacementPolicy {
+	public:
+		void       onInsert(CachePage* page);
+		void       onAccess(CachePage* page);
+		CachePage* selectVictim();
+		const char* getName() { return "LRU"; }
+	private:
+		std::list<CachePage*> cacheList;         // Pages in recency order
+	};
+
+	//-------------------------------------------------------------------------
+	// CLOCK policy (reference bit, ring over partition pool slice)
+	//-------------------------------------------------------------------------
+	class ClockPolicy : public ReplacementPolicy {
+	public:
+		ClockPolicy(CachePage* pages, size_t capacity);
+		void       onInsert(CachePage* page);
+		void       onAccess(CachePage* page);
+		CachePage* selectVictim();
+		const char* getName() { return "CLOCK"; }
+	private:
+		CachePage* pages;                        // Partition pool slice (ring)
+		size_t     capacity;                     // Ring size
+		size_t     hand;                         // Clock hand position
+	};
+
+	//-------------------------------------------------------------------------
+	// CLOCK-Pro policy (hot/cold pages, test period, adaptive cold target)
+	//-------------------------------------------------------------------------
+	class ClockProPolicy : public ReplacementPolicy {
+	public:
+		ClockProPolicy(CachePage* pages, size_t capacity);
+		void       onInsert(CachePage* page);
+		void       onAccess(CachePage* page);
+		void       onRestore(CachePage* page);
+		CachePage* selectVictim();
+		const char* getName() { return "CLOCK-Pro"; }
+		void       setCapacity(size_t capacity);
+	private:
+		CachePage* evictCold(CachePage* page);
+		void       runHotHand();
+		void       decreaseColdTarget();
+
+		CachePage*  pages;                       // Partition pool slice (ring)
+		size_t      capacity;                    // Ring size
+		size_t      residentLimit;               // Resident pages limit
+		size_t      hotHand;                     // Hot hand position
+		size_t      coldHand;                    // Cold hand position
+		size_t      hotCount;                    // Resident hot pages
+		size_t      coldCount;                   // Resident cold pages
+		size_t      coldTarget;                  // Adaptive resident cold pages target
+		PageHistory history;                     // Evicted cold pages in test period
+	};
+
+	//-------------------------------------------------------------------------
+	// 2Q policy (probationary FIFO queue, main LRU queue, evicted history)
+	//-------------------------------------------------------------------------
+	class TwoQueuePolicy : public ReplacementPolicy {
+	public:
+		TwoQueuePolicy(size_t capacity);
+		void       onInsert(CachePage* page);
+		void       onAccess(CachePage* page);
+		void       onRestore(CachePage* page);
+		CachePage* selectVictim();
+		const char* getName() { return "2Q"; }
+		void       setCapacity(size_t capacity);
+	private:
+		CachePage* evictFrom(std::list<CachePage*>& queue);
+
+		size_t      probationSize;               // Probationary queue target (Kin)
+		std::list<CachePage*> probation;         // Probationary FIFO queue (A1in)
+		std::list<CachePage*> main;              // Main LRU queue (Am)
+		PageHistory history;                     // Evicted probationary pages (A1out)
+	};
+
+	//-------------------------------------------------------------------------
+	// ARC policy (adaptive recency/frequency lists with evicted histories)
+	//-------------------------------------------------------------------------
+	class ArcPolicy : public ReplacementPolicy {
+	public:
+		ArcPolicy(size_t capacity);
+		void       onMiss(size_t filePageNo);
+		void       onInsert(CachePage* page);
+		void       onAccess(CachePage* page);
+		void       onRestore(CachePage* page);
+		CachePage* selectVictim();
+		const char* getName() { return "ARC"; }
+		void       setCapacity(size_t capacity);
+	private:
+		CachePage* evictFrom(std::list<CachePage*>& list, PageHistory& history);
+
+		size_t      capacity;                    // Partition capacity (c)
+		size_t      recentTarget;                // Adaptive recency list target (p)
+		bool        frequentGhostHit;            // Last miss found in frequency history
+		std::list<CachePage*> recent;            // Pages referenced once (T1)
+		std::list<CachePage*> frequent;          // Pages referenced twice or more (T2)
+		PageHistory recentHistory;               // Evicted from recency list (B1)
+		PageHistory frequentHistory;             // Evicted from frequency list (B2)
+	};
+
+	//-------------------------------------------------------------------------
+	// W-TinyLFU policy (admission window, frequency filter, segmented LRU)
+	//-------------------------------------------------------------------------
+	class TinyLfuPolicy : public ReplacementPolicy {
+	public:
+		TinyLfuPolicy(size_t capacity);
+		void       onMiss(size_t filePageNo);
+		void       onInsert(CachePage* page);
+		void       onAccess(CachePage* page);
+		CachePage* selectVictim();
+		const char* getName() { return "W-TinyLFU"; }
+		uint64_t   getAdmissionsRejected() { return admissionsRejected; }
+		void       resetStats() { admissionsRejected = 0; }
+		void       setCapacity(size_t capacity);
+	private:
+		void       admit(CachePage* page);
+		CachePage* evict(CachePage* page);
+
+		size_t      windowCapacity;              // Admission window capacity
+		size_t      mainCapacity;                // Main segmented LRU capacity
+		size_t      protectedCapacity;           // Protected segment capacity
+		uint64_t    admissionsRejected;          // Window pages not admitted to main
+		std::list<CachePage*> window;            // Admission window (LRU)
+		std::list<CachePage*> probation;         // Main cache probation segment (LRU)
+		std::list<CachePage*> protect;           // Main cache protected segment (LRU)
+		FrequencySketch sketch;                  // Pages access frequency
+	};
+
+}
@@ -0,0 +1,159 @@
+/******************************************************************************
+*
+*  StdioBackend class implementation
+*
+*  Portable storage backend based on C standard library stdio. Every
+*  positional operation costs seek plus read/write call, so it is used
+*  only where native positional I/O backend is not available. Seek and
+*  transfer are done under mutex, because stdio has shared file position.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "StorageBackend.h"
+
+using namespace Boson;
+
+
+/**
+* @brief Constructor
+*/
+StdioBackend::StdioBackend() {
+	this->fileHandler = nullptr;
+}
+
+
+/**
+* @brief Destructor closes file if it still open
+*/
+StdioBackend::~StdioBackend() {
+	this->close();
+}
+
+
+/**
+*
+*  @brief Opens existing file or creates new one (if write permitted)
+*
+*  @param[in] path     - the name of the file to be opened (path)
+*  @param[in] readOnly - if true, file is opened for reading only
+*
+*  @return true if file opened, false if can't open file
+*
+*/
+bool StdioBackend::open(const char* path, bool readOnly) {
+	if (path == nullptr) return false;
+	if (this->fileHandler != nullptr) close();
+	// try to open existing file for binary read (or update)
+	this->fileHandler = std::fopen(path, readOnly ? "rb" : "r+b");
+	// if file does not exist or another problem
+	if (this->fileHandler == nullptr) {
+		// if can`t open file in read only mode return false
+		if (readOnly) return false;
+		// try to create new file for binary write/read
+		this->fileHandler = std::fopen(path, "w+b");
+		if (this->fileHandler == nullptr) return false;
+	}
+	// set mode to no buffering, CachedFileIO manages buffers and caching
+	setvbuf(this->fileHandler, nullptr, _IONBF, 0);
+	return true;
+}
+
+
+/**
+*  @brief Closes file
+*  @return true if file closed, false if file has not been opened
+*/
+bool StdioBackend::close() {
+	if (this->fileHandler == nullptr) return false;
+	std::fclose(this->fileHandler);
+	this->fileHandler = nullptr;
+	return true;
+}
+
+
+/**
+*  @brief Checks if file is open
+*  @return true - if file open, false - otherwise
+*/
+bool StdioBackend::isOpen() {
+	return this->fileHandler != nullptr;
+}
+
+
+/**
+*
+*  @brief Reads data at given offset of the file
+*
+*  @param[in]  offset - offset from beginning of the file
+*  @param[out] buffer - data buffer where data copied
+*  @param[in]  length - data amount to read
+*
+*  @return bytes actually read (less than length at the end of file)
+*
+*/
+size_t StdioBackend::read(uint64_t offset, void* buffer, size_t length) {
+	if (this->fileHandler == nullptr) return 0;
+	std::lock_guard<std::mutex> lock(this->positionMutex);
+	if (!seek(offset, SEEK_SET)) return 0;
+	return std::fread(buffer, 1, length, this->fileHandler);
+}
+
+
+/**
+*
+*  @brief Writes data at given offset of the file
+*
+*  @param[in] offset - offset from beginning of the file
+*  @param[in] buffer - data buffer with write data
+*  @param[in] length - data amount to write
+*
+*  @return bytes actually written
+*
+*/
+size_t StdioBackend::write(uint64_t offset, const void* buffer, size_t length) {
+	if (this->fileHandler == nullptr) return 0;
+	std::lock_guard<std::mutex> lock(this->positionMutex);
+	if (!seek(offset, SEEK_SET)) return 0;
+	return std::fwrite(buffer, 1, length, this->fileHandler);
+}
+
+
+/**
+*  @brief Flushes stdio buffers to operating system
+*  @return true if succeeded, false otherwise
+*/
+bool StdioBackend::sync() {
+	if (this->fileHandler == nullptr) return false;
+	return std::fflush(this->fileHandler) == 0;
+}
+
+
+/**
+*  @brief Get current file size
+*  @return actual file size in bytes
+*/
+uint64_t StdioBackend::getSize() {
+	if (this->fileHandler == nullptr) return 0;
+	std::lock_guard<std::mutex> lock(this->positionMutex);
+	if (!seek(0, SEEK_END)) return 0;
+#ifdef _WIN32
+	return (uint64_t)_ftelli64(this->fileHandler);
+#else
+	return (uint64_t)ftello(this->fileHandler);
+#endif
+}
+
+
+/**
+*  @brief Moves file position (64-bit offsets on every platform)
+*  @return true if succeeded, false otherwise
+*/
+bool StdioBackend::seek(uint64_t offset, int origin) {
+#ifdef _WIN32
+	return _fseeki64(this->fileHandler, (int64_t)offset, origin) == 0;
+#else
+	return fseeko(this->fileHandler, (off_t)offset, origin) == 0;
+#endif
+}
@@ -0,0 +1,103 @@
+/******************************************************************************
+*
+*  StorageBackend factory and default methods implementation
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "StorageBackend.h"
+
+using namespace Boson;
+
+
+/**
+*
+*  @brief Creates storage backend of requested type
+*
+*  @param[in] type - storage backend type (DEFAULT_BACKEND is platform native)
+*
+*  @return new storage backend instance (caller owns) or nullptr if not supported
+*
+*/
+StorageBackend* StorageBackend::create(StorageBackendType type) {
+	switch (type) {
+	case StorageBackendType::DEFAULT_BACKEND:
+#ifdef _WIN32
+		return new StdioBackend();
+#else
+		return new PosixBackend();
+#endif
+	case StorageBackendType::STDIO_BACKEND:
+		return new StdioBackend();
+	case StorageBackendType::POSIX_BACKEND:
+#ifdef _WIN32
+		return nullptr;
+#else
+		return new PosixBackend();
+#endif
+	case StorageBackendType::MAPPED_BACKEND:
+#ifdef _WIN32
+		return nullptr;
+#else
+		return new MappedBackend();
+#endif
+	case StorageBackendType::DIRECT_BACKEND:
+#ifdef _WIN32
+		return nullptr;
+#else
+		return new DirectBackend();
+#endif
+	case StorageBackendType::MEMORY_BACKEND:
+		return new MemoryBackend();
+	}
+	return nullptr;
+}
+
+
+
+/**
+*
+*  @brief Reads contiguous file range into several buffers (scatter read).
+*  Default implementation reads buffers one by one.
+*
+*  @param[in] offset  - offset from beginning of the file
+*  @param[in] buffers - destination buffers in file order
+*  @param[in] count   - buffers count
+*
+*  @return total bytes actually read (stops at end of file)
+*
+*/
+size_t StorageBackend::readVector(uint64_t offset, const IOBuffer* buffers, size_t count) {
+	size_t totalRead = 0;
+	for (size_t i = 0; i < count; i++) {
+		size_t bytesRead = read(offset + totalRead, buffers[i].data, buffers[i].length);
+		totalRead += bytesRead;
+		if (bytesRead < buffers[i].length) break;
+	}
+	return totalRead;
+}
+
+
+
+/**
+*
+*  @brief Writes several buffers to contiguous file range (gather write).
+*  Default implementation writes buffers one by one.
+*
+*  @param[in] offset  - offset from beginning of the file
+*  @param[in] buffers - source buffers in file order
+*  @param[in] count   - buffers count
+*
+*  @return total bytes actually written (stops on first failed write)
+*
+*/
+size_t StorageBackend::writeVector(uint64_t offset, const IOBuffer* buffers, size_t count) {
+	size_t totalWritten = 0;
+	for (size_t i = 0; i < count; i++) {
+		size_t bytesWritten = write(offset + totalWritten, buffers[i].data, buffers[i].length);
+		totalWritten += bytesWritten;
+		if (bytesWritten < buffers[i].length) break;
+	}
+	return totalWritten;
+}
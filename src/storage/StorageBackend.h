@@ -0,0 +1,227 @@
+/******************************************************************************
+*
+*  StorageBackend classes header
+*
+*  StorageBackend is the low level positional I/O layer under CachedFileIO.
+*  CachedFileIO manages pages and caching, while storage backend moves
+*  bytes between page buffers and storage device. Every operation takes
+*  explicit offset, so backend has no shared file position state and
+*  page loads cost single system call where platform allows it.
+*
+*  Backends:
+*    - StdioBackend - portable C standard library stdio (seek + read/write)
+*    - PosixBackend - POSIX open/pread/pwrite/fdatasync on raw descriptor,
+*      file space is preallocated in large chunks (Linux fallocate) while
+*      file size stays exact, unused tail is trimmed on close
+*    - MappedBackend - read only memory mapped file (mmap), data is
+*      addressed in place and shared with other processes via OS page cache
+*    - DirectBackend - POSIX positional I/O with O_DIRECT, block aligned
+*      transfers bypass OS page cache, so CachedFileIO is the only cache
+*    - MemoryBackend - in-memory database, growable arena of zeroed chunks
+*      (no system calls), optionally loaded from and saved to snapshot file
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <vector>
+
+namespace Boson {
+
+	//-------------------------------------------------------------------------
+
+	typedef enum {                              // Storage backend types
+		DEFAULT_BACKEND = 0,                    // Native backend of platform
+		STDIO_BACKEND   = 1,                    // C standard library stdio
+		POSIX_BACKEND   = 2,                    // POSIX positional I/O
+		MAPPED_BACKEND  = 3,                    // Read only memory mapped file
+		DIRECT_BACKEND  = 4,                    // Direct I/O bypassing OS page cache
+		MEMORY_BACKEND  = 5                     // In-memory arena (optional snapshot file)
+	} StorageBackendType;
+
+	constexpr size_t DIRECT_IO_ALIGNMENT = 4096; // Direct I/O buffer/offset alignment
+	constexpr size_t MEMORY_CHUNK_SIZE = 1024 * 1024; // In-memory arena chunk size
+	constexpr uint64_t FILE_GROWTH_INCREMENT = 4 * 1024 * 1024;   // Preallocation chunk (default)
+	constexpr double   FILE_GROWTH_PERCENT   = 0.10;              // Preallocation share of file size
+	constexpr uint64_t FILE_GROWTH_MAX_CHUNK = 1024 * 1024 * 1024; // Preallocation chunk limit
+
+	typedef struct {                            // Scatter/gather I/O buffer
+		void*  data;                            // Buffer pointer
+		size_t length;                          // Buffer length
+	} IOBuffer;
+
+	typedef enum {                              // Expected access pattern hint
+		NORMAL_ACCESS     = 0,                  // No special treatment
+		RANDOM_ACCESS     = 1,                  // Random page access (no readahead)
+		SEQUENTIAL_ACCESS = 2                   // Sequential scans (aggressive readahead)
+	} AccessPattern;
+
+	//-------------------------------------------------------------------------
+	// Storage backend interface (positional I/O)
+	//-------------------------------------------------------------------------
+	class StorageBackend {
+	public:
+		virtual ~StorageBackend() {}
+
+		virtual bool     open(const char* path, bool readOnly) = 0;
+		virtual bool     close() = 0;
+		virtual bool     isOpen() = 0;
+		virtual size_t   read(uint64_t offset, void* buffer, size_t length) = 0;
+		virtual size_t   write(uint64_t offset, const void* buffer, size_t length) = 0;
+		virtual bool     sync() = 0;
+		virtual uint64_t getSize() = 0;
+		virtual size_t   readVector(uint64_t offset, const IOBuffer* buffers, size_t count);
+		virtual size_t   writeVector(uint64_t offset, const IOBuffer* buffers, size_t count);
+		virtual bool     advise(AccessPattern pattern) { return false; }
+		virtual const uint8_t* getMappedData() { return nullptr; }
+		virtual uint8_t* getMemoryData(uint64_t offset, size_t& length) { return nullptr; }
+		virtual int      getDescriptor() { return -1; }
+		virtual bool     isPersistent() { return true; }
+		virtual bool     snapshot(const char* path) { return false; }
+		virtual bool     setGrowthPolicy(uint64_t increment, double percent) { return false; }
+
+		static StorageBackend* create(StorageBackendType type);
+	};
+
+	//-------------------------------------------------------------------------
+	// Portable stdio backend (seek + fread/fwrite)
+	//-------------------------------------------------------------------------
+	class StdioBackend : public StorageBackend {
+	public:
+		StdioBackend();
+		~StdioBackend();
+
+		bool     open(const char* path, bool readOnly);
+		bool     close();
+		bool     isOpen();
+		size_t   read(uint64_t offset, void* buffer, size_t length);
+		size_t   write(uint64_t offset, const void* buffer, size_t length);
+		bool     sync();
+		uint64_t getSize();
+
+	private:
+		bool     seek(uint64_t offset, int origin);
+		std::FILE* fileHandler;                  // OS file handler
+		std::mutex positionMutex;                // Guards shared file position
+	};
+
+	//-------------------------------------------------------------------------
+	// In-memory backend (growable chunked arena, optional snapshot file)
+	//-------------------------------------------------------------------------
+	class MemoryBackend : public StorageBackend {
+	public:
+		MemoryBackend();
+		~MemoryBackend();
+
+		bool     open(const char* path, bool readOnly);
+		bool     close();
+		bool     isOpen();
+		size_t   read(uint64_t offset, void* buffer, size_t length);
+		size_t   write(uint64_t offset, const void* buffer, size_t length);
+		bool     sync() { return true; }
+		uint64_t getSize();
+		bool     isPersistent() { return false; }
+		uint8_t* getMemoryData(uint64_t offset, size_t& length);
+		bool     snapshot(const char* path);
+
+	private:
+		bool     load(const char* path, bool& missing);
+		bool     reserve(uint64_t size);
+		void     release();
+
+		std::vector<uint8_t*> chunks;            // Arena chunks (MEMORY_CHUNK_SIZE)
+		std::atomic<uint64_t> dataSize;          // Data size (end of last write)
+		std::shared_mutex     arenaMutex;        // Guards chunks table growth
+		bool     opened;                         // Arena is open
+		bool     readOnly;                       // Writes are not allowed
+	};
+
+#ifndef _WIN32
+	//-------------------------------------------------------------------------
+	// POSIX positional I/O backend (pread/pwrite on raw descriptor)
+	//-------------------------------------------------------------------------
+	class PosixBackend : public StorageBackend {
+	public:
+		PosixBackend();
+		~PosixBackend();
+
+		bool     open(const char* path, bool readOnly);
+		bool     close();
+		bool     isOpen();
+		size_t   read(uint64_t offset, void* buffer, size_t length);
+		size_t   write(uint64_t offset, const void* buffer, size_t length);
+		bool     sync();
+		uint64_t getSize();
+		size_t   readVector(uint64_t offset, const IOBuffer* buffers, size_t count);
+		size_t   writeVector(uint64_t offset, const IOBuffer* buffers, size_t count);
+		bool     advise(AccessPattern pattern);
+		int      getDescriptor() { return fileDescriptor; }
+		bool     setGrowthPolicy(uint64_t increment, double percent);
+
+	protected:
+		void     preallocate(uint64_t endOffset);
+		void     trimPreallocated();
+
+		int      fileDescriptor;                 // OS file descriptor
+		std::atomic<uint64_t> preallocatedEnd;   // End of preallocated file space
+		uint64_t growthIncrement;                // Minimal preallocation chunk (bytes)
+		double   growthPercent;                  // Preallocation chunk share of file size
+		std::mutex growthMutex;                  // Serializes preallocations
+	};
+
+	//-------------------------------------------------------------------------
+	// Direct I/O backend (O_DIRECT, bypasses OS page cache)
+	//-------------------------------------------------------------------------
+	class DirectBackend : public PosixBackend {
+	public:
+		DirectBackend();
+		~DirectBackend();
+
+		bool     open(const char* path, bool readOnly);
+		bool     close();
+		size_t   read(uint64_t offset, void* buffer, size_t length);
+		size_t   write(uint64_t offset, const void* buffer, size_t length);
+		size_t   readVector(uint64_t offset, const IOBuffer* buffers, size_t count);
+		size_t   writeVector(uint64_t offset, const IOBuffer* buffers, size_t count);
+		bool     advise(AccessPattern pattern) { return false; }
+		bool     isDirect() { return bufferedDescriptor >= 0; }
+
+	private:
+		bool     isAligned(uint64_t offset, const void* buffer, size_t length);
+		int      bufferedDescriptor;             // Descriptor for unaligned transfers
+	};
+
+	//-------------------------------------------------------------------------
+	// Read only memory mapped file backend (mmap + madvise)
+	//-------------------------------------------------------------------------
+	class MappedBackend : public StorageBackend {
+	public:
+		MappedBackend();
+		~MappedBackend();
+
+		bool     open(const char* path, bool readOnly);
+		bool     close();
+		bool     isOpen();
+		size_t   read(uint64_t offset, void* buffer, size_t length);
+		size_t   write(uint64_t offset, const void* buffer, size_t length);
+		bool     sync();
+		uint64_t getSize();
+		bool     advise(AccessPattern pattern);
+		const uint8_t* getMappedData();
+
+	private:
+		int       fileDescriptor;                // OS file descriptor
+		uint8_t*  mappedData;                    // Mapped file region
+		uint64_t  mappedSize;                    // Mapped file size
+	};
+#endif
+
+}
@@ -0,0 +1,243 @@
+/******************************************************************************
+*
+*  TinyLfuPolicy and FrequencySketch classes implementation
+*
+*  W-TinyLFU (G. Einziger, R. Friedman, B. Manes, 2017) places every new
+*  page to a small LRU admission window. Page leaving the window competes
+*  with the victim of the main segmented LRU cache (probation and protected
+*  segments): it is admitted only if its estimated access frequency is
+*  higher, otherwise it is evicted and the main cache stays untouched.
+*  Frequencies are estimated by count-min sketch of 4-bit counters, all
+*  counters are halved periodically, so the history ages out.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "ReplacementPolicy.h"
+#include "CachedFileIO.h"
+
+#include <algorithm>
+
+using namespace Boson;
+
+//-----------------------------------------------------------------------------
+static const uint64_t SKETCH_SEEDS[4] = {        // Sketch rows hash seeds
+	0xc3a5c85c97cb3127ull, 0xb492b66fbe98f273ull,
+	0x9ae16a3b2f90404full, 0xcbf29ce484222325ull
+};
+static const uint64_t SKETCH_RESET_MASK = 0x7777777777777777ull; // Halved counters mask
+//-----------------------------------------------------------------------------
+
+
+//=============================================================================
+//
+//                       Count-min frequency sketch
+//
+//=============================================================================
+
+/**
+*  @brief Constructor
+*  @param[in] capacity - cache capacity (pages) sketch is sized for
+*/
+FrequencySketch::FrequencySketch(size_t capacity) {
+	size_t tableSize = 16;
+	while (tableSize < capacity) tableSize *= 2;
+	this->table.assign(tableSize, 0);
+	this->tableMask = tableSize - 1;
+	this->additions = 0;
+	this->sampleSize = std::max<size_t>(capacity, 16) * 10;
+}
+
+
+/**
+*
+*  @brief Increments page counters of all sketch rows (saturated at 15),
+*  halves all counters when sample size increments reached
+*
+*  @param[in] filePageNo - accessed file page number
+*
+*/
+void FrequencySketch::increment(size_t filePageNo) {
+	uint64_t hash = uint64_t(filePageNo) * 0x9E3779B97F4A7C15ull;
+	hash ^= hash >> 29;
+	bool added = false;
+	for (size_t i = 0; i < 4; i++) {
+		uint64_t rowHash = (hash + SKETCH_SEEDS[i]) * SKETCH_SEEDS[i];
+		rowHash += rowHash >> 32;
+		uint64_t& word = table[rowHash & tableMask];
+		unsigned shift = unsigned((rowHash >> 40) & 15) << 2;
+		uint64_t mask = 0xFull << shift;
+		if ((word & mask) != mask) {
+			word += 1ull << shift;
+			added = true;
+		}
+	}
+	if (added && ++additions >= sampleSize) age();
+}
+
+
+/**
+*
+*  @brief Estimates page access frequency (minimal counter of sketch rows)
+*
+*  @param[in] filePageNo - file page number
+*
+*  @return estimated access frequency (0-15)
+*
+*/
+uint32_t FrequencySketch::frequency(size_t filePageNo) {
+	uint64_t hash = uint64_t(filePageNo) * 0x9E3779B97F4A7C15ull;
+	hash ^= hash >> 29;
+	uint32_t result = 15;
+	for (size_t i = 0; i < 4; i++) {
+		uint64_t rowHash = (hash + SKETCH_SEEDS[i]) * SKETCH_SEEDS[i];
+		rowHash += rowHash >> 32;
+		unsigned shift = unsigned((rowHash >> 40) & 15) << 2;
+		uint32_t counter = uint32_t((table[rowHash & tableMask] >> shift) & 0xF);
+		result = std::min(result, counter);
+	}
+	return result;
+}
+
+
+/**
+*  @brief Halves all counters (history aging)
+*/
+void FrequencySketch::age() {
+	for (uint64_t& word : table) word = (word >> 1) & SKETCH_RESET_MASK;
+	additions /= 2;
+}
+
+
+//=============================================================================
+//
+//                            W-TinyLFU policy
+//
+//=============================================================================
+
+/**
+*  @brief Constructor
+*  @param[in] capacity - partition capacity (pages)
+*/
+TinyLfuPolicy::TinyLfuPolicy(size_t capacity) : sketch(capacity) {
+	this->windowCapacity = std::max<size_t>(capacity / 100, 1);
+	this->mainCapacity = capacity > windowCapacity ? capacity - windowCapacity : 1;
+	this->protectedCapacity = std::max<size_t>(mainCapacity * 8 / 10, 1);
+	this->admissionsRejected = 0;
+}
+
+
+/**
+*  @brief Rescales admission window and main cache segments to new capacity
+*  @param[in] capacity - partition capacity (pages)
+*/
+void TinyLfuPolicy::setCapacity(size_t capacity) {
+	this->windowCapacity = std::max<size_t>(capacity / 100, 1);
+	this->mainCapacity = capacity > windowCapacity ? capacity - windowCapacity : 1;
+	this->protectedCapacity = std::max<size_t>(mainCapacity * 8 / 10, 1);
+}
+
+
+/**
+*  @brief Counts page access on cache miss
+*/
+void TinyLfuPolicy::onMiss(size_t filePageNo) {
+	sketch.increment(filePageNo);
+}
+
+
+/**
+*  @brief Places loaded page to the front of admission window
+*/
+void TinyLfuPolicy::onInsert(CachePage* page) {
+	window.push_front(page);
+	page->it = window.begin();
+	page->policyState = POLICY_RESIDENT | POLICY_WINDOW;
+}
+
+
+/**
+*
+*  @brief Counts page access and moves page to the front of its segment,
+*  probation page is promoted to protected segment (protected segment
+*  overflow is demoted back to probation)
+*
+*/
+void TinyLfuPolicy::onAccess(CachePage* page) {
+	sketch.increment(page->filePageNo);
+	if (page->policyState & POLICY_WINDOW) {
+		window.splice(window.begin(), window, page->it);
+	} else if (page->policyState & POLICY_PROTECTED) {
+		protect.splice(protect.begin(), protect, page->it);
+	} else {
+		protect.splice(protect.begin(), probation, page->it);
+		page->policyState |= POLICY_PROTECTED;
+		if (protect.size() > protectedCapacity) {
+			CachePage* demoted = protect.back();
+			probation.splice(probation.begin(), protect, demoted->it);
+			demoted->policyState &= ~POLICY_PROTECTED;
+		}
+	}
+}
+
+
+/**
+*
+*  @brief Makes room in admission window for new page: window victim is
+*  admitted to main cache while it has room, otherwise it competes with
+*  main cache victim and less frequently accessed page is evicted
+*
+*  @return victim page or nullptr if all pages are pinned
+*
+*/
+CachePage* TinyLfuPolicy::selectVictim() {
+	for (;;) {
+		// window has room for new page: evict from main cache
+		CachePage* candidate = window.size() >= windowCapacity ? lastUnpinned(window) : nullptr;
+		if (candidate == nullptr) {
+			CachePage* victim = lastUnpinned(probation);
+			if (victim == nullptr) victim = lastUnpinned(protect);
+			if (victim == nullptr) victim = lastUnpinned(window);
+			return victim == nullptr ? nullptr : evict(victim);
+		}
+		// main cache has room: admit window victim without eviction
+		if (probation.size() + protect.size() < mainCapacity) {
+			admit(candidate);
+			continue;
+		}
+		// window victim competes with main cache victim
+		CachePage* victim = lastUnpinned(probation);
+		if (victim == nullptr) victim = lastUnpinned(protect);
+		if (victim == nullptr) return evict(candidate);
+		if (sketch.frequency(candidate->filePageNo) > sketch.frequency(victim->filePageNo)) {
+			evict(victim);
+			admit(candidate);
+			return victim;
+		}
+		admissionsRejected++;
+		return evict(candidate);
+	}
+}
+
+
+/**
+*  @brief Moves window page to the front of main cache probation segment
+*/
+void TinyLfuPolicy::admit(CachePage* page) {
+	probation.splice(probation.begin(), window, page->it);
+	page->policyState = POLICY_RESIDENT;
+}
+
+
+/**
+*  @brief Removes page from its segment
+*  @return evicted page
+*/
+CachePage* TinyLfuPolicy::evict(CachePage* page) {
+	if (page->policyState & POLICY_WINDOW) window.erase(page->it);
+	else if (page->policyState & POLICY_PROTECTED) protect.erase(page->it);
+	else probation.erase(page->it);
+	page->policyState = 0;
+	return page;
+}
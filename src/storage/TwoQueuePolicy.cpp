@@ -0,0 +1,121 @@
+/******************************************************************************
+*
+*  TwoQueuePolicy class implementation
+*
+*  2Q (T. Johnson, D. Shasha, 1994) is a scan resistant replacement policy.
+*  New page is placed to the probationary FIFO queue. When probationary page
+*  is evicted, its number is remembered in history. Only page loaded again
+*  while it is in history is placed to the main LRU queue, so pages touched
+*  once by sequential scans never push out hot pages of the main queue.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "ReplacementPolicy.h"
+#include "CachedFileIO.h"
+
+using namespace Boson;
+
+
+/**
+*  @brief Constructor
+*  @param[in] capacity - partition capacity (pages)
+*/
+TwoQueuePolicy::TwoQueuePolicy(size_t capacity) : history(capacity / 2) {
+	this->probationSize = capacity / 4 < 1 ? 1 : capacity / 4;
+}
+
+
+/**
+*  @brief Rescales probationary queue target and history to new capacity
+*  @param[in] capacity - partition capacity (pages)
+*/
+void TwoQueuePolicy::setCapacity(size_t capacity) {
+	this->probationSize = capacity / 4 < 1 ? 1 : capacity / 4;
+	history.shrink(capacity / 2);
+}
+
+
+/**
+*
+*  @brief Places loaded page to the main queue if it has been recently
+*  evicted from probationary queue, otherwise to the probationary queue
+*
+*/
+void TwoQueuePolicy::onInsert(CachePage* page) {
+	if (history.remove(page->filePageNo)) {
+		main.push_front(page);
+		page->it = main.begin();
+		page->policyState = POLICY_RESIDENT | POLICY_PROTECTED;
+	} else {
+		probation.push_front(page);
+		page->it = probation.begin();
+		page->policyState = POLICY_RESIDENT;
+	}
+}
+
+
+/**
+*
+*  @brief Moves main queue page to the front of the queue. Probationary
+*  pages keep FIFO order (correlated references don't promote page).
+*
+*/
+void TwoQueuePolicy::onAccess(CachePage* page) {
+	if (page->policyState & POLICY_PROTECTED) main.splice(main.begin(), main, page->it);
+}
+
+
+/**
+*
+*  @brief Returns not evicted victim to the probationary queue, history entry
+*  added on its eviction is dropped (page is not promoted to main queue)
+*
+*/
+void TwoQueuePolicy::onRestore(CachePage* page) {
+	history.remove(page->filePageNo);
+	probation.push_front(page);
+	page->it = probation.begin();
+	page->policyState = POLICY_RESIDENT;
+}
+
+
+/**
+*
+*  @brief Evicts probationary page if probationary queue exceeds its target,
+*  otherwise least recently used page of the main queue
+*
+*  @return victim page or nullptr if all pages are pinned
+*
+*/
+CachePage* TwoQueuePolicy::selectVictim() {
+	CachePage* victim = nullptr;
+	if (probation.size() > probationSize || main.empty()) {
+		victim = evictFrom(probation);
+		if (victim != nullptr) return victim;
+	}
+	victim = evictFrom(main);
+	if (victim == nullptr) victim = evictFrom(probation);
+	return victim;
+}
+
+
+/**
+*
+*  @brief Removes oldest not pinned (preferably clean) page from the queue,
+*  evicted probationary page is remembered in history
+*
+*  @param[in] queue - probationary or main queue
+*
+*  @return victim page or nullptr if all queue pages are pinned
+*
+*/
+CachePage* TwoQueuePolicy::evictFrom(std::list<CachePage*>& queue) {
+	CachePage* page = lastUnpinned(queue);
+	if (page == nullptr) return nullptr;
+	if (!(page->policyState & POLICY_PROTECTED)) history.add(page->filePageNo);
+	queue.erase(page->it);
+	page->policyState = 0;
+	return page;
+}
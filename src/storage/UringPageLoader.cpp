@@ -0,0 +1,282 @@
+/******************************************************************************
+*
+*  UringPageLoader class implementation
+*
+*  Linux io_uring based page loader. All page reads of a batch are placed
+*  to the submission queue and handed to the kernel with single system
+*  call, then completions are reaped from the completion queue. Rings are
+*  set up with raw system calls, so there is no liburing dependency. If
+*  kernel does not support io_uring (or it is disabled), loader reports
+*  it is not ready and thread pool loader is used instead.
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#ifdef __linux__
+
+#include "AsyncPageLoader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace Boson;
+
+
+//-----------------------------------------------------------------------------
+// io_uring system calls wrappers
+//-----------------------------------------------------------------------------
+
+static int uringSetup(unsigned entries, struct io_uring_params* params) {
+#ifdef __NR_io_uring_setup
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+static int uringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+#ifdef __NR_io_uring_enter
+	return (int)syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0);
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+
+/**
+*
+*  @brief Sets up io_uring instance and maps its rings
+*
+*  @param[in] fileDescriptor - file descriptor to read pages from
+*  @param[in] backend        - storage backend to complete short reads
+*  @param[in] queueDepth     - submission queue entries
+*
+*/
+UringPageLoader::UringPageLoader(int fileDescriptor, StorageBackend* backend, unsigned queueDepth) {
+	this->backend = backend;
+	this->fileDescriptor = fileDescriptor;
+	this->ringDescriptor = -1;
+	this->ringEntries = 0;
+	this->inFlight = 0;
+	this->toSubmit = 0;
+	this->sqRing = this->cqRing = this->sqEntries = nullptr;
+	this->sqRingSize = this->cqRingSize = this->sqEntriesSize = 0;
+
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	int ringFd = uringSetup(queueDepth, &params);
+	if (ringFd < 0) return;
+	this->ringDescriptor = ringFd;
+	this->ringEntries = params.sq_entries;
+
+	// Map submission and completion queue rings (single mapping if supported)
+	sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMapping) {
+		if (cqRingSize > sqRingSize) sqRingSize = cqRingSize;
+		cqRingSize = sqRingSize;
+	}
+	sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+	if (sqRing == MAP_FAILED) { sqRing = nullptr; return; }
+	if (singleMapping) {
+		cqRing = sqRing;
+	} else {
+		cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		if (cqRing == MAP_FAILED) { cqRing = nullptr; return; }
+	}
+	sqEntriesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	sqEntries = mmap(nullptr, sqEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+	if (sqEntries == MAP_FAILED) { sqEntries = nullptr; return; }
+
+	// Resolve ring fields pointers
+	uint8_t* sq = (uint8_t*)sqRing;
+	uint8_t* cq = (uint8_t*)cqRing;
+	sqHead = (unsigned*)(sq + params.sq_off.head);
+	sqTail = (unsigned*)(sq + params.sq_off.tail);
+	sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+	sqArray = (unsigned*)(sq + params.sq_off.array);
+	cqHead = (unsigned*)(cq + params.cq_off.head);
+	cqTail = (unsigned*)(cq + params.cq_off.tail);
+	cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+	cqEntries = cq + params.cq_off.cqes;
+}
+
+
+/**
+*  @brief Completes in-flight requests, unmaps rings and closes io_uring
+*/
+UringPageLoader::~UringPageLoader() {
+	if (isReady()) {
+		abandonUnsubmitted();
+		while (inFlight > 0 && enter(0, 1)) reapCompletions();
+	}
+	if (sqEntries != nullptr) munmap(sqEntries, sqEntriesSize);
+	if (cqRing != nullptr && cqRing != sqRing) munmap(cqRing, cqRingSize);
+	if (sqRing != nullptr) munmap(sqRing, sqRingSize);
+	if (ringDescriptor >= 0) ::close(ringDescriptor);
+}
+
+
+/**
+*  @brief Checks if io_uring instance is set up and rings are mapped
+*  @return true if loader is ready to use, false otherwise
+*/
+bool UringPageLoader::isReady() {
+	return ringDescriptor >= 0 && sqRing != nullptr && cqRing != nullptr && sqEntries != nullptr;
+}
+
+
+/**
+*
+*  @brief Places all batch requests to submission queue and submits them
+*  to the kernel with single io_uring_enter call (if they fit the ring)
+*
+*  @param[in] batch - batch of page read requests
+*
+*  @return true if batch submitted, false if loader is not ready
+*
+*/
+bool UringPageLoader::submit(PageReadBatch& batch) {
+	if (!isReady() || batch.submitted) return false;
+	std::lock_guard<std::mutex> lock(ringMutex);
+	batch.submitted = true;
+	for (PageReadRequest& request : batch.requests) {
+		request.batch = &batch;
+		if (!pushRequest(&request)) backlog.push_back(&request);
+	}
+	if (toSubmit > 0) enter(toSubmit, 0);
+	return true;
+}
+
+
+/**
+*  @brief Reaps completions until all batch requests are completed
+*  @param[in] batch - submitted batch of page read requests
+*/
+void UringPageLoader::wait(PageReadBatch& batch) {
+	if (!batch.submitted) return;
+	for (;;) {
+		// ring is shared: completions reaped by any waiter complete all batches
+		std::lock_guard<std::mutex> lock(ringMutex);
+		if (batch.isCompleted()) break;
+		// refill ring from backlog and wait for at least one completion
+		while (!backlog.empty() && pushRequest(backlog.front())) backlog.pop_front();
+		if (!enter(toSubmit, inFlight > 0 ? 1 : 0)) {
+			// kernel refused: complete not submitted requests synchronously
+			abandonUnsubmitted();
+			if (inFlight == 0 || !enter(0, 1)) break;
+		}
+		reapCompletions();
+	}
+}
+
+
+/**
+*  @brief Takes back queued but not submitted requests (and backlog) from
+*  the submission queue and completes them synchronously
+*/
+void UringPageLoader::abandonUnsubmitted() {
+	unsigned tail = *sqTail;
+	for (unsigned i = tail - toSubmit; i != tail; i++) {
+		struct io_uring_sqe* sqe = &((struct io_uring_sqe*)sqEntries)[sqArray[i & *sqMask]];
+		completeRequest((PageReadRequest*)(uintptr_t)sqe->user_data, -EIO);
+	}
+	__atomic_store_n(sqTail, tail - toSubmit, __ATOMIC_RELEASE);
+	toSubmit = 0;
+	while (!backlog.empty()) {
+		completeRequest(backlog.front(), -EIO);
+		backlog.pop_front();
+	}
+}
+
+
+/**
+*  @brief Places read request into submission queue
+*  @return true if request placed, false if ring is full
+*/
+bool UringPageLoader::pushRequest(PageReadRequest* request) {
+	// keep completion queue from overflowing
+	if (inFlight + toSubmit >= ringEntries) return false;
+	unsigned tail = *sqTail;
+	unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+	if (tail - head >= ringEntries) return false;
+	unsigned index = tail & *sqMask;
+	struct io_uring_sqe* sqe = &((struct io_uring_sqe*)sqEntries)[index];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = fileDescriptor;
+	sqe->off = request->offset;
+	sqe->addr = (uint64_t)(uintptr_t)request->buffer;
+	sqe->len = (uint32_t)request->length;
+	sqe->user_data = (uint64_t)(uintptr_t)request;
+	sqArray[index] = index;
+	__atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+	toSubmit++;
+	return true;
+}
+
+
+/**
+*  @brief Submits queued requests and optionally waits for completions
+*  @return true if succeeded, false if kernel returned an error
+*/
+bool UringPageLoader::enter(unsigned submitCount, unsigned minComplete) {
+	if (submitCount == 0 && minComplete == 0) return true;
+	unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+	int result;
+	do {
+		result = uringEnter(ringDescriptor, submitCount, minComplete, flags);
+	} while (result < 0 && errno == EINTR);
+	if (result < 0) return false;
+	toSubmit -= (unsigned)result;
+	inFlight += (unsigned)result;
+	return true;
+}
+
+
+/**
+*  @brief Reaps all available completions from completion queue
+*/
+void UringPageLoader::reapCompletions() {
+	unsigned head = *cqHead;
+	unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+	while (head != tail) {
+		struct io_uring_cqe* cqe = &((struct io_uring_cqe*)cqEntries)[head & *cqMask];
+		PageReadRequest* request = (PageReadRequest*)(uintptr_t)cqe->user_data;
+		int result = cqe->res;
+		head++;
+		inFlight--;
+		completeRequest(request, result);
+	}
+	__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+}
+
+
+/**
+*
+*  @brief Completes request: short or failed reads are finished synchronously
+*  through storage backend (end of file gives short read there as well)
+*
+*  @param[in] request - request to complete
+*  @param[in] result  - bytes read by kernel or negative error code
+*
+*/
+void UringPageLoader::completeRequest(PageReadRequest* request, int result) {
+	size_t bytesRead = result > 0 ? (size_t)result : 0;
+	if (bytesRead < request->length && result != 0) {
+		bytesRead += backend->read(request->offset + bytesRead,
+			request->buffer + bytesRead, request->length - bytesRead);
+	}
+	request->bytesRead = bytesRead;
+	request->batch->completed.fetch_add(1, std::memory_order_release);
+}
+
+#endif
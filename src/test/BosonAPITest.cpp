@@ -8,6 +8,7 @@ using namespace Boson;
 BosonAPITest::BosonAPITest(char* path) {
 	//std::remove(path);
 	db.open(path, false);
+	snapshotPath = std::string(path) + ".snapshot";
 }
 
 
@@ -94,6 +95,33 @@ void BosonAPITest::traverseEntries(bool descendingOrder) {
 }
 
 
+void BosonAPITest::inMemoryDatabase() {
+
+	std::cout << "============================================================================================" << std::endl;
+	std::cout << "IN-MEMORY DATABASE\n";
+	std::cout << "============================================================================================" << std::endl;
+
+	// fill in-memory database and save it to snapshot file
+	BosonAPI memoryDb;
+	memoryDb.open(nullptr, false, nullptr, MEMORY_BACKEND);
+	for (int i = 0; i < 1000; i++) memoryDb.insert("In-memory entry number " + std::to_string(i));
+	uint64_t entries = memoryDb.size();
+	bool saved = memoryDb.snapshot((char*)snapshotPath.c_str());
+	memoryDb.close();
+
+	// load snapshot and check entries
+	memoryDb.open((char*)snapshotPath.c_str(), false, nullptr, MEMORY_BACKEND);
+	auto pair = memoryDb.last();
+	bool loaded = memoryDb.size() == entries && pair.second != nullptr &&
+		*pair.second == "In-memory entry number 999";
+	memoryDb.close();
+	std::remove(snapshotPath.c_str());
+
+	std::cout << "Entries: " << entries << ", snapshot saved: " << (saved ? "yes" : "no");
+	std::cout << ", loaded: " << (loaded ? "SUCCESS! :)" : "FAILED :(") << std::endl;
+}
+
+
 void BosonAPITest::run() {
 
 	insertData();
@@ -106,6 +134,8 @@ void BosonAPITest::run() {
 	//db.printTreeState();
 	traverseEntries(true);
 	eraseData();
+
+	inMemoryDatabase();
 	
 	//db.printTreeState();
 }
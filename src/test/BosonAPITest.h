@@ -2,6 +2,7 @@
 
 #include "../api/BosonAPI.h"
 #include <iostream>
+#include <string>
 
 
 using namespace Boson;
@@ -17,7 +18,9 @@ namespace Boson {
 		void insertData();
 		void eraseData();
 		void traverseEntries(bool descendingOrder = false);
+		void inMemoryDatabase();
 		BosonAPI db;
+		std::string snapshotPath;
 	};
 
 }
\ No newline at end of file
@@ -73,6 +73,38 @@ bool CachedFileIOTest::run(size_t samples, size_t jsonSize, double cacheRatio, d
 
 	double stdioPageThroughput = stdioRandomPageReads();
 
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	pageTableLookups();
+
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	adaptiveCacheReads();
+
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	sharedPoolReads();
+
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	warmupReads();
+
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	concurrentReadWrites();
+
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	scanResistance();
+
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	zipfianAdmission();
+
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	coalescedFlush();
+
 	std::this_thread::sleep_for(std::chrono::seconds(1));
 		
 	double ratio = cachedThroughput / stdioThroughput; 
@@ -163,7 +195,7 @@ double CachedFileIOTest::cachedRandomWrites() {
 	std::cout << " of ~" << textLen + 10 << " byte blocks...\n\t";
 	
 	for (int i = 0; i < samplesCount; i++) {
-		_itoa_s(i, &buf[textLen], sizeof(buf)-textLen, 10);
+		snprintf(&buf[textLen], sizeof(buf) - textLen, "%d", i);
 		length = strlen(buf);
 		buf[length] = '\n';
 		buf[length + 1] = '}';
@@ -280,8 +312,8 @@ double CachedFileIOTest::stdioRandomReads() {
 	size_t length, pos = 0;
 	size_t offset;
 
-	errno_t result = fopen_s(&file, this->fileName, "r+b");
-	if (result != 0 || file == nullptr) return -1;
+	file = fopen(this->fileName, "r+b");
+	if (file == nullptr) return -1;
 
 	size_t fileSize = std::filesystem::file_size(this->fileName);
 
@@ -382,8 +414,8 @@ double CachedFileIOTest::stdioRandomPageReads() {
 
 	FILE* file = nullptr;
 
-	errno_t result = fopen_s(&file, this->fileName, "r+b");
-	if (result != 0 || file == nullptr) return -1;
+	file = fopen(this->fileName, "r+b");
+	if (file == nullptr) return -1;
 	
 	std::cout << "[TEST]  STDIO random PAGE ALIGNED read " << samplesCount;
 	std::cout << " of " << PAGE_SIZE << " byte blocks...\n\t";
@@ -430,3 +462,495 @@ double CachedFileIOTest::stdioRandomPageReads() {
 
 	return throughput;
 }
+
+
+
+/**
+*
+*  @brief Cache hit path microbenchmark: page lookup in PageTable compared
+*  to std::unordered_map (previous cached pages map) on the same keys, and
+*  small reads from CachedFileIO when whole file is cached
+*  @return PageTable lookup time (ns)
+*
+*/
+double CachedFileIOTest::pageTableLookups() {
+
+	const size_t pagesCount = 65536;
+	const size_t lookupsCount = samplesCount * 10;
+
+	// Cached pages of sparse file pages numbers
+	std::vector<CachePage> pages(pagesCount);
+	std::vector<PageTableSlot> slots(PageTable::slotsFor(pagesCount));
+	std::unordered_map<size_t, CachePage*> cacheMap;
+	PageTable pageTable;
+	pageTable.init(slots.data(), slots.size());
+	cacheMap.reserve(pagesCount);
+	for (size_t i = 0; i < pagesCount; i++) {
+		pages[i].filePageNo = i * 3;
+		pageTable.insert(i * 3, &pages[i]);
+		cacheMap[i * 3] = &pages[i];
+	}
+
+	// Random lookups of cached pages
+	std::mt19937_64 generator(42);
+	std::vector<size_t> keys(lookupsCount);
+	for (size_t i = 0; i < lookupsCount; i++) keys[i] = (generator() % pagesCount) * 3;
+
+	std::cout << "[TEST]  Cache HIT PATH lookup of " << lookupsCount;
+	std::cout << " pages in " << pagesCount << " cached pages...\n\t";
+
+	size_t checksum = 0;
+	auto startTime = std::chrono::high_resolution_clock::now();
+	for (size_t key : keys) checksum += cacheMap.find(key)->second->filePageNo;
+	auto endTime = std::chrono::high_resolution_clock::now();
+	double mapTime = double(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count()) / lookupsCount;
+
+	startTime = std::chrono::high_resolution_clock::now();
+	for (size_t key : keys) checksum -= pageTable.find(key)->filePageNo;
+	endTime = std::chrono::high_resolution_clock::now();
+	double tableTime = double(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count()) / lookupsCount;
+
+	std::cout << "unordered_map: " << mapTime << " ns, PageTable: " << tableTime << " ns per lookup";
+	std::cout << " (checksum " << checksum << ")\n\t";
+
+	// Small reads when all file pages are cached
+	cf.open(this->fileName);
+	size_t fileSize = cf.getFileSize();
+	cf.setCacheSize(fileSize + PAGE_SIZE * 2);
+	char buf[16];
+	for (size_t offset = 0; offset < fileSize; offset += PAGE_SIZE) cf.read(offset, buf, 1);
+	cf.resetStats();
+	for (size_t i = 0; i < samplesCount; i++) {
+		cf.read(generator() % (fileSize - sizeof(buf)), buf, sizeof(buf));
+	}
+	double readTime = cf.getStats(CachedFileStats::TOTAL_READ_TIME_NS) / samplesCount;
+	std::cout << "CachedFileIO " << sizeof(buf) << " byte read: " << readTime << " ns, ";
+	std::cout << "Cache Hit: " << cf.getStats(CachedFileStats::CACHE_HITS_RATE) << "%\n\t";
+	std::cout << "Read latency p50/p99/p999: " << cf.getStats(CachedFileStats::READ_LATENCY_P50_NS) << "/";
+	std::cout << cf.getStats(CachedFileStats::READ_LATENCY_P99_NS) << "/";
+	std::cout << cf.getStats(CachedFileStats::READ_LATENCY_P999_NS) << " ns\n\n";
+	cf.close();
+
+	return tableTime;
+}
+
+
+
+/**
+*
+*  @brief Random reads with adaptive cache sized within budget from minimal
+*  cache to half of file size by miss ratio curve
+*  @return selected cache size to file size ratio
+*
+*/
+double CachedFileIOTest::adaptiveCacheReads() {
+
+	char buf[PAGE_SIZE];
+	size_t length = docSize;
+
+	cf.open(this->fileName);
+	size_t fileSize = cf.getFileSize();
+	cf.setCacheBudget(MINIMAL_CACHE, fileSize / 2);
+
+	std::cout << "[TEST]  ADAPTIVE CACHE random read " << samplesCount;
+	std::cout << " of " << docSize << " byte blocks...\n\t";
+
+	for (size_t i = 0; i < samplesCount; i++) {
+		size_t offset = size_t(randNormal(0.5, this->sigma) * double(fileSize - length));
+		if (offset < fileSize) cf.read(offset, buf, length);
+	}
+
+	double sizeRatio = double(cf.getCacheSize()) / double(fileSize);
+	std::cout << "Cache size: " << cf.getCacheSize() / 1024 << " Kb (" << sizeRatio * 100.0;
+	std::cout << "% of database size), Cache Hit: " << cf.getStats(CachedFileStats::CACHE_HITS_RATE) << "%\n\n";
+	cf.close();
+
+	return sizeRatio;
+}
+
+
+/**
+*
+*  @brief Reads database through two files sharing one buffer pool: hot
+*  file reads localized blocks, cold file reads uniformly random blocks
+*  @return share of the pool held by hot file
+*
+*/
+double CachedFileIOTest::sharedPoolReads() {
+
+	char buf[PAGE_SIZE];
+	size_t length = docSize;
+
+	cf.open(this->fileName);
+	size_t fileSize = cf.getFileSize();
+	cf.close();
+
+	BufferPool pool(size_t(fileSize * cacheRatio));
+	CachedFileIO hotFile, coldFile;
+	hotFile.setBufferPool(&pool);
+	coldFile.setBufferPool(&pool);
+	hotFile.open(this->fileName, pool.getSize(), true);
+	coldFile.open(this->fileName, pool.getSize(), true);
+
+	std::cout << "[TEST]  SHARED POOL random read " << samplesCount;
+	std::cout << " of " << docSize << " byte blocks (hot and cold file)...\n\t";
+
+	std::mt19937_64 rng(1);
+	for (size_t i = 0; i < samplesCount; i++) {
+		size_t offset = size_t(randNormal(0.5, this->sigma) * double(fileSize - length));
+		if (offset < fileSize) hotFile.read(offset, buf, length);
+		if (i % 4 == 0) coldFile.read(rng() % (fileSize - length), buf, length);
+	}
+
+	double hotShare = pool.getStats(FILE_PAGES, &hotFile) / pool.getStats(POOL_PAGES);
+	std::cout << "Hot file: " << hotShare * 100.0 << "% of pool, Cache Hit: ";
+	std::cout << hotFile.getStats(CachedFileStats::CACHE_HITS_RATE) << "%, ";
+	std::cout << "Cold file Cache Hit: " << coldFile.getStats(CachedFileStats::CACHE_HITS_RATE) << "%\n\n";
+	hotFile.close();
+	coldFile.close();
+
+	return hotShare;
+}
+
+
+/**
+*
+*  @brief Reads database, reopens it with cache warm-up from hot pages
+*  manifest and reads it again
+*  @return cache hit rate of reads after reopen
+*
+*/
+double CachedFileIOTest::warmupReads() {
+
+	char buf[PAGE_SIZE];
+	size_t length = docSize;
+	size_t readsCount = samplesCount / 10;
+
+	cf.setCacheWarmup(true);
+	cf.open(this->fileName, size_t(cacheRatio * std::filesystem::file_size(this->fileName)), true);
+	size_t fileSize = cf.getFileSize();
+
+	std::cout << "[TEST]  WARM-UP reopen and random read " << readsCount;
+	std::cout << " of " << docSize << " byte blocks...\n\t";
+
+	for (size_t i = 0; i < samplesCount; i++) {
+		size_t offset = size_t(randNormal(0.5, this->sigma) * double(fileSize - length));
+		if (offset < fileSize) cf.read(offset, buf, length);
+	}
+	cf.close();
+
+	auto startTime = std::chrono::steady_clock::now();
+	cf.open(this->fileName, size_t(cacheRatio * fileSize), true);
+	while (cf.isWarmingUp()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	double warmupTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	double warmupPages = cf.getStats(CachedFileStats::WARMUP_PAGES);
+	cf.resetStats();
+	for (size_t i = 0; i < readsCount; i++) {
+		size_t offset = size_t(randNormal(0.5, this->sigma) * double(fileSize - length));
+		if (offset < fileSize) cf.read(offset, buf, length);
+	}
+	double hitRate = cf.getStats(CachedFileStats::CACHE_HITS_RATE);
+	std::cout << "Warm-up: " << warmupPages << " pages (" << warmupTime << "ms), ";
+	std::cout << "Cache Hit after reopen: " << hitRate << "%\n\n";
+	cf.close();
+	cf.setCacheWarmup(false);
+	std::filesystem::remove(std::string(this->fileName) + WARMUP_MANIFEST_SUFFIX);
+
+	return hitRate;
+}
+
+
+/**
+*
+*  @brief Creates test file of pages, every 64-bit word of the page holds
+*  page number in high half (low half is page version, zero initially)
+*
+*/
+void CachedFileIOTest::createPagesFile(const std::string& path, size_t pagesCount) {
+	std::vector<uint64_t> page(PAGE_SIZE / sizeof(uint64_t));
+	CachedFileIO file;
+	std::filesystem::remove(path);
+	file.open(path.c_str());
+	for (size_t pageNo = 0; pageNo < pagesCount; pageNo++) {
+		std::fill(page.begin(), page.end(), uint64_t(pageNo) << 32);
+		file.write(pageNo * PAGE_SIZE, page.data(), PAGE_SIZE);
+	}
+	file.close();
+}
+
+
+/**
+*
+*  @brief Readers and writers threads access overlapping pages through
+*  small cache, while some pages are held pinned. Checks that readers never
+*  see data of other page, pinned pages are not evicted, last written
+*  versions are read back and persisted.
+*  @return amount of errors found
+*
+*/
+size_t CachedFileIOTest::concurrentReadWrites() {
+
+	const size_t pagesCount = 512, pinnedCount = 4, threadsCount = 4;
+	const size_t wordsCount = PAGE_SIZE / sizeof(uint64_t);
+	size_t operationsCount = samplesCount / 10;
+	std::string path = std::string(this->fileName) + ".mt";
+	createPagesFile(path, pagesCount + pinnedCount);
+
+	CachedFileIO file;
+	file.open(path.c_str(), MINIMAL_CACHE);
+
+	std::cout << "[TEST]  CONCURRENT read/write " << operationsCount << " pages by ";
+	std::cout << threadsCount << " readers and " << threadsCount << " writers...\n\t";
+
+	// pin pages after written ones, they must stay while cache turns over
+	std::vector<PageRef> pinned(pinnedCount);
+	std::vector<uint64_t> stamps(pinnedCount);
+	for (size_t i = 0; i < pinnedCount; i++) {
+		pinned[i] = file.pin((pagesCount + i) * PAGE_SIZE);
+		stamps[i] = pinned[i].loadStamp();
+	}
+
+	// writer owns pages with its index modulo threads count, readers read
+	// any page at any word aligned offset (crossing page boundary)
+	std::atomic<size_t> errors{ 0 };
+	std::vector<std::vector<uint64_t>> versions(threadsCount, std::vector<uint64_t>(pagesCount, 0));
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < threadsCount; t++) {
+		threads.emplace_back([&, t]() {
+			std::mt19937_64 rng(t);
+			std::vector<uint64_t> page(wordsCount);
+			for (size_t i = 0; i < operationsCount; i++) {
+				size_t pageNo = (rng() % (pagesCount / threadsCount)) * threadsCount + t;
+				uint64_t version = i + 1;
+				std::fill(page.begin(), page.end(), (uint64_t(pageNo) << 32) | version);
+				if (file.write(pageNo * PAGE_SIZE, page.data(), PAGE_SIZE) != PAGE_SIZE) errors++;
+				else versions[t][pageNo] = version;
+			}
+		});
+		threads.emplace_back([&, t]() {
+			std::mt19937_64 rng(threadsCount + t);
+			std::vector<uint64_t> data(wordsCount);
+			for (size_t i = 0; i < operationsCount; i++) {
+				size_t position = (rng() % ((pagesCount + pinnedCount) * wordsCount)) * sizeof(uint64_t);
+				size_t length = std::min<size_t>(PAGE_SIZE, (pagesCount + pinnedCount) * PAGE_SIZE - position);
+				size_t bytesRead = file.read(position, data.data(), length);
+				for (size_t w = 0; w < bytesRead / sizeof(uint64_t); w++) {
+					uint64_t pageNo = (position + w * sizeof(uint64_t)) >> PAGE_SHIFT;
+					if ((data[w] >> 32) != pageNo) { errors++; break; }
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	// pinned pages kept their place and data (page was not reloaded)
+	size_t pinnedKept = 0;
+	for (size_t i = 0; i < pinnedCount; i++) {
+		PageRef again = file.pin((pagesCount + i) * PAGE_SIZE);
+		const uint64_t* word = (const uint64_t*)pinned[i].data();
+		if (again.data() == pinned[i].data() && again.loadStamp() == stamps[i] &&
+			(*word >> 32) == pagesCount + i) pinnedKept++;
+		else errors++;
+	}
+	pinned.clear();
+
+	// last written versions are read from cache and from file after reopen
+	auto verifyPages = [&](CachedFileIO& checkedFile) {
+		std::vector<uint64_t> data(wordsCount);
+		for (size_t pageNo = 0; pageNo < pagesCount; pageNo++) {
+			uint64_t expected = (uint64_t(pageNo) << 32) | versions[pageNo % threadsCount][pageNo];
+			checkedFile.read(pageNo * PAGE_SIZE, data.data(), PAGE_SIZE);
+			if (std::count(data.begin(), data.end(), expected) != (ptrdiff_t)wordsCount) errors++;
+		}
+	};
+	verifyPages(file);
+	file.close();
+	file.open(path.c_str(), MINIMAL_CACHE, true);
+	verifyPages(file);
+	file.close();
+	std::filesystem::remove(path);
+
+	std::cout << "Pinned pages kept: " << pinnedKept << " of " << pinnedCount;
+	std::cout << ", Errors: " << errors << (errors == 0 ? " - SUCCESS! :)" : " - FAILED :(") << "\n\n";
+
+	return errors;
+}
+
+
+/**
+*
+*  @brief Builds hot set of pages (accessed repeatedly between one-shot
+*  cold reads), runs sequential scan of file range 8 times larger than the
+*  cache and measures hit rate of the hot set after the scan for LRU, 2Q
+*  and ARC
+*  @return true if 2Q and ARC keep hot set, while LRU loses it
+*
+*/
+bool CachedFileIOTest::scanResistance() {
+
+	const size_t cachePages = 256, hotCount = 64, scanPages = cachePages * 8;
+	const size_t coldStart = hotCount * 3, scanStart = coldStart + scanPages;
+	std::string path = std::string(this->fileName) + ".scan";
+	createPagesFile(path, scanStart + scanPages);
+
+	std::cout << "[TEST]  SCAN RESISTANCE hot set of " << hotCount << " pages after ";
+	std::cout << scanPages << " pages scan through " << cachePages << " pages cache...\n\t";
+
+	// hot pages are not adjacent (no readahead), accessed in random order,
+	// cold pages are read once each, scanned range is at the end of file
+	std::mt19937_64 rng(1);
+	std::vector<size_t> hotPages(hotCount), coldPages(scanPages);
+	for (size_t i = 0; i < hotCount; i++) hotPages[i] = i * 3;
+	for (size_t i = 0; i < scanPages; i++) coldPages[i] = coldStart + i;
+	std::shuffle(hotPages.begin(), hotPages.end(), rng);
+	std::shuffle(coldPages.begin(), coldPages.end(), rng);
+
+	const ReplacementPolicyType policies[] = { LRU_POLICY, TWO_QUEUE_POLICY, ARC_POLICY };
+	const char* names[] = { "LRU", "2Q", "ARC" };
+	double hitRates[3];
+	char buf[PAGE_SIZE];
+	CachedFileIO file;
+	for (size_t p = 0; p < 3; p++) {
+		file.setReplacementPolicy(policies[p]);
+		file.open(path.c_str(), cachePages * PAGE_SIZE, true);
+		// hot pages are re-referenced while cold reads turn cache over
+		size_t coldIndex = 0;
+		for (size_t round = 0; round < 8; round++) {
+			for (size_t pageNo : hotPages) {
+				file.read(pageNo * PAGE_SIZE, buf, PAGE_SIZE);
+				file.read(coldPages[coldIndex++ % scanPages] * PAGE_SIZE, buf, PAGE_SIZE);
+				file.read(coldPages[coldIndex++ % scanPages] * PAGE_SIZE, buf, PAGE_SIZE);
+			}
+		}
+		for (size_t pageNo = scanStart; pageNo < scanStart + scanPages; pageNo++) {
+			file.read(pageNo * PAGE_SIZE, buf, PAGE_SIZE);
+		}
+		file.resetStats();
+		for (size_t pageNo : hotPages) file.read(pageNo * PAGE_SIZE, buf, PAGE_SIZE);
+		hitRates[p] = file.getStats(CachedFileStats::CACHE_HITS_RATE);
+		file.close();
+		std::cout << names[p] << " hot set Cache Hit: " << hitRates[p] << "%" << (p < 2 ? ", " : "");
+	}
+	file.setReplacementPolicy(LRU_POLICY);
+	std::filesystem::remove(path);
+
+	bool resistant = hitRates[1] >= 90.0 && hitRates[2] >= 90.0 && hitRates[0] <= 10.0;
+	std::cout << (resistant ? " - SUCCESS! :)" : " - FAILED :(") << "\n\n";
+
+	return resistant;
+}
+
+
+/**
+*
+*  @brief Reads pages of Zipfian popularity (s = 0.99) through small cache
+*  with LRU and W-TinyLFU policies (same access sequence)
+*  @return true if W-TinyLFU rejects admissions and its hit rate is not
+*  worse than LRU hit rate
+*
+*/
+bool CachedFileIOTest::zipfianAdmission() {
+
+	const size_t pagesCount = 4096, cachePages = 256;
+	size_t readsCount = samplesCount / 5;
+	std::string path = std::string(this->fileName) + ".zipf";
+	createPagesFile(path, pagesCount);
+
+	std::cout << "[TEST]  ZIPFIAN random read " << readsCount << " of " << pagesCount;
+	std::cout << " pages through " << cachePages << " pages cache...\n\t";
+
+	// popularity rank is mapped to random page, so popular pages are not adjacent
+	std::vector<double> weights(pagesCount);
+	for (size_t rank = 0; rank < pagesCount; rank++) weights[rank] = 1.0 / std::pow(double(rank + 1), 0.99);
+	std::vector<size_t> rankPages(pagesCount);
+	for (size_t i = 0; i < pagesCount; i++) rankPages[i] = i;
+	std::mt19937_64 rng(1);
+	std::shuffle(rankPages.begin(), rankPages.end(), rng);
+	std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+	std::vector<size_t> sequence(readsCount);
+	for (size_t& pageNo : sequence) pageNo = rankPages[zipf(rng)];
+
+	double hitRates[2], rejected = 0;
+	const ReplacementPolicyType policies[] = { LRU_POLICY, TINY_LFU_POLICY };
+	char buf[PAGE_SIZE];
+	CachedFileIO file;
+	for (size_t p = 0; p < 2; p++) {
+		file.setReplacementPolicy(policies[p]);
+		file.open(path.c_str(), cachePages * PAGE_SIZE, true);
+		for (size_t pageNo : sequence) file.read(pageNo * PAGE_SIZE, buf, PAGE_SIZE);
+		hitRates[p] = file.getStats(CachedFileStats::CACHE_HITS_RATE);
+		if (policies[p] == TINY_LFU_POLICY) rejected = file.getStats(CachedFileStats::TOTAL_ADMISSIONS_REJECTED);
+		file.close();
+	}
+	file.setReplacementPolicy(LRU_POLICY);
+	std::filesystem::remove(path);
+
+	bool admitted = rejected > 0 && hitRates[1] >= hitRates[0];
+	std::cout << "LRU Cache Hit: " << hitRates[0] << "%, W-TinyLFU Cache Hit: " << hitRates[1];
+	std::cout << "%, Admissions rejected: " << rejected << (admitted ? " - SUCCESS! :)" : " - FAILED :(") << "\n\n";
+
+	return admitted;
+}
+
+
+/**
+*
+*  @brief Rewrites runs of adjacent pages, persists them by small incremental
+*  flushes (first one asynchronous) and checks file content after reopen
+*  @return true if all dirty pages persisted with vector writes larger than
+*  page and file content is correct
+*
+*/
+bool CachedFileIOTest::coalescedFlush() {
+
+	const size_t pagesCount = 1024, runPages = 16, runStride = 32, flushPages = 64;
+	const size_t wordsCount = PAGE_SIZE / sizeof(uint64_t);
+	const uint64_t version = 7;
+	std::string path = std::string(this->fileName) + ".flush";
+	createPagesFile(path, pagesCount);
+
+	std::cout << "[TEST]  COALESCED FLUSH of " << pagesCount / runStride << " runs of " << runPages;
+	std::cout << " dirty pages by " << flushPages << " pages increments...\n\t";
+
+	// rewrite first pages of every stride (runs of adjacent dirty pages)
+	CachedFileIO file;
+	std::vector<uint64_t> data(wordsCount);
+	file.open(path.c_str(), pagesCount * 2 * PAGE_SIZE);
+	size_t dirtyCount = 0;
+	for (size_t pageNo = 0; pageNo < pagesCount; pageNo++) {
+		if (pageNo % runStride >= runPages) continue;
+		std::fill(data.begin(), data.end(), (uint64_t(pageNo) << 32) | version);
+		file.write(pageNo * PAGE_SIZE, data.data(), PAGE_SIZE);
+		dirtyCount++;
+	}
+
+	// persist dirty pages by increments
+	file.resetStats();
+	size_t increments = 1;
+	size_t flushedCount = file.flushAsync(flushPages).get();
+	while (size_t pagesFlushed = file.flush(flushPages)) {
+		flushedCount += pagesFlushed;
+		increments++;
+	}
+	double writeSize = file.getStats(CachedFileStats::AVERAGE_WRITE_IO_SIZE);
+	file.close();
+
+	// check rewritten and untouched pages after reopen
+	size_t errors = 0;
+	file.open(path.c_str(), MINIMAL_CACHE, true);
+	for (size_t pageNo = 0; pageNo < pagesCount; pageNo++) {
+		uint64_t expected = uint64_t(pageNo) << 32;
+		if (pageNo % runStride < runPages) expected |= version;
+		file.read(pageNo * PAGE_SIZE, data.data(), PAGE_SIZE);
+		if (std::count(data.begin(), data.end(), expected) != (ptrdiff_t)wordsCount) errors++;
+	}
+	file.close();
+	std::filesystem::remove(path);
+
+	bool coalesced = flushedCount == dirtyCount && writeSize > PAGE_SIZE && errors == 0;
+	std::cout << "Flushed: " << flushedCount << " of " << dirtyCount << " pages in " << increments;
+	std::cout << " increments, Average write: " << writeSize / 1024 << " Kb, Errors: " << errors;
+	std::cout << (coalesced ? " - SUCCESS! :)" : " - FAILED :(") << "\n\n";
+
+	return coalesced;
+}
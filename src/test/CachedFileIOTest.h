@@ -9,14 +9,25 @@
 
 
 #include <cstdio>
+#include <cmath>
 #include <iostream>
+#include <iomanip>
 #include <locale>
 #include <chrono>
 #include <thread>
+#include <atomic>
 #include <filesystem>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <unordered_map>
 
 #include "CachedFileIO.h"
 
+#ifndef _WIN32
+#define _fseeki64 fseeko                        // 64-bit seek on POSIX systems
+#endif
+
 namespace Boson {
 
 	class CachedFileIOTest {
@@ -39,6 +50,15 @@ namespace Boson {
 		double stdioRandomReads();
 		double cachedRandomPageReads();
 		double stdioRandomPageReads();
+		double pageTableLookups();
+		double adaptiveCacheReads();
+		double sharedPoolReads();
+		double warmupReads();
+		size_t concurrentReadWrites();
+		bool   scanResistance();
+		bool   zipfianAdmission();
+		bool   coalescedFlush();
+		void   createPagesFile(const std::string& path, size_t pagesCount);
 	};
 
 }
@@ -0,0 +1,95 @@
+/******************************************************************************
+*
+*  Checksum class tests implementation
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+
+#include "ChecksumTest.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+using namespace Boson;
+
+
+/*
+*  @brief Checks every supported implementation against standard check
+*  values of "123456789" string (and empty data)
+*/
+bool ChecksumTest::knownAnswers() {
+	const char* text = "123456789";
+	const uint8_t* data = (const uint8_t*)text;
+	uint64_t length = strlen(text);
+	struct { ChecksumType type; uint32_t check; uint32_t empty; } answers[] = {
+		{ ADLER32_CHECKSUM, 0x091E01DE, 0x00000001 },
+		{ CRC32C_CHECKSUM,  0xE3069283, 0x00000000 }
+	};
+	bool success = true;
+	std::cout << "[TEST] Checksum known answers...\n";
+	for (auto& answer : answers) {
+		for (ChecksumFunction function : Checksum::getSupported(answer.type)) {
+			uint32_t value = function(data, length);
+			bool passed = value == answer.check && function(data, 0) == answer.empty;
+			std::cout << "\t" << std::left << std::setw(20) << Checksum::getName(function);
+			std::cout << "0x" << std::hex << std::uppercase << std::right << std::setfill('0');
+			std::cout << std::setw(8) << value << std::dec << std::setfill(' ');
+			std::cout << (passed ? " - OK\n" : " - FAILED\n");
+			success = success && passed;
+		}
+	}
+	success = success && Checksum::adler32(data, length) == answers[0].check;
+	success = success && Checksum::crc32c(data, length) == answers[1].check;
+	return success;
+}
+
+
+/*
+*  @brief Compares accelerated implementations with portable one on all
+*  lengths and misalignments (random and 0xFF data near Adler-32 overflow)
+*  @param[in] maxLength - maximum data length to check
+*/
+bool ChecksumTest::implementationsAgree(size_t maxLength) {
+	constexpr size_t MAX_MISALIGNMENT = 64;
+	std::vector<uint8_t> random(maxLength + MAX_MISALIGNMENT);
+	std::vector<uint8_t> ones(maxLength + MAX_MISALIGNMENT, 0xFF);
+	std::mt19937 generator(12345);
+	for (auto& byte : random) byte = uint8_t(generator());
+	bool success = true;
+	std::cout << "[TEST] Checksum implementations agree up to " << maxLength << " bytes...\n";
+	for (ChecksumType type : { ADLER32_CHECKSUM, CRC32C_CHECKSUM }) {
+		std::vector<ChecksumFunction> functions = Checksum::getSupported(type);
+		ChecksumFunction portable = functions[0];
+		for (size_t i = 1; i < functions.size(); i++) {
+			size_t mismatches = 0;
+			for (const std::vector<uint8_t>* buffer : { &random, &ones }) {
+				for (size_t offset = 0; offset < MAX_MISALIGNMENT; offset++) {
+					const uint8_t* data = buffer->data() + offset;
+					for (size_t length = 0; length <= maxLength; length += (length < 1024 ? 1 : 61)) {
+						if (functions[i](data, length) != portable(data, length)) mismatches++;
+					}
+				}
+			}
+			std::cout << "\t" << std::left << std::setw(20) << Checksum::getName(functions[i]);
+			std::cout << mismatches << " mismatches" << (mismatches == 0 ? " - OK\n" : " - FAILED\n");
+			success = success && mismatches == 0;
+		}
+		if (functions.size() == 1) {
+			std::cout << "\t" << std::left << std::setw(20) << Checksum::getName(portable);
+			std::cout << "only portable implementation supported\n";
+		}
+	}
+	return success;
+}
+
+
+void ChecksumTest::run() {
+	bool success = knownAnswers();
+	success = implementationsAgree(3 * 5552 + 100) && success;
+	std::cout << "Checksum tests" << (success ? " - SUCCESS! :)\n\n" : " - FAILED :(\n\n");
+}
@@ -0,0 +1,23 @@
+/******************************************************************************
+*
+*  Checksum class test header
+*
+*  (C) Boson Database, Bolat Basheyev 2022-2024
+*
+******************************************************************************/
+#pragma once
+
+#include "Checksum.h"
+
+#include <cstddef>
+
+namespace Boson {
+
+	class ChecksumTest {
+	public:
+		bool knownAnswers();
+		bool implementationsAgree(size_t maxLength);
+		void run();
+	};
+
+}
@@ -8,10 +8,16 @@
 
 #include "RecordFileIO.h"
 #include "RecordFileIOTest.h"
+#include "../api/BosonAPI.h"
 
 #include <iostream>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
 
 
 using namespace Boson;
@@ -203,6 +209,295 @@ bool RecordFileIOTest::insertNewRecords(const char* filename, size_t recordsCoun
 }
 
 
+/*
+*  @brief Removes records of random capacity and creates them again largest
+*  first, size class free lists must reuse all space without file growth
+*  @param[in] filename - path to file
+*  @param[in] recordsCount - total records to generate
+*/
+bool RecordFileIOTest::reuseFreeRecords(const char* filename, size_t recordsCount) {
+	std::filesystem::remove(filename);
+	CachedFileIO cachedFile;
+	if (!cachedFile.open(filename)) {
+		std::cout << "ERROR: Can't open file '" << filename << "' in write mode.\n";
+		return false;
+	}
+	RecordFileIO storage(cachedFile);
+	std::cout << "[TEST] Reusing " << recordsCount / 2 << " free records...";
+	std::vector<char> buffer(4096, 'x');
+	std::vector<uint32_t> lengths;
+	for (size_t i = 0; i < recordsCount; i++) {
+		uint32_t length = 10 + std::rand() % 4000;
+		storage.createRecord(buffer.data(), length);
+		if (i % 2 == 0) lengths.push_back(length);
+	}
+	// remove every even record
+	storage.first();
+	do {
+		storage.removeRecord();
+	} while (storage.next() && storage.next());
+	storage.flush();
+	size_t fileSize = cachedFile.getFileSize();
+	// create records of removed lengths, largest first
+	std::sort(lengths.begin(), lengths.end(), std::greater<uint32_t>());
+	for (uint32_t length : lengths) storage.createRecord(buffer.data(), length);
+	storage.flush();
+	bool reused = storage.getTotalFreeRecords() == 0 && cachedFile.getFileSize() == fileSize;
+	std::cout << (reused ? "OK\n" : "FAILED\n");
+	return reused;
+}
+
+
+/*
+*  @brief Reads records twice with VERIFY_ON_LOAD policy (cache hits are
+*  not verified again), then corrupts a record and finds it with scrub
+*  @param[in] filename - path to file
+*  @param[in] recordsCount - total records to generate
+*/
+bool RecordFileIOTest::verifyPolicies(const char* filename, size_t recordsCount) {
+	std::filesystem::remove(filename);
+	CachedFileIO cachedFile;
+	if (!cachedFile.open(filename)) {
+		std::cout << "ERROR: Can't open file '" << filename << "' in write mode.\n";
+		return false;
+	}
+	RecordFileIO storage(cachedFile);
+	std::cout << "[TEST] Checksum verification policies...";
+	std::string data(1500, 'x');
+	for (size_t i = 0; i < recordsCount; i++) storage.createRecord(data.data(), uint32_t(data.size()));
+	storage.setChecksumVerify(VERIFY_ON_LOAD);
+	for (int pass = 0; pass < 2; pass++) {
+		storage.first();
+		do {
+			if (storage.getRecordData(data) == NOT_FOUND) {
+				std::cout << "FAILED (read)\n";
+				return false;
+			}
+		} while (storage.next());
+	}
+	bool onLoad = storage.getStats(VERIFIED_RECORDS) == recordsCount &&
+		storage.getStats(UNVERIFIED_BYTES) == recordsCount * data.size();
+	// corrupt data of the last record, reads skip it, scrub finds it
+	storage.setChecksumVerify(VERIFY_ON_SCRUB);
+	storage.last();
+	cachedFile.write(storage.getPosition() + sizeof(RecordHeader), "corrupted", 9);
+	bool skipped = storage.getRecordData(data) != NOT_FOUND;
+	storage.resetStats();
+	bool scrubbed = storage.scrub(NOT_FOUND) == recordsCount &&
+		storage.getStats(CHECKSUM_FAILURES) == 1;
+	bool passed = onLoad && skipped && scrubbed;
+	std::cout << (passed ? "OK\n" : "FAILED\n");
+	return passed;
+}
+
+
+/*
+*  @brief Creates and removes records, storage header changed in memory
+*  must be persisted by flush and seen by other reader of the file
+*  @param[in] filename - path to file
+*  @param[in] recordsCount - total records to generate
+*/
+bool RecordFileIOTest::flushStorageHeader(const char* filename, size_t recordsCount) {
+	std::filesystem::remove(filename);
+	CachedFileIO cachedFile;
+	if (!cachedFile.open(filename)) {
+		std::cout << "ERROR: Can't open file '" << filename << "' in write mode.\n";
+		return false;
+	}
+	RecordFileIO storage(cachedFile);
+	std::cout << "[TEST] Flushing storage header...";
+	std::string data(100, 'x');
+	for (size_t i = 0; i < recordsCount; i++) storage.createRecord(data.data(), uint32_t(data.size()));
+	storage.last();
+	storage.removeRecord();
+	storage.flush();
+	CachedFileIO readerFile;
+	if (!readerFile.open(filename, DEFAULT_CACHE, true)) {
+		std::cout << "ERROR: Can't open file '" << filename << "' in read mode.\n";
+		return false;
+	}
+	RecordFileIO reader(readerFile);
+	bool persisted = reader.getTotalRecords() == recordsCount - 1 && reader.getTotalFreeRecords() == 1;
+	std::cout << (persisted ? "OK\n" : "FAILED\n");
+	return persisted;
+}
+
+
+/*
+*  @brief Storage file created with another page size must be rejected:
+*  RecordFileIO constructor throws and BosonAPI::open returns false
+*  @param[in] filename - path to file
+*/
+bool RecordFileIOTest::pageSizeMismatch(const char* filename) {
+	std::filesystem::remove(filename);
+	std::cout << "[TEST] Rejecting file with different page size...";
+	{
+		CachedFileIO cachedFile;
+		if (!cachedFile.open(filename)) {
+			std::cout << "ERROR: Can't open file '" << filename << "' in write mode.\n";
+			return false;
+		}
+		RecordFileIO storage(cachedFile);
+		std::string data(100, 'x');
+		storage.createRecord(data.data(), uint32_t(data.size()));
+		storage.flush();
+		// patch page size in the persisted storage header
+		uint32_t pageSize = uint32_t(PAGE_SIZE * 2);
+		cachedFile.write(offsetof(StorageHeader, pageSize), &pageSize, sizeof pageSize);
+		cachedFile.flush();
+	}
+	bool thrown = false;
+	{
+		CachedFileIO cachedFile;
+		if (!cachedFile.open(filename, DEFAULT_CACHE, true)) {
+			std::cout << "ERROR: Can't open file '" << filename << "' in read mode.\n";
+			return false;
+		}
+		try {
+			RecordFileIO storage(cachedFile);
+		} catch (const std::runtime_error&) {
+			thrown = true;
+		}
+	}
+	BosonAPI db;
+	std::string path(filename);
+	bool opened = db.open(path.data(), true);
+	if (opened) db.close();
+	bool rejected = thrown && !opened;
+	std::cout << (rejected ? "OK\n" : "FAILED\n");
+	return rejected;
+}
+
+
+/*
+*  @brief Opens hand-built version 1 file (64 bytes header, 8K pages,
+*  single free list): read only open keeps it unchanged, writable open
+*  upgrades it (records overlapping new header are relocated), records
+*  order and data must be kept and free records reused after upgrade
+*  @param[in] filename - path to file
+*  @param[in] recordsCount - total records to generate
+*/
+bool RecordFileIOTest::legacyHeader(const char* filename, size_t recordsCount) {
+	std::filesystem::remove(filename);
+	std::cout << "[TEST] Upgrading version 1 file with legacy header...";
+	constexpr uint32_t capacity = 48;
+	auto recordData = [](size_t i) { return "Legacy record #" + std::to_string(i); };
+	auto isDeleted = [](size_t i) { return i % 7 == 2; };
+	std::vector<size_t> expected;
+	for (size_t i = 0; i < recordsCount; i++) if (!isDeleted(i)) expected.push_back(i);
+	auto checkRecords = [&](RecordFileIO& storage) {
+		std::string data;
+		size_t counter = 0;
+		if (storage.first()) do {
+			if (storage.getRecordData(data) == NOT_FOUND) return false;
+			if (counter >= expected.size() || data != recordData(expected[counter])) return false;
+			counter++;
+		} while (storage.next());
+		return counter == expected.size() && storage.getTotalRecords() == expected.size();
+	};
+	{
+		// records follow each other from the end of legacy header
+		CachedFileIO cachedFile;
+		if (!cachedFile.open(filename)) {
+			std::cout << "ERROR: Can't open file '" << filename << "' in write mode.\n";
+			return false;
+		}
+		StorageHeader sh;
+		memset(&sh, 0, sizeof(StorageHeader));
+		sh.signature = BOSONDB_SIGNATURE;
+		sh.version = BOSONDB_LEGACY_VERSION;
+		sh.firstRecord = sh.lastRecord = NOT_FOUND;
+		sh.firstFreeRecord = sh.lastFreeRecord = NOT_FOUND;
+		auto offsetOf = [](size_t i) { return LEGACY_HEADER_SIZE + i * (sizeof(RecordHeader) + capacity); };
+		uint64_t lastData = NOT_FOUND, lastFree = NOT_FOUND;
+		for (size_t i = 0; i < recordsCount; i++) {
+			RecordHeader header;
+			memset(&header, 0, sizeof(RecordHeader));
+			uint64_t& last = isDeleted(i) ? lastFree : lastData;
+			header.previous = last;
+			header.next = NOT_FOUND;
+			header.recordCapacity = capacity;
+			if (!isDeleted(i)) {
+				std::string data = recordData(i);
+				header.dataLength = uint32_t(data.size());
+				header.dataChecksum = Checksum::adler32((const uint8_t*)data.data(), data.size());
+				cachedFile.write(offsetOf(i) + sizeof(RecordHeader), data.data(), data.size());
+			}
+			last = offsetOf(i);
+			if (isDeleted(i)) {
+				if (sh.firstFreeRecord == NOT_FOUND) sh.firstFreeRecord = last;
+				sh.totalFreeRecords++;
+			} else {
+				if (sh.firstRecord == NOT_FOUND) sh.firstRecord = last;
+				sh.totalRecords++;
+			}
+			cachedFile.write(last, &header, sizeof(RecordHeader));
+		}
+		sh.lastRecord = lastData;
+		sh.lastFreeRecord = lastFree;
+		sh.endOfFile = offsetOf(recordsCount);
+		// link next records and calculate header checksums
+		for (size_t i = 0; i < recordsCount; i++) {
+			RecordHeader header;
+			cachedFile.read(offsetOf(i), &header, sizeof(RecordHeader));
+			header.next = NOT_FOUND;
+			for (size_t j = i + 1; j < recordsCount; j++) {
+				if (isDeleted(j) == isDeleted(i)) { header.next = offsetOf(j); break; }
+			}
+			uint32_t headerDataLength = sizeof(RecordHeader) - sizeof header.headChecksum;
+			header.headChecksum = Checksum::adler32((const uint8_t*)&header, headerDataLength);
+			cachedFile.write(offsetOf(i), &header, sizeof(RecordHeader));
+		}
+		cachedFile.write(0, &sh, LEGACY_HEADER_SIZE);
+		cachedFile.flush();
+	}
+	bool success = true;
+	{
+		// read only open doesn't change the file
+		CachedFileIO cachedFile;
+		cachedFile.open(filename, DEFAULT_CACHE, true);
+		try {
+			RecordFileIO storage(cachedFile);
+			success = checkRecords(storage) && storage.getChecksumType() == ADLER32_CHECKSUM;
+		} catch (const std::runtime_error&) {
+			// legacy file can be opened only with the same page size
+			bool rejected = PAGE_SIZE != LEGACY_PAGE_SIZE;
+			std::cout << (rejected ? "OK (rejected, page size differs)\n" : "FAILED\n");
+			return rejected;
+		}
+		if (PAGE_SIZE != LEGACY_PAGE_SIZE) {
+			std::cout << "FAILED (opened with " << PAGE_SIZE << " bytes pages)\n";
+			return false;
+		}
+	}
+	uint64_t freeRecords = 0;
+	{
+		// writable open upgrades the file, new records reuse free records
+		CachedFileIO cachedFile;
+		cachedFile.open(filename);
+		RecordFileIO storage(cachedFile);
+		success = success && checkRecords(storage);
+		freeRecords = storage.getTotalFreeRecords();
+		for (size_t i = recordsCount; i < recordsCount + freeRecords; i++) {
+			std::string data = recordData(i);
+			uint64_t offset = storage.createRecord(data.data(), uint32_t(data.size()));
+			success = success && offset >= sizeof(StorageHeader);
+			expected.push_back(i);
+		}
+		success = success && storage.getTotalFreeRecords() == 0;
+	}
+	CachedFileIO cachedFile;
+	cachedFile.open(filename, DEFAULT_CACHE, true);
+	StorageHeader sh;
+	cachedFile.read(0, &sh, sizeof(StorageHeader));
+	success = success && sh.version == BOSONDB_VERSION && sh.headerSize == sizeof(StorageHeader);
+	RecordFileIO storage(cachedFile);
+	success = success && checkRecords(storage) && storage.getChecksumType() == ADLER32_CHECKSUM;
+	std::cout << (success ? "OK" : "FAILED") << " (" << freeRecords << " free records reused)\n";
+	return success;
+}
+
+
 void RecordFileIOTest::run(const char* filename) {
 	std::filesystem::remove(filename);
 	generateData(filename, 10);
@@ -211,6 +506,11 @@ void RecordFileIOTest::run(const char* filename) {
 	readDescending(filename, true);
 	insertNewRecords(filename, 3);
 	readAscending(filename, true);
+	reuseFreeRecords(filename, 128);
+	verifyPolicies(filename, 100);
+	flushStorageHeader(filename, 100);
+	pageSizeMismatch(filename);
+	legacyHeader(filename, 100);
 }
 
 
@@ -9,6 +9,11 @@ namespace Boson {
 		bool readDescending(const char* filename, bool verbose);
 		bool removeEvenRecords(const char* filename, bool verbose);
 		bool insertNewRecords(const char* filename, size_t recordCount);
+		bool reuseFreeRecords(const char* filename, size_t recordCount);
+		bool verifyPolicies(const char* filename, size_t recordCount);
+		bool flushStorageHeader(const char* filename, size_t recordCount);
+		bool pageSizeMismatch(const char* filename);
+		bool legacyHeader(const char* filename, size_t recordCount);
 		void run(const char* filename);
 		void runLoadTest(const char* filename, size_t amount);
 	private: